@@ -0,0 +1,429 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// cl_bench.c -- demo benchmark suite
+//
+// "benchmark <demo> [demo ...]" plays each demo as a timedemo and records
+// how long every rendered frame took, split by client subsystem.  When the
+// last demo has finished the percentiles are printed and written as JSON to
+// <gamedir>/benchmark.json so runs can be compared between builds and
+// refresh libraries.
+
+#include "client.h"
+
+#define	MAX_BENCHMARK_DEMOS	32
+
+#define	BENCH_FRAME			BENCH_NUMTIMERS		// whole CL_Frame, last column
+#define	BENCH_NUMCOLUMNS	(BENCH_NUMTIMERS+1)
+
+static const char *bench_columnnames[BENCH_NUMCOLUMNS] =
+{
+	"parse",
+	"entities",
+	"particles",
+	"sound",
+	"render",
+	"frame"
+};
+
+typedef struct
+{
+	char	name[MAX_QPATH];
+	int		firstframe;
+	int		numframes;
+	double	seconds;			// wall time from the first to the last counted frame
+} benchdemo_t;
+
+typedef struct
+{
+	float	mean;
+	float	p50, p90, p99;
+	float	max;
+} benchstats_t;
+
+typedef struct
+{
+	qboolean	active;
+
+	benchdemo_t	demos[MAX_BENCHMARK_DEMOS];
+	int			numdemos;
+	int			current;
+
+	char		oldtimedemo[16];
+
+	// current frame
+	qboolean	counting;		// frame started with the demo fully loaded
+	qboolean	rendered;		// the refresh drew a view this frame
+	double		framestart;
+	double		timerstart[BENCH_NUMTIMERS];
+	float		times[BENCH_NUMCOLUMNS];
+
+	double		demostart;
+	double		lastframeend;
+
+	// every counted frame of the run, BENCH_NUMCOLUMNS milliseconds each
+	float		*samples;
+	int			numsamples;
+	int			maxsamples;
+} benchmark_t;
+
+static benchmark_t	bench;
+
+static cvar_t	*cl_benchmarkquit;
+
+/*
+================
+CL_BenchmarkStart / CL_BenchmarkStop
+
+Bracket a subsystem call.  Nesting different timers is fine, time
+is accumulated if a timer runs more than once in a frame.
+================
+*/
+void CL_BenchmarkStart (benchtimer_t timer)
+{
+	if (!bench.active)
+		return;
+
+	bench.timerstart[timer] = Sys_DoubleTime ();
+}
+
+void CL_BenchmarkStop (benchtimer_t timer)
+{
+	if (!bench.active)
+		return;
+
+	bench.times[timer] += (float)((Sys_DoubleTime () - bench.timerstart[timer]) * 1000.0);
+
+	if (timer == BENCH_RENDER)
+		bench.rendered = true;
+}
+
+/*
+================
+CL_BenchmarkBeginFrame
+================
+*/
+void CL_BenchmarkBeginFrame (void)
+{
+	if (!bench.active)
+		return;
+
+	// the frame that loads the level would dwarf everything else
+	bench.counting = (cls.state == ca_active && cl.refresh_prepped);
+	bench.rendered = false;
+	memset (bench.times, 0, sizeof(bench.times));
+
+	bench.framestart = Sys_DoubleTime ();
+}
+
+/*
+================
+CL_BenchmarkEndFrame
+================
+*/
+void CL_BenchmarkEndFrame (void)
+{
+	double	now;
+	float	*sample;
+
+	if (!bench.active || !bench.counting || !bench.rendered)
+		return;
+
+	now = Sys_DoubleTime ();
+	bench.times[BENCH_FRAME] = (float)((now - bench.framestart) * 1000.0);
+
+	// CL_AddParticles runs inside CL_AddEntities, keep the columns disjoint
+	bench.times[BENCH_ENTITIES] -= bench.times[BENCH_PARTICLES];
+
+	if (bench.numsamples == bench.maxsamples)
+	{
+		float	*grown;
+
+		grown = realloc (bench.samples, (bench.maxsamples + 4096) * BENCH_NUMCOLUMNS * sizeof(float));
+		if (!grown)
+			return;
+		bench.samples = grown;
+		bench.maxsamples += 4096;
+	}
+
+	if (bench.numsamples == bench.demos[bench.current].firstframe)
+		bench.demostart = bench.framestart;
+	bench.lastframeend = now;
+
+	sample = bench.samples + bench.numsamples * BENCH_NUMCOLUMNS;
+	memcpy (sample, bench.times, sizeof(bench.times));
+	bench.numsamples++;
+}
+
+/*
+================
+CL_BenchmarkStats
+================
+*/
+static int CL_BenchmarkCompare (const void *a, const void *b)
+{
+	float	fa = *(const float *)a;
+	float	fb = *(const float *)b;
+
+	return (fa > fb) - (fa < fb);
+}
+
+static float CL_BenchmarkPercentile (const float *sorted, int count, int percent)
+{
+	int		rank;
+
+	// nearest rank
+	rank = (count * percent + 99) / 100;
+	if (rank < 1)
+		rank = 1;
+	return sorted[rank - 1];
+}
+
+static void CL_BenchmarkStats (int first, int count, int column, float *scratch, benchstats_t *stats)
+{
+	double	sum;
+	int		i;
+
+	memset (stats, 0, sizeof(*stats));
+	if (count <= 0)
+		return;
+
+	sum = 0;
+	for (i = 0; i < count; i++)
+	{
+		scratch[i] = bench.samples[(first + i) * BENCH_NUMCOLUMNS + column];
+		sum += scratch[i];
+	}
+
+	qsort (scratch, count, sizeof(float), CL_BenchmarkCompare);
+
+	stats->mean = (float)(sum / count);
+	stats->p50 = CL_BenchmarkPercentile (scratch, count, 50);
+	stats->p90 = CL_BenchmarkPercentile (scratch, count, 90);
+	stats->p99 = CL_BenchmarkPercentile (scratch, count, 99);
+	stats->max = scratch[count - 1];
+}
+
+/*
+================
+CL_BenchmarkReport
+
+Prints one demo (or the whole run) and appends it as a JSON object.
+================
+*/
+static void CL_BenchmarkReport (FILE *f, const char *name, int first, int count, double seconds, float *scratch)
+{
+	benchstats_t	stats;
+	double			fps;
+	int				i;
+
+	fps = seconds > 0 ? count / seconds : 0;
+
+	Com_Printf ("%s: %i frames, %3.1f seconds: %3.1f fps\n", name, count, seconds, fps);
+
+	fprintf (f, "{ \"name\": \"%s\", \"frames\": %i, \"seconds\": %.3f, \"fps\": %.2f", name, count, seconds, fps);
+
+	for (i = BENCH_NUMCOLUMNS - 1; i >= 0; i--)
+	{
+		CL_BenchmarkStats (first, count, i, scratch, &stats);
+
+		Com_Printf ("  %-10s p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f ms\n",
+			bench_columnnames[i], stats.p50, stats.p90, stats.p99, stats.max);
+
+		fprintf (f, ",\n      \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+			bench_columnnames[i], stats.mean, stats.p50, stats.p90, stats.p99, stats.max);
+	}
+
+	fprintf (f, " }");
+}
+
+/*
+================
+CL_BenchmarkFinish
+
+Writes <gamedir>/benchmark.json, all times are in milliseconds.
+================
+*/
+static void CL_BenchmarkFinish (void)
+{
+	char	name[MAX_OSPATH];
+	FILE	*f;
+	float	*scratch;
+	double	seconds;
+	int		i;
+
+	bench.active = false;
+	Cvar_Set ("timedemo", bench.oldtimedemo);
+
+	Com_sprintf (name, sizeof(name), "%s/benchmark.json", FS_Gamedir ());
+	f = fopen (name, "w");
+	scratch = malloc ((bench.numsamples ? bench.numsamples : 1) * sizeof(float));
+
+	if (!f || !scratch)
+	{
+		Com_Printf ("CL_BenchmarkFinish: couldn't write %s\n", name);
+		if (f)
+			fclose (f);
+		free (scratch);
+		free (bench.samples);
+		bench.samples = NULL;
+		return;
+	}
+
+	Com_Printf ("\n====== benchmark ======\n");
+
+	fprintf (f, "{\n");
+	fprintf (f, "  \"version\": \"%s %s %s %s\",\n", VKQUAKE2_VERSION, CPUSTRING, __DATE__, BUILDSTRING);
+	fprintf (f, "  \"renderer\": \"%s\",\n", Cvar_VariableString ("vid_ref"));
+	fprintf (f, "  \"width\": %i,\n  \"height\": %i,\n", viddef.width, viddef.height);
+	fprintf (f, "  \"demos\": [\n");
+
+	seconds = 0;
+	for (i = 0; i < bench.numdemos; i++)
+	{
+		fprintf (f, "    ");
+		CL_BenchmarkReport (f, bench.demos[i].name, bench.demos[i].firstframe,
+			bench.demos[i].numframes, bench.demos[i].seconds, scratch);
+		fprintf (f, i < bench.numdemos - 1 ? ",\n" : "\n");
+		seconds += bench.demos[i].seconds;
+	}
+
+	fprintf (f, "  ],\n  \"total\": ");
+	CL_BenchmarkReport (f, "total", 0, bench.numsamples, seconds, scratch);
+	fprintf (f, "\n}\n");
+
+	fclose (f);
+	free (scratch);
+	free (bench.samples);
+	bench.samples = NULL;
+
+	Com_Printf ("wrote %s\n", name);
+
+	if (cl_benchmarkquit->value)
+		Cbuf_AddText ("quit\n");
+}
+
+/*
+================
+CL_BenchmarkDemoCompleted
+
+Called from CL_Disconnect.  The demo that just ended is closed off
+and the next one is started.
+================
+*/
+void CL_BenchmarkDemoCompleted (void)
+{
+	benchdemo_t	*demo;
+
+	if (!bench.active)
+		return;
+
+	demo = &bench.demos[bench.current];
+	demo->numframes = bench.numsamples - demo->firstframe;
+	demo->seconds = demo->numframes ? bench.lastframeend - bench.demostart : 0;
+
+	if (++bench.current == bench.numdemos)
+	{
+		CL_BenchmarkFinish ();
+		return;
+	}
+
+	bench.demos[bench.current].firstframe = bench.numsamples;
+	Cbuf_AddText (va ("demomap \"%s\"\n", bench.demos[bench.current].name));
+}
+
+/*
+================
+CL_Benchmark_f
+
+benchmark <demo> [demo ...]
+benchmark with no arguments aborts a run in progress.
+================
+*/
+void CL_Benchmark_f (void)
+{
+	char	*name;
+	int		i;
+
+	if (Cmd_Argc () < 2)
+	{
+		if (bench.active)
+		{
+			bench.active = false;
+			Cvar_Set ("timedemo", bench.oldtimedemo);
+			free (bench.samples);
+			bench.samples = NULL;
+			Com_Printf ("benchmark aborted\n");
+			return;
+		}
+		Com_Printf ("usage: benchmark <demo> [demo ...]\n");
+		return;
+	}
+
+	if (bench.active)
+	{
+		Com_Printf ("a benchmark is already running\n");
+		return;
+	}
+
+	memset (&bench, 0, sizeof(bench));
+
+	for (i = 1; i < Cmd_Argc () && bench.numdemos < MAX_BENCHMARK_DEMOS; i++)
+	{
+		name = bench.demos[bench.numdemos].name;
+
+		strncpy (name, Cmd_Argv (i), MAX_QPATH - 5);
+		if (!strstr (name, "."))
+			strcat (name, ".dm2");
+
+		if (strchr (name, '"') || strchr (name, '\\'))
+		{
+			Com_Printf ("benchmark: bad demo name %s\n", name);
+			continue;
+		}
+		if (FS_LoadFile (va ("demos/%s", name), NULL) == -1)
+		{
+			Com_Printf ("benchmark: couldn't find demos/%s\n", name);
+			continue;
+		}
+
+		bench.numdemos++;
+	}
+
+	if (!bench.numdemos)
+		return;
+
+	strncpy (bench.oldtimedemo, Cvar_VariableString ("timedemo"), sizeof(bench.oldtimedemo) - 1);
+	Cvar_Set ("timedemo", "1");
+
+	bench.active = true;
+	Cbuf_AddText (va ("demomap \"%s\"\n", bench.demos[0].name));
+}
+
+/*
+================
+CL_BenchmarkInit
+================
+*/
+void CL_BenchmarkInit (void)
+{
+	cl_benchmarkquit = Cvar_Get ("cl_benchmarkquit", "0", 0);
+
+	Cmd_AddCommand ("benchmark", CL_Benchmark_f);
+}
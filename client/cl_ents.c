@@ -828,53 +828,97 @@ struct model_s *S_RegisterSexedModel (entity_state_t *ent, char *base)
 // PMM - used in shell code 
 extern int Developer_searchpath (int who);
 // pmm
+
+/*
+==========================================================================
+
+ENTITY LERP CACHE
+
+Everything about a packet entity that only changes when a new server frame
+arrives (effect remapping, model and skin lookups, the two transforms to
+interpolate between) is worked out once per received frame and kept as
+parallel arrays.  CL_AddPacketEntities then only lerps and emits, which is
+all that has to happen at render rates above the 10hz server tick.
+
+==========================================================================
+*/
+
+typedef struct
+{
+	int				serverframe;	// cl.frame.serverframe the cache was built from
+	int				generation;		// cl_entlerp_generation when built
+	int				numentities;
+
+	entity_state_t	*state[MAX_EDICTS];
+	centity_t		*cent[MAX_EDICTS];
+
+	unsigned int	effects[MAX_EDICTS];	// quad/pent/etc folded into EF_COLOR_SHELL
+	unsigned int	renderfx[MAX_EDICTS];	// with the matching RF_SHELL_* bits
+	unsigned int	shellfx[MAX_EDICTS];	// renderfx for the color shell entity
+
+	vec3_t			fromorigin[MAX_EDICTS];	// both current.origin if stepped
+	vec3_t			toorigin[MAX_EDICTS];
+	vec3_t			fromangles[MAX_EDICTS];
+	vec3_t			toangles[MAX_EDICTS];
+	int				oldframe[MAX_EDICTS];
+
+	struct model_s	*model[MAX_EDICTS];
+	struct image_s	*skin[MAX_EDICTS];
+	int				skinnum[MAX_EDICTS];
+	struct model_s	*model2[MAX_EDICTS];
+	qboolean		translucent2[MAX_EDICTS];	// defender sphere shell
+} entlerp_t;
+
+static entlerp_t	cl_entlerp;
+static int			cl_entlerp_generation;
+static float		cl_entlerp_vwep;
+
 /*
 ===============
-CL_AddPacketEntities
+CL_InvalidateEntityLerps
 
+Model, skin and clientinfo changes make the cached lookups stale.
 ===============
 */
-void CL_AddPacketEntities (frame_t *frame)
+void CL_InvalidateEntityLerps (void)
 {
-	entity_t			ent;
+	cl_entlerp_generation++;
+}
+
+/*
+===============
+CL_BuildEntityLerps
+
+===============
+*/
+static void CL_BuildEntityLerps (frame_t *frame)
+{
+	entlerp_t			*el;
 	entity_state_t		*s1;
-	float				autorotate;
-	int					i;
-	int					pnum;
 	centity_t			*cent;
-	int					autoanim;
 	clientinfo_t		*ci;
+	struct model_s		*model;
+	struct image_s		*skin;
 	unsigned int		effects, renderfx;
+	int					pnum, n, i;
 
-	// bonus items rotate at a fixed rate
-	autorotate = anglemod(cl.time/10);
+	el = &cl_entlerp;
+	el->serverframe = frame->serverframe;
+	el->generation = cl_entlerp_generation;
+	cl_entlerp_vwep = cl_vwep->value;
 
-	// brush models can auto animate their frames
-	autoanim = 2*cl.time/1000;
-
-	memset (&ent, 0, sizeof(ent));
-
-	for (pnum = 0 ; pnum<frame->num_entities ; pnum++)
+	for (pnum = 0, n = 0 ; pnum<frame->num_entities && n<MAX_EDICTS ; pnum++, n++)
 	{
 		s1 = &cl_parse_entities[(frame->parse_entities+pnum)&(MAX_PARSE_ENTITIES-1)];
 
 		cent = &cl_entities[s1->number];
 
+		el->state[n] = s1;
+		el->cent[n] = cent;
+
 		effects = s1->effects;
 		renderfx = s1->renderfx;
 
-			// set frame
-		if (effects & EF_ANIM01)
-			ent.frame = autoanim & 1;
-		else if (effects & EF_ANIM23)
-			ent.frame = 2 + (autoanim & 1);
-		else if (effects & EF_ANIM_ALL)
-			ent.frame = autoanim;
-		else if (effects & EF_ANIM_ALLFAST)
-			ent.frame = cl.time / 100;
-		else
-			ent.frame = s1->frame;
-
 		// quad and pent can do different things on client
 		if (effects & EF_PENT)
 		{
@@ -906,66 +950,62 @@ void CL_AddPacketEntities (frame_t *frame)
 		}
 // pmm
 //======
-		ent.oldframe = cent->prev.frame;
-		ent.backlerp = 1.0 - cl.lerpfrac;
+		el->effects[n] = effects;
+		el->renderfx[n] = renderfx;
+		el->oldframe[n] = cent->prev.frame;
 
 		if (renderfx & (RF_FRAMELERP|RF_BEAM))
 		{	// step origin discretely, because the frames
 			// do the animation properly
-			VectorCopy (cent->current.origin, ent.origin);
-			VectorCopy (cent->current.old_origin, ent.oldorigin);
+			VectorCopy (cent->current.origin, el->fromorigin[n]);
+			VectorCopy (cent->current.origin, el->toorigin[n]);
 		}
 		else
-		{	// interpolate origin
-			for (i=0 ; i<3 ; i++)
-			{
-				ent.origin[i] = ent.oldorigin[i] = cent->prev.origin[i] + cl.lerpfrac * 
-					(cent->current.origin[i] - cent->prev.origin[i]);
-			}
+		{
+			VectorCopy (cent->prev.origin, el->fromorigin[n]);
+			VectorCopy (cent->current.origin, el->toorigin[n]);
 		}
 
-		// create a new entity
-	
-		// tweak the color of beams
-		if ( renderfx & RF_BEAM )
-		{	// the four beam colors are encoded in 32 bits of skinnum (hack)
-			ent.alpha = 0.30;
-			ent.skinnum = (s1->skinnum >> ((rand() % 4)*8)) & 0xff;
-			ent.model = NULL;
-		}
-		else
+		VectorCopy (cent->prev.angles, el->fromangles[n]);
+		VectorCopy (cent->current.angles, el->toangles[n]);
+
+		// beams pick their color every render frame
+		model = NULL;
+		skin = NULL;
+		el->skinnum[n] = 0;
+
+		if (!(renderfx & RF_BEAM))
 		{
 			// set skin
 			if (s1->modelindex == 255)
 			{	// use custom player skin
-				ent.skinnum = 0;
 				ci = &cl.clientinfo[s1->skinnum & 0xff];
-				ent.skin = ci->skin;
-				ent.model = ci->model;
-				if (!ent.skin || !ent.model)
+				skin = ci->skin;
+				model = ci->model;
+				if (!skin || !model)
 				{
-					ent.skin = cl.baseclientinfo.skin;
-					ent.model = cl.baseclientinfo.model;
+					skin = cl.baseclientinfo.skin;
+					model = cl.baseclientinfo.model;
 				}
 
 //============
 //PGM
 				if (renderfx & RF_USE_DISGUISE)
 				{
-					if(!strncmp((char *)ent.skin, "players/male", 12))
+					if(!strncmp((char *)skin, "players/male", 12))
 					{
-						ent.skin = re.RegisterSkin ("players/male/disguise.pcx");
-						ent.model = re.RegisterModel ("players/male/tris.md2");
+						skin = re.RegisterSkin ("players/male/disguise.pcx");
+						model = re.RegisterModel ("players/male/tris.md2");
 					}
-					else if(!strncmp((char *)ent.skin, "players/female", 14))
+					else if(!strncmp((char *)skin, "players/female", 14))
 					{
-						ent.skin = re.RegisterSkin ("players/female/disguise.pcx");
-						ent.model = re.RegisterModel ("players/female/tris.md2");
+						skin = re.RegisterSkin ("players/female/disguise.pcx");
+						model = re.RegisterModel ("players/female/tris.md2");
 					}
-					else if(!strncmp((char *)ent.skin, "players/cyborg", 14))
+					else if(!strncmp((char *)skin, "players/cyborg", 14))
 					{
-						ent.skin = re.RegisterSkin ("players/cyborg/disguise.pcx");
-						ent.model = re.RegisterModel ("players/cyborg/tris.md2");
+						skin = re.RegisterSkin ("players/cyborg/disguise.pcx");
+						model = re.RegisterModel ("players/cyborg/tris.md2");
 					}
 				}
 //PGM
@@ -973,10 +1013,167 @@ void CL_AddPacketEntities (frame_t *frame)
 			}
 			else
 			{
-				ent.skinnum = s1->skinnum;
-				ent.skin = NULL;
-				ent.model = cl.model_draw[s1->modelindex];
+				el->skinnum[n] = s1->skinnum;
+				model = cl.model_draw[s1->modelindex];
+			}
+		}
+		el->model[n] = model;
+		el->skin[n] = skin;
+
+		// color shells generate a seperate entity for the main model
+		if (effects & EF_COLOR_SHELL)
+		{
+			// PMM - at this point, all of the shells have been handled
+			// if we're in the rogue pack, set up the custom mixing, otherwise just
+			// keep going
+			// all of the solo colors are fine.  we need to catch any of the combinations that look bad
+			// (double & half) and turn them into the appropriate color, and make double/quad something special
+			if ((renderfx & (RF_SHELL_HALF_DAM|RF_SHELL_DOUBLE)) && Developer_searchpath(2) == 2)
+			{
+				if (renderfx & RF_SHELL_HALF_DAM)
+				{
+					// ditch the half damage shell if any of red, blue, or double are on
+					if (renderfx & (RF_SHELL_RED|RF_SHELL_BLUE|RF_SHELL_DOUBLE))
+						renderfx &= ~RF_SHELL_HALF_DAM;
+				}
+
+				if (renderfx & RF_SHELL_DOUBLE)
+				{
+					// lose the yellow shell if we have a red, blue, or green shell
+					if (renderfx & (RF_SHELL_RED|RF_SHELL_BLUE|RF_SHELL_GREEN))
+						renderfx &= ~RF_SHELL_DOUBLE;
+					// if we have a red shell, turn it to purple by adding blue
+					if (renderfx & RF_SHELL_RED)
+						renderfx |= RF_SHELL_BLUE;
+					// if we have a blue shell (and not a red shell), turn it to cyan by adding green
+					else if (renderfx & RF_SHELL_BLUE)
+					{
+						// go to green if it's on already, otherwise do cyan (flash green)
+						if (renderfx & RF_SHELL_GREEN)
+							renderfx &= ~RF_SHELL_BLUE;
+						else
+							renderfx |= RF_SHELL_GREEN;
+					}
+				}
 			}
+			// pmm
+		}
+		el->shellfx[n] = renderfx | RF_TRANSLUCENT;
+
+		// duplicate for linked models
+		el->model2[n] = NULL;
+		el->translucent2[n] = false;
+		if (s1->modelindex2)
+		{
+			if (s1->modelindex2 == 255)
+			{	// custom weapon
+				ci = &cl.clientinfo[s1->skinnum & 0xff];
+				i = (s1->skinnum >> 8); // 0 is default weapon model
+				if (!cl_vwep->value || i > MAX_CLIENTWEAPONMODELS - 1)
+					i = 0;
+				model = ci->weaponmodel[i];
+				if (!model) {
+					if (i != 0)
+						model = ci->weaponmodel[0];
+					if (!model)
+						model = cl.baseclientinfo.weaponmodel[0];
+				}
+			}
+			else
+				model = cl.model_draw[s1->modelindex2];
+			el->model2[n] = model;
+
+			// PMM - check for the defender sphere shell .. make it translucent
+			// replaces the previous version which used the high bit on modelindex2 to determine transparency
+			if (!Q_strcasecmp (cl.configstrings[CS_MODELS+(s1->modelindex2)], "models/items/shell/tris.md2"))
+				el->translucent2[n] = true;
+			// pmm
+		}
+	}
+
+	el->numentities = n;
+}
+
+/*
+===============
+CL_AddPacketEntities
+
+===============
+*/
+void CL_AddPacketEntities (frame_t *frame)
+{
+	entlerp_t			*el;
+	entity_t			ent;
+	entity_state_t		*s1;
+	float				autorotate;
+	int					i;
+	int					n;
+	centity_t			*cent;
+	int					autoanim;
+	unsigned int		effects, renderfx;
+	float				lerp, a1, a2;
+
+	el = &cl_entlerp;
+	if (el->serverframe != frame->serverframe || el->generation != cl_entlerp_generation
+		|| cl_entlerp_vwep != cl_vwep->value)
+		CL_BuildEntityLerps (frame);
+
+	// bonus items rotate at a fixed rate
+	autorotate = anglemod(cl.time/10);
+
+	// brush models can auto animate their frames
+	autoanim = 2*cl.time/1000;
+
+	lerp = cl.lerpfrac;
+
+	memset (&ent, 0, sizeof(ent));
+
+	for (n = 0 ; n<el->numentities ; n++)
+	{
+		s1 = el->state[n];
+		cent = el->cent[n];
+
+		effects = el->effects[n];
+		renderfx = el->renderfx[n];
+
+			// set frame
+		if (effects & EF_ANIM01)
+			ent.frame = autoanim & 1;
+		else if (effects & EF_ANIM23)
+			ent.frame = 2 + (autoanim & 1);
+		else if (effects & EF_ANIM_ALL)
+			ent.frame = autoanim;
+		else if (effects & EF_ANIM_ALLFAST)
+			ent.frame = cl.time / 100;
+		else
+			ent.frame = s1->frame;
+
+		ent.oldframe = el->oldframe[n];
+		ent.backlerp = 1.0 - lerp;
+
+		// interpolate origin, stepped entities have from == to
+		for (i=0 ; i<3 ; i++)
+			ent.origin[i] = el->fromorigin[n][i] + lerp * (el->toorigin[n][i] - el->fromorigin[n][i]);
+
+		if (renderfx & (RF_FRAMELERP|RF_BEAM))
+			VectorCopy (cent->current.old_origin, ent.oldorigin);
+		else
+			VectorCopy (ent.origin, ent.oldorigin);
+
+		// create a new entity
+	
+		// tweak the color of beams
+		if ( renderfx & RF_BEAM )
+		{	// the four beam colors are encoded in 32 bits of skinnum (hack)
+			ent.alpha = 0.30;
+			ent.skinnum = (s1->skinnum >> ((rand() % 4)*8)) & 0xff;
+			ent.model = NULL;
+		}
+		else
+		{
+			ent.skinnum = el->skinnum[n];
+			ent.skin = el->skin[n];
+			ent.model = el->model[n];
 		}
 
 		// only used for black hole model right now, FIXME: do better
@@ -1013,13 +1210,11 @@ void CL_AddPacketEntities (frame_t *frame)
 		}
 		else
 		{	// interpolate angles
-			float	a1, a2;
-
 			for (i=0 ; i<3 ; i++)
 			{
-				a1 = cent->current.angles[i];
-				a2 = cent->prev.angles[i];
-				ent.angles[i] = LerpAngle (a2, a1, cl.lerpfrac);
+				a1 = el->toangles[n][i];
+				a2 = el->fromangles[n][i];
+				ent.angles[i] = LerpAngle (a2, a1, lerp);
 			}
 		}
 
@@ -1075,45 +1270,7 @@ void CL_AddPacketEntities (frame_t *frame)
 		// color shells generate a seperate entity for the main model
 		if (effects & EF_COLOR_SHELL)
 		{
-			// PMM - at this point, all of the shells have been handled
-			// if we're in the rogue pack, set up the custom mixing, otherwise just
-			// keep going
-//			if(Developer_searchpath(2) == 2)
-//			{
-				// all of the solo colors are fine.  we need to catch any of the combinations that look bad
-				// (double & half) and turn them into the appropriate color, and make double/quad something special
-				if (renderfx & RF_SHELL_HALF_DAM)
-				{
-					if(Developer_searchpath(2) == 2)
-					{
-						// ditch the half damage shell if any of red, blue, or double are on
-						if (renderfx & (RF_SHELL_RED|RF_SHELL_BLUE|RF_SHELL_DOUBLE))
-							renderfx &= ~RF_SHELL_HALF_DAM;
-					}
-				}
-
-				if (renderfx & RF_SHELL_DOUBLE)
-				{
-					if(Developer_searchpath(2) == 2)
-					{
-						// lose the yellow shell if we have a red, blue, or green shell
-						if (renderfx & (RF_SHELL_RED|RF_SHELL_BLUE|RF_SHELL_GREEN))
-							renderfx &= ~RF_SHELL_DOUBLE;
-						// if we have a red shell, turn it to purple by adding blue
-						if (renderfx & RF_SHELL_RED)
-							renderfx |= RF_SHELL_BLUE;
-						// if we have a blue shell (and not a red shell), turn it to cyan by adding green
-						else if (renderfx & RF_SHELL_BLUE)
-							// go to green if it's on already, otherwise do cyan (flash green)
-							if (renderfx & RF_SHELL_GREEN)
-								renderfx &= ~RF_SHELL_BLUE;
-							else
-								renderfx |= RF_SHELL_GREEN;
-					}
-				}
-//			}
-			// pmm
-			ent.flags = renderfx | RF_TRANSLUCENT;
+			ent.flags = el->shellfx[n];
 			ent.alpha = 0.30;
 			V_AddEntity (&ent);
 		}
@@ -1126,31 +1283,13 @@ void CL_AddPacketEntities (frame_t *frame)
 		// duplicate for linked models
 		if (s1->modelindex2)
 		{
-			if (s1->modelindex2 == 255)
-			{	// custom weapon
-				ci = &cl.clientinfo[s1->skinnum & 0xff];
-				i = (s1->skinnum >> 8); // 0 is default weapon model
-				if (!cl_vwep->value || i > MAX_CLIENTWEAPONMODELS - 1)
-					i = 0;
-				ent.model = ci->weaponmodel[i];
-				if (!ent.model) {
-					if (i != 0)
-						ent.model = ci->weaponmodel[0];
-					if (!ent.model)
-						ent.model = cl.baseclientinfo.weaponmodel[0];
-				}
-			}
-			else
-				ent.model = cl.model_draw[s1->modelindex2];
+			ent.model = el->model2[n];
 
-			// PMM - check for the defender sphere shell .. make it translucent
-			// replaces the previous version which used the high bit on modelindex2 to determine transparency
-			if (!Q_strcasecmp (cl.configstrings[CS_MODELS+(s1->modelindex2)], "models/items/shell/tris.md2"))
+			if (el->translucent2[n])
 			{
 				ent.alpha = 0.32;
 				ent.flags = RF_TRANSLUCENT;
 			}
-			// pmm
 
 			V_AddEntity (&ent);
 
@@ -1512,7 +1651,9 @@ void CL_AddEntities (void)
 	CL_AddProjectiles ();
 #endif
 	CL_AddTEnts ();
+	CL_BenchmarkStart (BENCH_PARTICLES);
 	CL_AddParticles ();
+	CL_BenchmarkStop (BENCH_PARTICLES);
 	CL_AddDLights ();
 	CL_AddLightStyles ();
 }
@@ -601,6 +601,7 @@ void CL_ClearState (void)
 // wipe the entire cl structure
 	memset (&cl, 0, sizeof(cl));
 	memset (&cl_entities, 0, sizeof(cl_entities));
+	CL_InvalidateEntityLerps ();
 
 	SZ_Clear (&cls.netchan.message);
 
@@ -632,6 +633,8 @@ void CL_Disconnect (void)
 			time/1000.0, cl.timedemo_frames*1000.0 / time);
 	}
 
+	CL_BenchmarkDemoCompleted ();
+
 	VectorClear (cl.refdef.blend);
 	re.CinematicSetPalette(NULL);
 
@@ -1021,7 +1024,9 @@ void CL_ReadPackets (void)
 		}
 		if (!Netchan_Process(&cls.netchan, &net_message))
 			continue;		// wasn't accepted for some reason
+		CL_BenchmarkStart (BENCH_PARSE);
 		CL_ParseServerMessage ();
+		CL_BenchmarkStop (BENCH_PARSE);
 	}
 
 	//
@@ -1413,6 +1418,8 @@ void CL_InitLocal (void)
 
 	CL_InitInput ();
 
+	CL_BenchmarkInit ();
+
 	adr0 = Cvar_Get( "adr0", "", CVAR_ARCHIVE );
 	adr1 = Cvar_Get( "adr1", "", CVAR_ARCHIVE );
 	adr2 = Cvar_Get( "adr2", "", CVAR_ARCHIVE );
@@ -1696,6 +1703,8 @@ void CL_Frame (int msec)
 			return;			// framerate is too high
 	}
 
+	CL_BenchmarkBeginFrame ();
+
 	// let the mouse activate or deactivate
 	IN_Frame ();
 
@@ -1739,7 +1748,9 @@ void CL_Frame (int msec)
 		time_after_ref = Sys_Milliseconds ();
 
 	// update audio
+	CL_BenchmarkStart (BENCH_SOUND);
 	S_Update (cl.refdef.vieworg, cl.v_forward, cl.v_right, cl.v_up);
+	CL_BenchmarkStop (BENCH_SOUND);
 	
 	CDAudio_Update();
 	Miniaudio_Update();
@@ -1752,6 +1763,8 @@ void CL_Frame (int msec)
 
 	cls.framecount++;
 
+	CL_BenchmarkEndFrame ();
+
 	if ( log_stats->value )
 	{
 		if ( cls.state == ca_active )
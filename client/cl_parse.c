@@ -508,6 +508,7 @@ void CL_ParseClientinfo (int player)
 	ci = &cl.clientinfo[player];
 
 	CL_LoadClientinfo (ci, s);
+	CL_InvalidateEntityLerps ();
 }
 
 
@@ -555,6 +556,7 @@ void CL_ParseConfigString (void)
 			else
 				cl.model_clip[i-CS_MODELS] = NULL;
 		}
+		CL_InvalidateEntityLerps ();
 	}
 	else if (i >= CS_SOUNDS && i < CS_SOUNDS+MAX_MODELS)
 	{
@@ -261,6 +261,8 @@ void CL_PrepRefresh (void)
 	SCR_AddDirtyPoint (0, 0);
 	SCR_AddDirtyPoint (viddef.width-1, viddef.height-1);
 
+	CL_InvalidateEntityLerps ();
+
 	// let the render dll load the map
 	strcpy (mapname, cl.configstrings[CS_MODELS+1] + 5);	// skip "maps/"
 	mapname[strlen(mapname)-4] = 0;		// cut off ".bsp"
@@ -480,7 +482,9 @@ void V_RenderView( float stereo_separation )
 		// build a refresh entity list and calc cl.sim*
 		// this also calls CL_CalcViewValues which loads
 		// v_forward, etc.
+		CL_BenchmarkStart (BENCH_ENTITIES);
 		CL_AddEntities ();
+		CL_BenchmarkStop (BENCH_ENTITIES);
 
 		if (cl_testparticles->value)
 			V_TestParticles ();
@@ -546,7 +550,9 @@ void V_RenderView( float stereo_separation )
         qsort( cl.refdef.entities, cl.refdef.num_entities, sizeof( cl.refdef.entities[0] ), (int (*)(const void *, const void *))entitycmpfnc );
 	}
 
+	CL_BenchmarkStart (BENCH_RENDER);
 	re.RenderFrame (&cl.refdef);
+	CL_BenchmarkStop (BENCH_RENDER);
 	if (cl_stats->value)
 		Com_Printf ("ent:%i  lt:%i  part:%i\n", r_numentities, r_numdlights, r_numparticles);
 	if ( log_stats->value && ( log_stats_file != 0 ) )
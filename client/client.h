@@ -432,6 +432,7 @@ void CL_RunDLights (void);
 void CL_RunLightStyles (void);
 
 void CL_AddEntities (void);
+void CL_InvalidateEntityLerps (void);
 void CL_AddDLights (void);
 void CL_AddTEnts (void);
 void CL_AddLightStyles (void);
@@ -577,6 +578,26 @@ void CL_DrawInventory (void);
 //
 void CL_PredictMovement (void);
 
+//
+// cl_bench.c
+//
+typedef enum
+{
+	BENCH_PARSE,		// CL_ParseServerMessage
+	BENCH_ENTITIES,		// CL_AddEntities, minus particles
+	BENCH_PARTICLES,	// CL_AddParticles
+	BENCH_SOUND,		// S_Update
+	BENCH_RENDER,		// re.RenderFrame
+	BENCH_NUMTIMERS
+} benchtimer_t;
+
+void CL_BenchmarkInit (void);
+void CL_BenchmarkStart (benchtimer_t timer);
+void CL_BenchmarkStop (benchtimer_t timer);
+void CL_BenchmarkBeginFrame (void);
+void CL_BenchmarkEndFrame (void);
+void CL_BenchmarkDemoCompleted (void);
+
 #if id386
 void x86_TimerStart( void );
 void x86_TimerStop( void );
@@ -232,6 +232,8 @@ void InitGame (void)
 //ZOID
 	CTFInit();
 //ZOID
+
+	ED_InitFieldHash ();
 }
 
 //=========================================================
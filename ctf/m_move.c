@@ -507,6 +507,47 @@ qboolean SV_CloseEnough (edict_t *ent, edict_t *goal, float dist)
 }
 
 
+#define	NAV_REPATH	1.0		// seconds before a monster asks for its route again
+
+/*
+======================
+M_NavMove
+
+Steers a walking monster along the server's navigation graph towards an
+enemy it can't see.  Returns false if the graph has nothing to offer, the
+caller then falls back to SV_NewChaseDir.
+======================
+*/
+static qboolean M_NavMove (edict_t *ent, edict_t *goal)
+{
+	vec3_t	v;
+
+	if (ent->flags & (FL_FLY|FL_SWIM))
+		return false;
+	if (visible (ent, goal))
+		return false;		// straight chasing works fine in the open
+
+	// ask again once the point is reached, the route then starts past it
+	VectorSubtract (ent->monsterinfo.nav_point, ent->s.origin, v);
+	v[2] = 0;
+	if (level.time >= ent->monsterinfo.nav_time || VectorLength (v) < 16)
+	{
+		if (!gi.nav_route (ent->s.origin, goal->s.origin, ent->monsterinfo.nav_point))
+		{
+			ent->monsterinfo.nav_time = 0;
+			return false;
+		}
+		ent->monsterinfo.nav_time = level.time + NAV_REPATH;
+
+		VectorSubtract (ent->monsterinfo.nav_point, ent->s.origin, v);
+		v[2] = 0;
+	}
+
+	ent->ideal_yaw = vectoyaw (v);
+	return true;
+}
+
+
 /*
 ======================
 M_MoveToGoal
@@ -525,6 +566,18 @@ void M_MoveToGoal (edict_t *ent, float dist)
 	if (ent->enemy &&  SV_CloseEnough (ent, ent->enemy, dist) )
 		return;
 
+// follow the navigation graph towards an enemy out of sight, ai_run has
+// pointed goalentity at the last sighting marker by then
+	if (ent->enemy && (goal == ent->enemy || (ent->monsterinfo.aiflags & AI_LOST_SIGHT))
+		&& M_NavMove (ent, ent->enemy))
+	{
+		if (SV_StepDirection (ent, ent->ideal_yaw, dist))
+			return;
+		ent->monsterinfo.nav_time = 0;
+		if (!ent->inuse)
+			return;
+	}
+
 // bump around...
 	if ( (rand()&3)==1 || !SV_StepDirection (ent, ent->ideal_yaw, dist))
 	{
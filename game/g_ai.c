@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 // g_ai.c
 
 #include "g_local.h"
+#include "g_core.h"
 
 qboolean FindTarget (edict_t *self);
 extern cvar_t	*maxclients;
@@ -52,6 +53,9 @@ void AI_SetSightClient (void)
 	edict_t	*ent;
 	int		start, check;
 
+	// visible() results of the last frame are stale now
+	GC_NewVisibleFrame ();
+
 	if (level.sight_client == NULL)
 		start = 1;
 	else
@@ -279,13 +283,14 @@ int range (edict_t *self, edict_t *other)
 
 /*
 =============
-visible
+CheckVisible
 
-returns 1 if the entity is visible to self, even if not infront ()
+traces from the eyes of self to those of other
 =============
 */
-qboolean visible (edict_t *self, edict_t *other)
+static qboolean CheckVisible (void *pself, void *pother)
 {
+	edict_t	*self = pself, *other = pother;
 	vec3_t	spot1;
 	vec3_t	spot2;
 	trace_t	trace;
@@ -294,6 +299,14 @@ qboolean visible (edict_t *self, edict_t *other)
 	spot1[2] += self->viewheight;
 	VectorCopy (other->s.origin, spot2);
 	spot2[2] += other->viewheight;
+
+	if (!gi.inPVS (spot1, spot2))
+	{
+		gc_visiblestats.pvsrejects++;
+		return false;
+	}
+
+	gc_visiblestats.traces++;
 	trace = gi.trace (spot1, vec3_origin, vec3_origin, spot2, self, MASK_OPAQUE);
 	
 	if (trace.fraction == 1.0)
@@ -301,6 +314,33 @@ qboolean visible (edict_t *self, edict_t *other)
 	return false;
 }
 
+/*
+=============
+visible
+
+returns 1 if the entity is visible to self, even if not infront ()
+=============
+*/
+qboolean visible (edict_t *self, edict_t *other)
+{
+	return GC_Visible (self, self - g_edicts, self->linkcount, other, other - g_edicts, other->linkcount, CheckVisible);
+}
+
+/*
+=============
+AI_PrintVisibleStats
+
+"sv losstats": how visible() calls were answered since the last report
+=============
+*/
+void AI_PrintVisibleStats (void)
+{
+	char	text[256];
+
+	GC_VisibleStatsString (text, sizeof(text));
+	gi.cprintf (NULL, PRINT_HIGH, "%s", text);
+}
+
 
 /*
 =============
@@ -33,6 +33,8 @@ qboolean CanDamage (edict_t *targ, edict_t *inflictor)
 {
 	vec3_t	dest;
 	trace_t	trace;
+	traceray_t	corners[4];
+	int		i;
 
 // bmodels need special checking because their origin is 0,0,0
 	if (targ->movetype == MOVETYPE_PUSH)
@@ -51,33 +53,20 @@ qboolean CanDamage (edict_t *targ, edict_t *inflictor)
 	if (trace.fraction == 1.0)
 		return true;
 
-	VectorCopy (targ->s.origin, dest);
-	dest[0] += 15.0;
-	dest[1] += 15.0;
-	trace = gi.trace (inflictor->s.origin, vec3_origin, vec3_origin, dest, inflictor, MASK_SOLID);
-	if (trace.fraction == 1.0)
-		return true;
-
-	VectorCopy (targ->s.origin, dest);
-	dest[0] += 15.0;
-	dest[1] -= 15.0;
-	trace = gi.trace (inflictor->s.origin, vec3_origin, vec3_origin, dest, inflictor, MASK_SOLID);
-	if (trace.fraction == 1.0)
-		return true;
+// the origin is blocked, try the four corners around it in one go
+	for (i=0 ; i<4 ; i++)
+	{
+		VectorCopy (inflictor->s.origin, corners[i].start);
+		VectorCopy (targ->s.origin, corners[i].end);
+		corners[i].end[0] += (i & 2) ? -15.0 : 15.0;
+		corners[i].end[1] += (i & 1) ? -15.0 : 15.0;
+	}
 
-	VectorCopy (targ->s.origin, dest);
-	dest[0] -= 15.0;
-	dest[1] += 15.0;
-	trace = gi.trace (inflictor->s.origin, vec3_origin, vec3_origin, dest, inflictor, MASK_SOLID);
-	if (trace.fraction == 1.0)
-		return true;
+	gi.trace_batch (corners, 4, vec3_origin, vec3_origin, inflictor, MASK_SOLID);
 
-	VectorCopy (targ->s.origin, dest);
-	dest[0] -= 15.0;
-	dest[1] -= 15.0;
-	trace = gi.trace (inflictor->s.origin, vec3_origin, vec3_origin, dest, inflictor, MASK_SOLID);
-	if (trace.fraction == 1.0)
-		return true;
+	for (i=0 ; i<4 ; i++)
+		if (corners[i].trace.fraction == 1.0)
+			return true;
 
 
 	return false;
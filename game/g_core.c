@@ -0,0 +1,118 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// g_core.c -- game code shared by every game module, see g_core.h
+
+#include "q_shared.h"
+#include "g_core.h"
+
+/*
+=============
+visible() cache
+
+FindTarget, ai_checkattack and the M_CheckAttack variants call visible()
+for every monster against its enemy and the sight client each think, so
+the results are kept until the next AI_SetSightClient.  Entries are keyed
+by both entities and their linkcounts, which change whenever either one is
+relinked after moving.  The mods' checks reject pairs that are not in each
+other's PVS without a trace.
+=============
+*/
+#define	LOS_CACHE_SIZE	1024		// must be a power of two
+
+typedef struct
+{
+	int			frame;
+	void		*self, *other;
+	int			selflink, otherlink;
+	qboolean	visible;
+} loscache_t;
+
+static loscache_t	los_cache[LOS_CACHE_SIZE];
+static int			los_frame;
+
+// reported by "sv losstats"
+gc_visiblestats_t	gc_visiblestats;
+
+/*
+=============
+GC_NewVisibleFrame
+
+Called once each frame, the cached results of the last one are stale now
+=============
+*/
+void GC_NewVisibleFrame (void)
+{
+	los_frame++;
+	gc_visiblestats.frames++;
+}
+
+/*
+=============
+GC_Visible
+
+Returns the cached result for the pair, or runs check and caches that
+=============
+*/
+qboolean GC_Visible (void *self, int selfnum, int selflink, void *other, int othernum, int otherlink, gc_checkvisible_t check)
+{
+	loscache_t	*los;
+
+	los = &los_cache[(selfnum * 67 + othernum) & (LOS_CACHE_SIZE - 1)];
+	if (los->frame == los_frame && los->self == self && los->other == other
+		&& los->selflink == selflink && los->otherlink == otherlink)
+	{
+		gc_visiblestats.hits++;
+		return los->visible;
+	}
+
+	los->frame = los_frame;
+	los->self = self;
+	los->other = other;
+	los->selflink = selflink;
+	los->otherlink = otherlink;
+	los->visible = check (self, other);
+	return los->visible;
+}
+
+/*
+=============
+GC_VisibleStatsString
+
+How visible() calls were answered since the last report
+=============
+*/
+void GC_VisibleStatsString (char *text, int size)
+{
+	gc_visiblestats_t	*st = &gc_visiblestats;
+	int		calls;
+
+	calls = st->hits + st->pvsrejects + st->traces;
+	if (!calls)
+		Com_sprintf (text, size, "0 visible() calls in %i frames\n", st->frames);
+	else
+		Com_sprintf (text, size, "%i visible() calls in %i frames\n"
+			"cached: %i (%.1f%%)  PVS rejects: %i (%.1f%%)  traces: %i (%.1f%%)\n",
+			calls, st->frames,
+			st->hits, 100.0 * st->hits / calls,
+			st->pvsrejects, 100.0 * st->pvsrejects / calls,
+			st->traces, 100.0 * st->traces / calls);
+
+	memset (st, 0, sizeof(*st));
+}
@@ -0,0 +1,54 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// g_core.h -- game code shared by every game module
+
+/*
+g_core.c is compiled once into the game core library and linked into every
+mod.  It never sees edict_t, gclient_t or level_locals_t, whose layouts
+differ between mods: entities are handed over as opaque pointers along with
+the fields the core needs, and the parts a mod does its own way come in as
+hooks.
+*/
+
+/*
+=============
+visible() cache
+
+The mod calls GC_NewVisibleFrame from AI_SetSightClient and routes
+visible() through GC_Visible, with its own line of sight check as the hook
+that fills the cache.
+=============
+*/
+typedef qboolean (*gc_checkvisible_t) (void *self, void *other);
+
+typedef struct
+{
+	int		frames;
+	int		hits;			// answered from the cache
+	int		pvsrejects;		// counted by the mods' checks
+	int		traces;
+} gc_visiblestats_t;
+
+extern gc_visiblestats_t	gc_visiblestats;
+
+void		GC_NewVisibleFrame (void);
+qboolean	GC_Visible (void *self, int selfnum, int selflink, void *other, int othernum, int otherlink, gc_checkvisible_t check);
+void		GC_VisibleStatsString (char *text, int size);
@@ -447,6 +447,9 @@ typedef struct
 
 	int			power_armor_type;
 	int			power_armor_power;
+
+	vec3_t		nav_point;		// where gi.nav_route said to walk to
+	float		nav_time;		// nav_point is asked for again after this
 } monsterinfo_t;
 
 
@@ -526,6 +529,7 @@ extern	cvar_t	*password;
 extern	cvar_t	*spectator_password;
 extern	cvar_t	*needpass;
 extern	cvar_t	*g_select_empty;
+extern	cvar_t	*g_antilag;
 extern	cvar_t	*dedicated;
 
 extern	cvar_t	*filterban;
@@ -627,6 +631,11 @@ gitem_t	*GetItemByIndex (int index);
 qboolean Add_Ammo (edict_t *ent, gitem_t *item, int count);
 void Touch_Item (edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
 
+//
+// g_spawn.c
+//
+void ED_InitFieldHash (void);
+
 //
 // g_utils.c
 //
@@ -723,6 +732,7 @@ int range (edict_t *self, edict_t *other);
 void FoundTarget (edict_t *self);
 qboolean infront (edict_t *self, edict_t *other);
 qboolean visible (edict_t *self, edict_t *other);
+void AI_PrintVisibleStats (void);
 qboolean FacingIdeal(edict_t *self);
 
 //
@@ -45,6 +45,7 @@ cvar_t	*maxclients;
 cvar_t	*maxspectators;
 cvar_t	*maxentities;
 cvar_t	*g_select_empty;
+cvar_t	*g_antilag;
 cvar_t	*dedicated;
 
 cvar_t	*filterban;
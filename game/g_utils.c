@@ -481,8 +481,7 @@ void	G_TouchTriggers (edict_t *ent)
 	if ((ent->client || (ent->svflags & SVF_MONSTER)) && (ent->health <= 0))
 		return;
 
-	num = gi.BoxEdicts (ent->absmin, ent->absmax, touch
-		, MAX_EDICTS, AREA_TRIGGERS);
+	num = gi.trigger_edicts (ent, touch, MAX_EDICTS);
 
 	// be careful, it is possible to have an entity in this
 	// list removed before we get to it (killtriggered)
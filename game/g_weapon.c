@@ -126,93 +126,131 @@ qboolean fire_hit (edict_t *self, vec3_t aim, int damage, int kick)
 
 /*
 =================
-fire_lead
+fire_lead_spread
 
-This is an internal support routine used for bullet/pellet based weapons.
+Picks the end point of a bullet fired from start along aimdir.
 =================
 */
-static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick, int te_impact, int hspread, int vspread, int mod)
+/*
+=================
+fire_lag
+
+How far back hitscan shots from self are traced, see fire_trace.
+=================
+*/
+static int fire_lag (edict_t *self)
+{
+	if (!g_antilag->value || !self->client)
+		return 0;
+	return self->client->ping;
+}
+
+/*
+=================
+fire_trace
+
+Traces a hitscan shot.  With g_antilag set, players are hit where the
+shooter saw them on their screen rather than where they are now.
+=================
+*/
+static trace_t fire_trace (edict_t *self, vec3_t start, vec3_t end, edict_t *ignore, int mask)
+{
+	int		lag;
+
+	lag = fire_lag (self);
+	if (lag > 0)
+		return gi.trace_rewind (start, NULL, NULL, end, ignore, mask, lag);
+	return gi.trace (start, NULL, NULL, end, ignore, mask);
+}
+
+static void fire_lead_spread (vec3_t start, vec3_t aimdir, int hspread, int vspread, vec3_t end)
 {
-	trace_t		tr;
 	vec3_t		dir;
 	vec3_t		forward, right, up;
-	vec3_t		end;
 	float		r;
 	float		u;
-	vec3_t		water_start;
-	qboolean	water = false;
-	int			content_mask = MASK_SHOT | MASK_WATER;
 
-	tr = gi.trace (self->s.origin, NULL, NULL, start, self, MASK_SHOT);
-	if (!(tr.fraction < 1.0))
-	{
-		vectoangles (aimdir, dir);
-		AngleVectors (dir, forward, right, up);
+	vectoangles (aimdir, dir);
+	AngleVectors (dir, forward, right, up);
 
-		r = crandom()*hspread;
-		u = crandom()*vspread;
-		VectorMA (start, 8192, forward, end);
-		VectorMA (end, r, right, end);
-		VectorMA (end, u, up, end);
+	r = crandom()*hspread;
+	u = crandom()*vspread;
+	VectorMA (start, 8192, forward, end);
+	VectorMA (end, r, right, end);
+	VectorMA (end, u, up, end);
+}
 
-		if (gi.pointcontents (start) & MASK_WATER)
-		{
-			water = true;
-			VectorCopy (start, water_start);
-			content_mask &= ~MASK_WATER;
-		}
+/*
+=================
+fire_lead_impact
 
-		tr = gi.trace (start, NULL, NULL, end, self, content_mask);
+Finishes a bullet once it has been traced from start to end: follows it
+into water, applies the damage or impact effect and draws the bubble trail.
+inwater is set if start is in water, the trace then ignored it.  Returns
+the entity that took the damage, if any.
+=================
+*/
+static edict_t *fire_lead_impact (edict_t *self, vec3_t start, vec3_t aimdir, vec3_t end, trace_t tr, qboolean inwater, int damage, int kick, int te_impact, int hspread, int vspread, int mod)
+{
+	vec3_t		dir;
+	vec3_t		forward, right, up;
+	float		r;
+	float		u;
+	vec3_t		water_start;
+	qboolean	water = inwater;
+	edict_t		*damaged = NULL;
 
-		// see if we hit water
-		if (tr.contents & MASK_WATER)
-		{
-			int		color;
+	if (water)
+		VectorCopy (start, water_start);
 
-			water = true;
-			VectorCopy (tr.endpos, water_start);
+	// see if we hit water
+	if (tr.contents & MASK_WATER)
+	{
+		int		color;
 
-			if (!VectorCompare (start, tr.endpos))
+		water = true;
+		VectorCopy (tr.endpos, water_start);
+
+		if (!VectorCompare (start, tr.endpos))
+		{
+			if (tr.contents & CONTENTS_WATER)
 			{
-				if (tr.contents & CONTENTS_WATER)
-				{
-					if (strcmp(tr.surface->name, "*brwater") == 0)
-						color = SPLASH_BROWN_WATER;
-					else
-						color = SPLASH_BLUE_WATER;
-				}
-				else if (tr.contents & CONTENTS_SLIME)
-					color = SPLASH_SLIME;
-				else if (tr.contents & CONTENTS_LAVA)
-					color = SPLASH_LAVA;
+				if (strcmp(tr.surface->name, "*brwater") == 0)
+					color = SPLASH_BROWN_WATER;
 				else
-					color = SPLASH_UNKNOWN;
-
-				if (color != SPLASH_UNKNOWN)
-				{
-					gi.WriteByte (svc_temp_entity);
-					gi.WriteByte (TE_SPLASH);
-					gi.WriteByte (8);
-					gi.WritePosition (tr.endpos);
-					gi.WriteDir (tr.plane.normal);
-					gi.WriteByte (color);
-					gi.multicast (tr.endpos, MULTICAST_PVS);
-				}
+					color = SPLASH_BLUE_WATER;
+			}
+			else if (tr.contents & CONTENTS_SLIME)
+				color = SPLASH_SLIME;
+			else if (tr.contents & CONTENTS_LAVA)
+				color = SPLASH_LAVA;
+			else
+				color = SPLASH_UNKNOWN;
 
-				// change bullet's course when it enters water
-				VectorSubtract (end, start, dir);
-				vectoangles (dir, dir);
-				AngleVectors (dir, forward, right, up);
-				r = crandom()*hspread*2;
-				u = crandom()*vspread*2;
-				VectorMA (water_start, 8192, forward, end);
-				VectorMA (end, r, right, end);
-				VectorMA (end, u, up, end);
+			if (color != SPLASH_UNKNOWN)
+			{
+				gi.WriteByte (svc_temp_entity);
+				gi.WriteByte (TE_SPLASH);
+				gi.WriteByte (8);
+				gi.WritePosition (tr.endpos);
+				gi.WriteDir (tr.plane.normal);
+				gi.WriteByte (color);
+				gi.multicast (tr.endpos, MULTICAST_PVS);
 			}
 
-			// re-trace ignoring water this time
-			tr = gi.trace (water_start, NULL, NULL, end, self, MASK_SHOT);
+			// change bullet's course when it enters water
+			VectorSubtract (end, start, dir);
+			vectoangles (dir, dir);
+			AngleVectors (dir, forward, right, up);
+			r = crandom()*hspread*2;
+			u = crandom()*vspread*2;
+			VectorMA (water_start, 8192, forward, end);
+			VectorMA (end, r, right, end);
+			VectorMA (end, u, up, end);
 		}
+
+		// re-trace ignoring water this time
+		tr = fire_trace (self, water_start, end, self, MASK_SHOT);
 	}
 
 	// send gun puff / flash
@@ -223,6 +261,7 @@ static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, i
 			if (tr.ent->takedamage)
 			{
 				T_Damage (tr.ent, self, self, aimdir, tr.endpos, tr.plane.normal, damage, kick, DAMAGE_BULLET, mod);
+				damaged = tr.ent;
 			}
 			else
 			{
@@ -263,6 +302,42 @@ static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, i
 		gi.WritePosition (tr.endpos);
 		gi.multicast (pos, MULTICAST_PVS);
 	}
+
+	return damaged;
+}
+
+
+/*
+=================
+fire_lead
+
+This is an internal support routine used for bullet/pellet based weapons.
+=================
+*/
+static void fire_lead (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick, int te_impact, int hspread, int vspread, int mod)
+{
+	trace_t		tr;
+	vec3_t		end;
+	qboolean	water = false;
+	int			content_mask = MASK_SHOT | MASK_WATER;
+
+	tr = gi.trace (self->s.origin, NULL, NULL, start, self, MASK_SHOT);
+	if (!(tr.fraction < 1.0))
+	{
+		fire_lead_spread (start, aimdir, hspread, vspread, end);
+
+		if (gi.pointcontents (start) & MASK_WATER)
+		{
+			water = true;
+			content_mask &= ~MASK_WATER;
+		}
+
+		tr = fire_trace (self, start, end, self, content_mask);
+	}
+	else
+		VectorCopy (start, end);
+
+	fire_lead_impact (self, start, aimdir, end, tr, water, damage, kick, te_impact, hspread, vspread, mod);
 }
 
 
@@ -287,12 +362,86 @@ fire_shotgun
 Shoots shotgun pellets.  Used by shotgun and super shotgun.
 =================
 */
+#define	MAX_PELLET_BATCH	32
+
 void fire_shotgun (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick, int hspread, int vspread, int count, int mod)
 {
-	int		i;
+	traceray_t	pellets[MAX_PELLET_BATCH];
+	int			linkcounts[MAX_PELLET_BATCH];
+	edict_t		*damaged[MAX_PELLET_BATCH];
+	edict_t		*hit;
+	trace_t		tr;
+	qboolean	water = false;
+	int			content_mask = MASK_SHOT | MASK_WATER;
+	int			i, j, n, batch, numdamaged;
 
-	for (i = 0; i < count; i++)
-		fire_lead (self, start, aimdir, damage, kick, TE_SHOTGUN, hspread, vspread, mod);
+	// all pellets leave from the same point, so the muzzle only needs checking once
+	tr = gi.trace (self->s.origin, NULL, NULL, start, self, MASK_SHOT);
+	if (tr.fraction < 1.0)
+	{
+		for (i = 0; i < count; i++)
+			fire_lead_impact (self, start, aimdir, start, tr, false, damage, kick, TE_SHOTGUN, hspread, vspread, mod);
+		return;
+	}
+
+	if (gi.pointcontents (start) & MASK_WATER)
+	{
+		water = true;
+		content_mask &= ~MASK_WATER;
+	}
+
+	for (i = 0; i < count; i += batch)
+	{
+		batch = count - i;
+		if (batch > MAX_PELLET_BATCH)
+			batch = MAX_PELLET_BATCH;
+
+		for (n = 0; n < batch; n++)
+		{
+			VectorCopy (start, pellets[n].start);
+			fire_lead_spread (start, aimdir, hspread, vspread, pellets[n].end);
+		}
+
+		// rewound traces are cheap on their own and can't share a query
+		if (fire_lag (self) > 0)
+		{
+			for (n = 0; n < batch; n++)
+				pellets[n].trace = fire_trace (self, start, pellets[n].end, self, content_mask);
+		}
+		else
+			gi.trace_batch (pellets, batch, NULL, NULL, self, content_mask);
+
+		for (n = 0; n < batch; n++)
+			linkcounts[n] = pellets[n].trace.ent->linkcount;
+
+		numdamaged = 0;
+		for (n = 0; n < batch; n++)
+		{
+			tr = pellets[n].trace;
+
+			// an earlier pellet may have killed, moved or removed what this
+			// one hit, a dying monster shrinks its box and relinks
+			if (tr.ent != g_edicts)
+			{
+				for (j = 0; j < numdamaged; j++)
+					if (damaged[j] == tr.ent)
+						break;
+				if (j < numdamaged || !tr.ent->inuse || tr.ent->solid == SOLID_NOT
+					|| tr.ent->linkcount != linkcounts[n])
+					tr = fire_trace (self, start, pellets[n].end, self, content_mask);
+			}
+
+			hit = fire_lead_impact (self, start, aimdir, pellets[n].end, tr, water, damage, kick, TE_SHOTGUN, hspread, vspread, mod);
+			if (hit)
+			{
+				for (j = 0; j < numdamaged; j++)
+					if (damaged[j] == hit)
+						break;
+				if (j == numdamaged)
+					damaged[numdamaged++] = hit;
+			}
+		}
+	}
 }
 
 
@@ -671,7 +820,7 @@ void fire_rail (edict_t *self, vec3_t start, vec3_t aimdir, int damage, int kick
 	mask = MASK_SHOT|CONTENTS_SLIME|CONTENTS_LAVA;
 	while (ignore)
 	{
-		tr = gi.trace (from, NULL, NULL, end, ignore, mask);
+		tr = fire_trace (self, from, end, ignore, mask);
 
 		if (tr.contents & (CONTENTS_SLIME|CONTENTS_LAVA))
 		{
@@ -20,7 +20,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // game.h -- game dll information visible to server
 
-#define	GAME_API_VERSION	3
+#define	GAME_API_VERSION	7
+
+// version 3 game dlls are still loaded, they just can't see the
+// game_import_t functions added since (trace_batch, trace_rewind,
+// trigger_edicts, nav_route)
+#define	GAME_API_VERSION_MIN	3
 
 // edict->svflags
 
@@ -94,6 +99,13 @@ struct edict_s
 
 #endif		// GAME_INCLUDE
 
+// one ray of a trace_batch call, trace is filled in by the server
+typedef struct
+{
+	vec3_t		start, end;
+	trace_t		trace;
+} traceray_t;
+
 //===============================================================
 
 //
@@ -173,6 +185,25 @@ typedef struct
 	void	(*AddCommandString) (char *text);
 
 	void	(*DebugGraph) (float value, int color);
+
+	// version 4
+	// traces rays that share the same size, passent and contentmask with a
+	// single entity area query, results match a trace call for each ray
+	void	(*trace_batch) (traceray_t *rays, int numrays, vec3_t mins, vec3_t maxs, edict_t *passent, int contentmask);
+
+	// version 5
+	// trace with the clients where they were msec ago, for lag compensation
+	trace_t	(*trace_rewind) (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passent, int contentmask, int msec);
+
+	// version 6
+	// BoxEdicts over ent's absmin/absmax with AREA_TRIGGERS, the server reuses
+	// the result while ent's box and the linked triggers stay the same
+	int		(*trigger_edicts) (edict_t *ent, edict_t **list, int maxcount);
+
+	// version 7
+	// sets next to the first point of the walkable path from start to goal
+	// on the server's navigation graph, false if there is none
+	qboolean	(*nav_route) (vec3_t start, vec3_t goal, vec3_t next);
 } game_import_t;
 
 //
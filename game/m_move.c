@@ -38,7 +38,8 @@ qboolean M_CheckBottom (edict_t *ent)
 {
 	vec3_t	mins, maxs, start, stop;
 	trace_t	trace;
-	int		x, y;
+	traceray_t	corners[4];
+	int		x, y, i;
 	float	mid, bottom;
 	
 	VectorAdd (ent->s.origin, ent->mins, mins);
@@ -78,20 +79,27 @@ realcheck:
 	mid = bottom = trace.endpos[2];
 	
 // the corners must be within 16 of the midpoint	
-	for	(x=0 ; x<=1 ; x++)
-		for	(y=0 ; y<=1 ; y++)
+	for	(x=0, i=0 ; x<=1 ; x++)
+		for	(y=0 ; y<=1 ; y++, i++)
 		{
-			start[0] = stop[0] = x ? maxs[0] : mins[0];
-			start[1] = stop[1] = y ? maxs[1] : mins[1];
-			
-			trace = gi.trace (start, vec3_origin, vec3_origin, stop, ent, MASK_MONSTERSOLID);
-			
-			if (trace.fraction != 1.0 && trace.endpos[2] > bottom)
-				bottom = trace.endpos[2];
-			if (trace.fraction == 1.0 || mid - trace.endpos[2] > STEPSIZE)
-				return false;
+			corners[i].start[0] = corners[i].end[0] = x ? maxs[0] : mins[0];
+			corners[i].start[1] = corners[i].end[1] = y ? maxs[1] : mins[1];
+			corners[i].start[2] = start[2];
+			corners[i].end[2] = stop[2];
 		}
 
+	gi.trace_batch (corners, 4, vec3_origin, vec3_origin, ent, MASK_MONSTERSOLID);
+
+	for (i=0 ; i<4 ; i++)
+	{
+		trace = corners[i].trace;
+
+		if (trace.fraction != 1.0 && trace.endpos[2] > bottom)
+			bottom = trace.endpos[2];
+		if (trace.fraction == 1.0 || mid - trace.endpos[2] > STEPSIZE)
+			return false;
+	}
+
 	c_yes++;
 	return true;
 }
@@ -507,6 +515,47 @@ qboolean SV_CloseEnough (edict_t *ent, edict_t *goal, float dist)
 }
 
 
+#define	NAV_REPATH	1.0		// seconds before a monster asks for its route again
+
+/*
+======================
+M_NavMove
+
+Steers a walking monster along the server's navigation graph towards an
+enemy it can't see.  Returns false if the graph has nothing to offer, the
+caller then falls back to SV_NewChaseDir.
+======================
+*/
+static qboolean M_NavMove (edict_t *ent, edict_t *goal)
+{
+	vec3_t	v;
+
+	if (ent->flags & (FL_FLY|FL_SWIM))
+		return false;
+	if (visible (ent, goal))
+		return false;		// straight chasing works fine in the open
+
+	// ask again once the point is reached, the route then starts past it
+	VectorSubtract (ent->monsterinfo.nav_point, ent->s.origin, v);
+	v[2] = 0;
+	if (level.time >= ent->monsterinfo.nav_time || VectorLength (v) < 16)
+	{
+		if (!gi.nav_route (ent->s.origin, goal->s.origin, ent->monsterinfo.nav_point))
+		{
+			ent->monsterinfo.nav_time = 0;
+			return false;
+		}
+		ent->monsterinfo.nav_time = level.time + NAV_REPATH;
+
+		VectorSubtract (ent->monsterinfo.nav_point, ent->s.origin, v);
+		v[2] = 0;
+	}
+
+	ent->ideal_yaw = vectoyaw (v);
+	return true;
+}
+
+
 /*
 ======================
 M_MoveToGoal
@@ -525,6 +574,18 @@ void M_MoveToGoal (edict_t *ent, float dist)
 	if (ent->enemy &&  SV_CloseEnough (ent, ent->enemy, dist) )
 		return;
 
+// follow the navigation graph towards an enemy out of sight, ai_run has
+// pointed goalentity at the last sighting marker by then
+	if (ent->enemy && (goal == ent->enemy || (ent->monsterinfo.aiflags & AI_LOST_SIGHT))
+		&& M_NavMove (ent, ent->enemy))
+	{
+		if (SV_StepDirection (ent, ent->ideal_yaw, dist))
+			return;
+		ent->monsterinfo.nav_time = 0;
+		if (!ent->inuse)
+			return;
+	}
+
 // bump around...
 	if ( (rand()&3)==1 || !SV_StepDirection (ent, ent->ideal_yaw, dist))
 	{
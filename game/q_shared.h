@@ -274,7 +274,10 @@ SYSTEM SPECIFIC
 extern	int	curtime;		// time returned by last Sys_Milliseconds
 
 int		Sys_Milliseconds (void);
+double	Sys_DoubleTime (void);
 void	Sys_Mkdir (char *path);
+qboolean	Sys_LinkFile (char *src, char *dst);
+qboolean	Sys_ReplaceFile (char *src, char *dst);
 
 // large block stack allocation routines
 void	*Hunk_Begin (int maxsize);
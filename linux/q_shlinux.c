@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "../linux/glob.h"
 
@@ -123,11 +124,45 @@ int Sys_Milliseconds (void)
 	return curtime;
 }
 
+/*
+================
+Sys_DoubleTime
+
+Seconds since the first call, at the resolution of the monotonic clock.
+Used where milliseconds are too coarse, such as the per-frame benchmark.
+================
+*/
+double Sys_DoubleTime (void)
+{
+	struct timespec	ts;
+	static time_t	secbase;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	if (!secbase)
+		secbase = ts.tv_sec;
+
+	return (ts.tv_sec - secbase) + ts.tv_nsec * 1e-9;
+}
+
 void Sys_Mkdir (char *path)
 {
     mkdir (path, 0777);
 }
 
+// makes dst another name for the contents of src, false if the
+// filesystem can't do that
+qboolean Sys_LinkFile (char *src, char *dst)
+{
+	return link (src, dst) == 0;
+}
+
+// moves src over dst in one step
+qboolean Sys_ReplaceFile (char *src, char *dst)
+{
+	return rename (src, dst) == 0;
+}
+
 char *strlwr (char *s)
 {
 	while (*s) {
@@ -0,0 +1,70 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// rw_in_null.c -- input entry points for the headless software refresh
+// vid_so.c requires every refresh library to export these; with no window
+// there is nothing to read, so they do nothing.
+
+#include "../ref_soft/r_local.h"
+#include "../client/keys.h"
+#include "../linux/rw_linux.h"
+
+/*****************************************************************************/
+/* MOUSE                                                                     */
+/*****************************************************************************/
+
+void RW_IN_Init(in_state_t *in_state_p)
+{
+}
+
+void RW_IN_Shutdown(void)
+{
+}
+
+void RW_IN_Commands (void)
+{
+}
+
+void RW_IN_Move (usercmd_t *cmd)
+{
+}
+
+void RW_IN_Frame (void)
+{
+}
+
+void RW_IN_Activate(qboolean active)
+{
+}
+
+/*****************************************************************************/
+/* KEYBOARD                                                                  */
+/*****************************************************************************/
+
+void KBD_Init(Key_Event_fp_t fp)
+{
+}
+
+void KBD_Update(void)
+{
+}
+
+void KBD_Close(void)
+{
+}
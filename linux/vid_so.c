@@ -386,12 +386,12 @@ void VID_CheckChanges (void)
 		** refresh has changed
 		*/
 
-		// only allow Vulkan on Linux
-		if(strcmp("vk", vid_ref->string))
+		// only allow Vulkan and the headless software refresh on Linux
+		if(strcmp("vk", vid_ref->string) && strcmp("softnull", vid_ref->string))
 		{
 			Cvar_Set("vid_ref", "vk");
 			vid_ref->modified = false;
-			Com_Printf("Only Vulkan renderer is supported on Linux.\n");
+			Com_Printf("Only Vulkan and headless software (softnull) renderers are supported on Linux.\n");
 			// don't restart the renderer if it's already loaded
 			if(reflib_active)
 				break;
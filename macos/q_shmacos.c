@@ -123,11 +123,44 @@ int Sys_Milliseconds (void)
 	return curtime;
 }
 
+/*
+================
+Sys_DoubleTime
+
+Seconds since the first call, with microsecond resolution.
+================
+*/
+double Sys_DoubleTime (void)
+{
+	struct timeval	tp;
+	static int		secbase;
+
+	gettimeofday(&tp, NULL);
+
+	if (!secbase)
+		secbase = tp.tv_sec;
+
+	return (tp.tv_sec - secbase) + tp.tv_usec * 1e-6;
+}
+
 void Sys_Mkdir (char *path)
 {
     mkdir (path, 0777);
 }
 
+// makes dst another name for the contents of src, false if the
+// filesystem can't do that
+qboolean Sys_LinkFile (char *src, char *dst)
+{
+	return link (src, dst) == 0;
+}
+
+// moves src over dst in one step
+qboolean Sys_ReplaceFile (char *src, char *dst)
+{
+	return rename (src, dst) == 0;
+}
+
 char *strlwr (char *s)
 {
 	while (*s) {
@@ -8,7 +8,7 @@ of the License, or (at your option) any later version.
 
 This program is distributed in the hope that it will be useful,
 but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
 
 See the GNU General Public License for more details.
 
@@ -16,31 +16,153 @@ You should have received a copy of the GNU General Public License
 along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
+*/
+/*
+** SWIMP_NULL.C
+**
+** Headless implementation of the software refresh's video layer. The
+** frame is rendered into a plain memory buffer that is never presented,
+** so the software renderer runs without a display (timedemos on build
+** machines, image comparisons of renderer changes).
+**
+** sw_framedump N writes every Nth frame to <gamedir>/framedump as a
+** binary PPM, 0 (the default) disables it.
 */
 #include "../ref_soft/r_local.h"
 
+static byte				*swimp_buffer;
+static byte				*swimp_rowbuffer;
+static unsigned char	swimp_palette[256 * 4];
+static int				swimp_framecount;
+
+static cvar_t			*sw_framedump;
+
+/*
+** SWimp_DumpFrame
+**
+** Writes the current frame, expanded through the palette, as a PPM.
+*/
+static void SWimp_DumpFrame (void)
+{
+	char	name[MAX_OSPATH];
+	FILE	*f;
+	byte	*src, *dst;
+	int		x, y;
+
+	Com_sprintf (name, sizeof(name), "%s/framedump", ri.FS_Gamedir());
+	Sys_Mkdir (name);
+
+	Com_sprintf (name, sizeof(name), "%s/framedump/frame%06i.ppm", ri.FS_Gamedir(), swimp_framecount);
+	f = fopen (name, "wb");
+	if (!f)
+	{
+		ri.Con_Printf (PRINT_ALL, "SWimp_DumpFrame: couldn't open %s\n", name);
+		ri.Cvar_Set ("sw_framedump", "0");
+		return;
+	}
+
+	fprintf (f, "P6\n%i %i\n255\n", vid.width, vid.height);
+
+	for (y = 0; y < vid.height; y++)
+	{
+		src = vid.buffer + y * vid.rowbytes;
+		dst = swimp_rowbuffer;
+
+		for (x = 0; x < vid.width; x++, dst += 3)
+		{
+			dst[0] = swimp_palette[src[x] * 4 + 0];
+			dst[1] = swimp_palette[src[x] * 4 + 1];
+			dst[2] = swimp_palette[src[x] * 4 + 2];
+		}
+
+		fwrite (swimp_rowbuffer, 3, vid.width, f);
+	}
+
+	fclose (f);
+}
+
 void		SWimp_BeginFrame( float camera_separation )
 {
 }
 
 void		SWimp_EndFrame (void)
 {
+	swimp_framecount++;
+
+	if (sw_framedump->value > 0 && !(swimp_framecount % (int)sw_framedump->value))
+		SWimp_DumpFrame ();
 }
 
 int			SWimp_Init( void *hInstance, void *wndProc )
 {
+	sw_framedump = ri.Cvar_Get ("sw_framedump", "0", 0);
+	swimp_framecount = 0;
+
+	return true;
 }
 
+/*
+** SWimp_SetPalette
+**
+** Only remembered for frame dumps. A NULL palette means to use the
+** existing palette.
+*/
 void		SWimp_SetPalette( const unsigned char *palette)
 {
+	if (!palette)
+		palette = (const unsigned char *)sw_state.currentpalette;
+
+	memcpy (swimp_palette, palette, sizeof(swimp_palette));
 }
 
 void		SWimp_Shutdown( void )
 {
+	free (swimp_buffer);
+	free (swimp_rowbuffer);
+	swimp_buffer = NULL;
+	swimp_rowbuffer = NULL;
+
+	vid.buffer = NULL;
+	vid.rowbytes = 0;
 }
 
+/*
+** SWimp_SetMode
+**
+** Any mode the client knows about is valid, fullscreen is meaningless.
+*/
 rserr_t		SWimp_SetMode( int *pwidth, int *pheight, int mode, qboolean fullscreen )
 {
+	ri.Con_Printf (PRINT_ALL, "setting mode %d:", mode );
+
+	if ( !ri.Vid_GetModeInfo( pwidth, pheight, mode ) )
+	{
+		ri.Con_Printf( PRINT_ALL, " invalid mode\n" );
+		return rserr_invalid_mode;
+	}
+
+	ri.Con_Printf( PRINT_ALL, " %d %d (offscreen)\n", *pwidth, *pheight);
+
+	SWimp_Shutdown ();
+
+	swimp_buffer = malloc (*pwidth * *pheight);
+	swimp_rowbuffer = malloc (*pwidth * 3);
+	if (!swimp_buffer || !swimp_rowbuffer)
+	{
+		SWimp_Shutdown ();
+		return rserr_unknown;
+	}
+
+	vid.buffer = swimp_buffer;
+	vid.rowbytes = *pwidth;
+
+	ri.Vid_NewWindow (*pwidth, *pheight);
+
+	sw_state.fullscreen = false;
+
+	R_GammaCorrectAndSetPalette( ( const unsigned char * ) d_8to24table );
+
+	return rserr_ok;
 }
 
 void		SWimp_AppActivate( qboolean active )
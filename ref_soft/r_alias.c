@@ -46,6 +46,7 @@ vec3_t          r_lerp_frontv, r_lerp_backv, r_lerp_move;
 int				r_ambientlight;
 int				r_aliasblendcolor;
 float			r_shadelight;
+float			shadelight[3];
 
 
 daliasframe_t	*r_thisframe, *r_lastframe;
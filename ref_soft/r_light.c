@@ -21,6 +21,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "r_local.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LIGHTMAP_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#  define LIGHTMAP_NEON
+#  include <arm_neon.h>
+#endif
+
 int	r_dlightframecount;
 
 
@@ -443,6 +451,165 @@ void R_LightPointColor(vec3_t p, vec3_t color)
 
 unsigned		blocklights[1024 * 3];	// allow some very large lightmaps // leilei - *3 added
 
+/*
+=============================================================================
+
+LIGHTMAP KERNELS
+
+Lightstyle accumulation and the final bound pass of R_BuildLightMap and
+R_BuildLightMapRGB. The SSE2 and NEON versions give the same results as the
+C loops, which still handle the leftover luxels.
+
+=============================================================================
+*/
+
+/*
+===============
+R_LightmapAccumulate
+
+blocklights[i] += lightmap[i] * scale for count entries
+===============
+*/
+static void R_LightmapAccumulate(unsigned *bl, byte *lightmap, unsigned scale, int count)
+{
+	int i = 0;
+
+	// the vector paths multiply 16 bit lanes, which covers any sane lightstyle
+	if (scale <= 0xffff)
+	{
+#if defined(LIGHTMAP_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i s = _mm_set1_epi16((short)scale);
+
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i lm = _mm_loadu_si128((const __m128i *)(lightmap + i));
+			__m128i w0 = _mm_unpacklo_epi8(lm, zero);
+			__m128i w1 = _mm_unpackhi_epi8(lm, zero);
+			__m128i lo0 = _mm_mullo_epi16(w0, s), hi0 = _mm_mulhi_epu16(w0, s);
+			__m128i lo1 = _mm_mullo_epi16(w1, s), hi1 = _mm_mulhi_epu16(w1, s);
+			__m128i *dst = (__m128i *)(bl + i);
+
+			_mm_storeu_si128(dst + 0, _mm_add_epi32(_mm_loadu_si128(dst + 0), _mm_unpacklo_epi16(lo0, hi0)));
+			_mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), _mm_unpackhi_epi16(lo0, hi0)));
+			_mm_storeu_si128(dst + 2, _mm_add_epi32(_mm_loadu_si128(dst + 2), _mm_unpacklo_epi16(lo1, hi1)));
+			_mm_storeu_si128(dst + 3, _mm_add_epi32(_mm_loadu_si128(dst + 3), _mm_unpackhi_epi16(lo1, hi1)));
+		}
+#elif defined(LIGHTMAP_NEON)
+		for (; i + 8 <= count; i += 8)
+		{
+			uint16x8_t w = vmovl_u8(vld1_u8(lightmap + i));
+
+			vst1q_u32(bl + i, vmlal_n_u16(vld1q_u32(bl + i), vget_low_u16(w), (uint16_t)scale));
+			vst1q_u32(bl + i + 4, vmlal_n_u16(vld1q_u32(bl + i + 4), vget_high_u16(w), (uint16_t)scale));
+		}
+#endif
+	}
+
+	for (; i < count; i++)
+		bl[i] += lightmap[i] * scale;
+}
+
+/*
+===============
+R_LightmapBound
+
+bound, invert, and shift mono light into the colormap range
+===============
+*/
+static void R_LightmapBound(unsigned *bl, int count)
+{
+	int i = 0;
+	int t;
+
+#if defined(LIGHTMAP_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi32(255 * 256);
+	const __m128i minlight = _mm_set1_epi32(1 << 6);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)(bl + i));
+		__m128i m;
+
+		v = _mm_and_si128(v, _mm_cmpgt_epi32(v, zero));
+		v = _mm_srai_epi32(_mm_sub_epi32(full, v), 8 - VID_CBITS);
+		m = _mm_cmplt_epi32(v, minlight);
+		v = _mm_or_si128(_mm_and_si128(m, minlight), _mm_andnot_si128(m, v));
+		_mm_storeu_si128((__m128i *)(bl + i), v);
+	}
+#elif defined(LIGHTMAP_NEON)
+	const int32x4_t zero = vdupq_n_s32(0);
+	const int32x4_t full = vdupq_n_s32(255 * 256);
+	const int32x4_t minlight = vdupq_n_s32(1 << 6);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		int32x4_t v = vreinterpretq_s32_u32(vld1q_u32(bl + i));
+
+		v = vshrq_n_s32(vsubq_s32(full, vmaxq_s32(v, zero)), 8 - VID_CBITS);
+		vst1q_u32(bl + i, vreinterpretq_u32_s32(vmaxq_s32(v, minlight)));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		t = (int)bl[i];
+		if (t < 0)
+			t = 0;
+		t = (255 * 256 - t) >> (8 - VID_CBITS);
+
+		if (t < (1 << 6))
+			t = (1 << 6);
+
+		bl[i] = t;
+	}
+}
+
+/*
+===============
+R_LightmapBoundRGB
+
+clamp colored light to the 256..65536 range the RGB surface blocks expect
+===============
+*/
+static void R_LightmapBoundRGB(unsigned *bl, int count)
+{
+	int i = 0;
+	unsigned r;
+
+#if defined(LIGHTMAP_SSE2)
+	// SSE2 only compares signed lanes, so flip the sign bit to compare unsigned
+	const __m128i bias = _mm_set1_epi32(0x80000000);
+	const __m128i lo = _mm_set1_epi32(256 ^ 0x80000000);
+	const __m128i hi = _mm_set1_epi32(65536 ^ 0x80000000);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(bl + i)), bias);
+		__m128i m;
+
+		m = _mm_cmplt_epi32(v, lo);
+		v = _mm_or_si128(_mm_and_si128(m, lo), _mm_andnot_si128(m, v));
+		m = _mm_cmpgt_epi32(v, hi);
+		v = _mm_or_si128(_mm_and_si128(m, hi), _mm_andnot_si128(m, v));
+		_mm_storeu_si128((__m128i *)(bl + i), _mm_xor_si128(v, bias));
+	}
+#elif defined(LIGHTMAP_NEON)
+	const uint32x4_t lo = vdupq_n_u32(256);
+	const uint32x4_t hi = vdupq_n_u32(65536);
+
+	for (; i + 4 <= count; i += 4)
+		vst1q_u32(bl + i, vminq_u32(vmaxq_u32(vld1q_u32(bl + i), lo), hi));
+#endif
+
+	for (; i < count; i++)
+	{
+		r = bl[i];
+		bl[i] = (r < 256) ? 256 : (r > 65536) ? 65536 : r;	// leilei - made min 256 to rid visual artifacts and gain speed
+	}
+}
+
 /*
 ===============
 R_AddDynamicLights
@@ -551,7 +718,6 @@ Combine and scale multiple lightmaps into the 8.8 format in blocklights
 void R_BuildLightMap(void)
 {
 	int			smax, tmax;
-	int			t;
 	int			i, size;
 	byte		*lightmap;
 	unsigned	scale;
@@ -583,8 +749,7 @@ void R_BuildLightMap(void)
 		maps++)
 	{
 		scale = r_drawsurf.lightadj[maps];	// 8.8 fraction		
-		for (i = 0; i < size; i++)
-			blocklights[i] += lightmap[i] * scale;
+		R_LightmapAccumulate(blocklights, lightmap, scale, size);
 		lightmap += size;	// skip to next lightmap
 	}
 
@@ -593,18 +758,7 @@ void R_BuildLightMap(void)
 		R_AddDynamicLights();
 
 	// bound, invert, and shift
-	for (i = 0; i < size; i++)
-	{
-		t = (int)blocklights[i];
-		if (t < 0)
-			t = 0;
-		t = (255 * 256 - t) >> (8 - VID_CBITS);
-
-		if (t < (1 << 6))
-			t = (1 << 6);
-
-		blocklights[i] = t;
-	}
+	R_LightmapBound(blocklights, size);
 }
 
 
@@ -737,7 +891,6 @@ void R_BuildLightMapRGB(void)
 	int			scale;
 	int			maps;
 	msurface_t	*surf;
-	int r;
 	surf = r_drawsurf.surf;
 
 	smax = (surf->extents[0] >> 4) + 1;
@@ -767,12 +920,7 @@ void R_BuildLightMapRGB(void)
 		maps++)
 	{
 		scale = r_drawsurf.lightadj[maps];	// 8.8 fraction		
-		for (i = 0; i < size; i += 3)
-		{
-			blocklights[i] += lightmap[i] * scale;
-			blocklights[i + 1] += lightmap[i + 1] * scale;
-			blocklights[i + 2] += lightmap[i + 2] * scale;
-		}
+		R_LightmapAccumulate(blocklights, lightmap, scale, size);
 		lightmap += size;	// skip to next lightmap
 	}
 
@@ -784,11 +932,7 @@ void R_BuildLightMapRGB(void)
 
 	// how quake2 should have really looked 
 	//qb: always do 'overbrights' on colored lights.
-	for (i = 0; i < size; i++)
-	{
-		r = blocklights[i];
-		blocklights[i] = (r < 256) ? 256 : (r > 65536) ? 65536 : r;	// leilei - made min 256 to rid visual artifacts and gain speed
-	}
+	R_LightmapBoundRGB(blocklights, size);
 }
 
 // o^_^o
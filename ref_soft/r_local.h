@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
   
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <math.h>
 #include <stdarg.h>
@@ -216,6 +217,7 @@ extern oldrefdef_t      r_refdef;
 #define ALIAS_XY_CLIP_MASK                      0x000F
 
 #define SURFCACHE_SIZE_AT_320X240    1024*768
+#define SURFCACHE_SIZE_MAX           (64*1024*1024)	// upper bound for automatic growth on thrash
 
 #define BMODEL_FULLY_CLIPPED    0x10 // value returned by R_BmodelCheckBBox ()
 									 //  if bbox is trivially rejected
@@ -397,6 +399,7 @@ typedef struct surfcache_s
 	unsigned                        height;         // DEBUG only needed for debug
 	float                           mipscale;
 	image_t							*image;
+	int                             lastframe;      // r_framecount of last use, for LRU eviction
 	byte                            data[4];        // width*height elements
 } surfcache_t;
 
@@ -510,9 +513,7 @@ extern int		r_warpheight;
 
 extern float    scale_for_mip;
 
-extern qboolean         d_roverwrapped;
-extern surfcache_t      *sc_rover;
-extern surfcache_t      *d_initial_rover;
+extern qboolean         r_cache_thrash;
 
 extern float    d_sdivzstepu, d_tdivzstepu, d_zistepu;
 extern float    d_sdivzstepv, d_tdivzstepv, d_zistepv;
@@ -597,6 +598,7 @@ extern cvar_t   *sw_reportsurfout;
 extern cvar_t   *sw_reportedgeout;
 extern cvar_t   *sw_stipplealpha;
 extern cvar_t   *sw_surfcacheoverride;
+extern cvar_t   *sw_surfcachestats;
 extern cvar_t   *sw_waterwarp;
 extern cvar_t   *sw_transmooth; // texture dither on transparencies
 
@@ -642,7 +644,7 @@ extern  vec3_t  modelorg;
 extern  vec3_t  r_entorigin;
 
 
-float	shadelight[3];  //qb: put it here
+extern float	shadelight[3];  //qb: put it here
 
 extern  float   verticalFieldOfView;
 extern  float   xOrigin, yOrigin;
@@ -811,6 +813,7 @@ void R_SplitEntityOnNode2 (mnode_t *node);
 extern  refdef_t        r_newrefdef;
 
 extern  surfcache_t     *sc_rover, *sc_base;
+extern  int             sc_size;
 
 extern  void            *colormap;
 
@@ -825,7 +828,10 @@ void Draw_InitLocal (void);
 qboolean R_Init( void *hInstance, void *wndProc );
 void R_Shutdown (void);
 void R_InitCaches (void);
+void R_FreeCaches (void);
 void D_FlushCaches (void);
+void D_SetupCaches (void);
+void D_PrintCacheStats (void);
 
 void	R_ScreenShot_f( void );
 void    R_BeginRegistration (char *map);
@@ -127,6 +127,7 @@ cvar_t	*sw_reportedgeout;
 cvar_t	*sw_reportsurfout;
 cvar_t  *sw_stipplealpha;
 cvar_t	*sw_surfcacheoverride;
+cvar_t	*sw_surfcachestats;
 cvar_t	*sw_waterwarp;
 cvar_t  *sw_transmooth; // texture dither //qb: was sw_texturesmooth, but just transparencies
 //cvar_t  *sw_transquality; //qb: from engoo - selects which table to use.
@@ -272,6 +273,7 @@ void R_Register(void)
 	sw_reportsurfout = ri.Cvar_Get("sw_reportsurfout", "0", 0);
 	sw_stipplealpha = ri.Cvar_Get("sw_stipplealpha", "0", CVAR_ARCHIVE);
 	sw_surfcacheoverride = ri.Cvar_Get("sw_surfcacheoverride", "0", 0);
+	sw_surfcachestats = ri.Cvar_Get("sw_surfcachestats", "0", 0);
 	sw_waterwarp = ri.Cvar_Get("sw_waterwarp", "1", 0);
 	sw_mode = ri.Cvar_Get("sw_mode", "4", CVAR_ARCHIVE);
 	sw_transmooth = ri.Cvar_Get("sw_transmooth", "0", CVAR_ARCHIVE);
@@ -381,12 +383,7 @@ void R_Shutdown(void)
 		d_pzbuffer = NULL;
 	}
 	// free surface cache
-	if (sc_base)
-	{
-		D_FlushCaches();
-		free(sc_base);
-		sc_base = NULL;
-	}
+	R_FreeCaches();
 
 	if (r_warpbuffer)
 	{
@@ -1089,6 +1086,9 @@ void R_RenderFrame(refdef_t *fd)
 	if (sw_aliasstats->value)
 		R_PrintAliasStats();
 
+	if (sw_surfcachestats->value)
+		D_PrintCacheStats();
+
 	if (r_speeds->value)
 		R_PrintTimes();
 
@@ -1118,12 +1118,7 @@ void R_InitGraphics(int width, int height)
 	}
 
 	// free surface cache
-	if (sc_base)
-	{
-		D_FlushCaches();
-		free(sc_base);
-		sc_base = NULL;
-	}
+	R_FreeCaches();
 
 	r_warpwidth = vid.width;
 	r_warpheight = vid.height;
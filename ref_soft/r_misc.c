@@ -26,8 +26,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 cvar_t	*sw_mipcap;
 cvar_t	*sw_mipscale;
 
-surfcache_t		*d_initial_rover;
-qboolean		d_roverwrapped;
 int				d_minmip;
 float			d_scalemip[NUM_MIPS-1];
 
@@ -506,8 +504,7 @@ void R_SetupFrame (void)
 	r_outofedges = 0;
 
 // d_setup
-	d_roverwrapped = false;
-	d_initial_rover = sc_rover;
+	D_SetupCaches ();
 
 	d_minmip = sw_mipcap->value;
 	if (d_minmip > 3)
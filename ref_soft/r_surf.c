@@ -112,6 +112,9 @@ qboolean        r_cache_thrash;         // set if surface cache is thrashing
 int         sc_size;
 surfcache_t	*sc_rover, *sc_base;
 
+// per-frame statistics
+static int	sc_hits, sc_misses, sc_evictions;
+
 /*
 ===============
 R_TextureAnimation
@@ -433,6 +436,22 @@ void R_DrawSurfaceBlock8_mip3 (void)
 //============================================================================
 
 
+/*
+================
+D_AllocCaches
+================
+*/
+static void D_AllocCaches (int size)
+{
+	sc_size = size;
+	sc_base = (surfcache_t *)malloc(size);
+	sc_rover = sc_base;
+	
+	sc_base->next = NULL;
+	sc_base->owner = NULL;
+	sc_base->size = sc_size;
+}
+
 /*
 ================
 R_InitCaches
@@ -463,13 +482,24 @@ void R_InitCaches (void)
 
 	ri.Con_Printf (PRINT_ALL,"%ik surface cache\n", size/1024);
 
-	sc_size = size;
-	sc_base = (surfcache_t *)malloc(size);
-	sc_rover = sc_base;
-	
-	sc_base->next = NULL;
-	sc_base->owner = NULL;
-	sc_base->size = sc_size;
+	D_AllocCaches (size);
+}
+
+/*
+================
+R_FreeCaches
+
+================
+*/
+void R_FreeCaches (void)
+{
+	if (!sc_base)
+		return;
+
+	D_FlushCaches();
+	free(sc_base);
+	sc_base = NULL;
+	sc_rover = NULL;
 }
 
 
@@ -497,15 +527,72 @@ void D_FlushCaches (void)
 	sc_base->size = sc_size;
 }
 
+/*
+==================
+D_SetupCaches
+
+Called at the start of every frame. A cache that thrashed during the previous
+frame is doubled (unless the size was forced with sw_surfcacheoverride), so
+high resolutions settle on a size that holds a whole view.
+==================
+*/
+void D_SetupCaches (void)
+{
+	if (r_cache_thrash && !sw_surfcacheoverride->value && sc_size < SURFCACHE_SIZE_MAX)
+	{
+		int size = sc_size * 2;
+
+		if (size > SURFCACHE_SIZE_MAX)
+			size = SURFCACHE_SIZE_MAX;
+
+		R_FreeCaches ();
+		ri.Con_Printf (PRINT_DEVELOPER, "surface cache thrashing, growing to %ik\n", size/1024);
+		D_AllocCaches (size);
+	}
+
+	r_cache_thrash = false;
+
+	sc_hits = 0;
+	sc_misses = 0;
+	sc_evictions = 0;
+}
+
+/*
+=================
+D_SCEvict
+
+Releases a block so it can be merged into a new allocation. Blocks used in
+the current frame are kept unless the cache is already thrashing.
+=================
+*/
+static qboolean D_SCEvict (surfcache_t *c)
+{
+	if (!c->owner)
+		return true;
+
+	if (c->lastframe == r_framecount && !r_cache_thrash)
+		return false;
+
+	*c->owner = NULL;
+	c->owner = NULL;
+	sc_evictions++;
+	return true;
+}
+
 /*
 =================
 D_SCAlloc
+
+Walks the ring from the rover, merging free and stale blocks until there
+is room. Blocks still in use this frame are skipped over, so the least
+recently used surfaces are the ones that get evicted.
 =================
 */
 surfcache_t     *D_SCAlloc (int width, int size)
 {
 	surfcache_t             *new;
-	qboolean                wrapped_this_time;
+	surfcache_t             *next;
+	int                     scanned;
 
 	if ((width < 0) || (width > 256))
 		ri.Sys_Error (ERR_FATAL,"D_SCAlloc: bad cache width %d\n", width);
@@ -518,34 +605,51 @@ surfcache_t     *D_SCAlloc (int width, int size)
 	if (size > sc_size)
 		ri.Sys_Error (ERR_FATAL,"D_SCAlloc: %i > cache size of %i",size, sc_size);
 
-// if there is not size bytes after the rover, reset to the start
-	wrapped_this_time = false;
+	scanned = 0;
 
-	if ( !sc_rover || (byte *)sc_rover - (byte *)sc_base > sc_size - size)
+	for (;;)
 	{
-		if (sc_rover)
+	// if there is not size bytes after the rover, reset to the start
+		if ( !sc_rover || (byte *)sc_rover - (byte *)sc_base > sc_size - size)
+			sc_rover = sc_base;
+
+	// colect and free surfcache_t blocks until the rover block is large enough
+		new = sc_rover;
+		next = NULL;
+
+		if (D_SCEvict (new))
 		{
-			wrapped_this_time = true;
+			while (new->size < size)
+			{
+			// free another
+				next = new->next;
+				if (!next)
+					ri.Sys_Error (ERR_FATAL,"D_SCAlloc: hit the end of memory");
+				if (!D_SCEvict (next))
+					break;
+
+				new->size += next->size;
+				new->next = next->next;
+			}
+
+			if (new->size >= size)
+				break;
+
+			scanned += new->size;
 		}
-		sc_rover = sc_base;
-	}
-		
-// colect and free surfcache_t blocks until the rover block is large enough
-	new = sc_rover;
-	if (sc_rover->owner)
-		*sc_rover->owner = NULL;
-	
-	while (new->size < size)
-	{
-	// free another
-		sc_rover = sc_rover->next;
-		if (!sc_rover)
-			ri.Sys_Error (ERR_FATAL,"D_SCAlloc: hit the end of memory");
-		if (sc_rover->owner)
-			*sc_rover->owner = NULL;
-			
-		new->size += sc_rover->size;
-		new->next = sc_rover->next;
+		else
+		{
+			next = new;
+		}
+
+	// a block in use this frame is in the way, continue right after it
+		scanned += next->size;
+		sc_rover = next->next;
+
+	// went all the way around without finding room, so this frame's
+	// working set does not fit and recently used blocks have to go
+		if (scanned >= sc_size)
+			r_cache_thrash = true;
 	}
 
 // create a fragment out of any leftovers
@@ -568,16 +672,7 @@ surfcache_t     *D_SCAlloc (int width, int size)
 		new->height = (size - sizeof(*new) + sizeof(new->data)) / width;
 
 	new->owner = NULL;              // should be set properly after return
-
-	if (d_roverwrapped)
-	{
-		if (wrapped_this_time || (sc_rover >= d_initial_rover))
-			r_cache_thrash = true;
-	}
-	else if (wrapped_this_time)
-	{       
-		d_roverwrapped = true;
-	}
+	new->lastframe = r_framecount;
 
 	return new;
 }
@@ -600,6 +695,17 @@ void D_SCDump (void)
 	}
 }
 
+/*
+=================
+D_PrintCacheStats
+=================
+*/
+void D_PrintCacheStats (void)
+{
+	ri.Con_Printf (PRINT_ALL,"%ik surfcache: %4i hits %4i misses %4i evictions%s\n",
+				sc_size/1024, sc_hits, sc_misses, sc_evictions, r_cache_thrash ? " (thrashing)" : "");
+}
+
 //=============================================================================
 
 // if the num is not a power of 2, assume it will not repeat
@@ -659,7 +765,13 @@ surfcache_t *D_CacheSurface (msurface_t *surface, int miplevel)
 			&& cache->lightadj[1] == r_drawsurf.lightadj[1]
 			&& cache->lightadj[2] == r_drawsurf.lightadj[2]
 			&& cache->lightadj[3] == r_drawsurf.lightadj[3] )
+	{
+		cache->lastframe = r_framecount;
+		sc_hits++;
 		return cache;
+	}
+
+	sc_misses++;
 
 //
 // determine shape of surface
@@ -681,6 +793,10 @@ surfcache_t *D_CacheSurface (msurface_t *surface, int miplevel)
 		cache->owner = &surface->cachespots[miplevel];
 		cache->mipscale = surfscale;
 	}
+	else
+	{
+		cache->lastframe = r_framecount;
+	}
 	
 	if (surface->dlightframe == r_framecount)
 		cache->dlight = 1;
@@ -139,6 +139,13 @@ typedef struct
 	qboolean submitted;
 } qvkstagingbuffer_t;
 
+// tightly packed 32bit texture data for a rectangle of a texture
+typedef struct
+{
+	const unsigned char *data;
+	VkRect2D rect;
+} qvktextureregion_t;
+
 // Vulkan buffer options
 typedef struct
 {
@@ -202,6 +209,18 @@ typedef enum
 #define NUM_CMDBUFFERS 2
 #define NUM_DYNBUFFERS 2
 
+// per-frame profiler results (vk_profile, vk_profilecsv)
+typedef struct
+{
+	unsigned frame;				// increments every time a frame's results are collected
+	float    gpuTime[RP_COUNT];	// ms between the timestamps around each render pass, negative if not available
+	float    cpuTime[RP_COUNT];	// ms spent recording each render pass
+	uint32_t drawCalls;
+	uint32_t pipelineBinds;
+	uint32_t descriptorBinds;
+	uint32_t stagingBytes;
+} qvkprofile_t;
+
 // check if the system supports either VK_EXT_DEBUG_UTILS or VK_EXT_DEBUG_REPORT
 #ifdef VK_EXT_DEBUG_UTILS_EXTENSION_NAME
 #define DEBUG_UTILS_AVAILABLE 1
@@ -222,6 +241,9 @@ extern VmaAllocator vk_malloc;
 extern qvkswapchain_t vk_swapchain;
 // Vulkan command buffer currently in use
 extern VkCommandBuffer vk_activeCmdbuffer;
+// profiler counters of the frame being recorded and results of the last completed one
+extern qvkprofile_t *vk_recordStats;
+extern qvkprofile_t vk_profileStats;
 // Vulkan command pools
 extern VkCommandPool vk_commandPool[NUM_CMDBUFFERS];
 extern VkCommandPool vk_transferCommandPool;
@@ -231,15 +253,15 @@ extern VkDescriptorPool vk_descriptorPool;
 // Vulkan descriptor sets
 extern VkDescriptorSetLayout vk_uboDescSetLayout;
 extern VkDescriptorSetLayout vk_samplerDescSetLayout;
+extern VkDescriptorSetLayout vk_storageDescSetLayout;
+// normals and shadedots tables read by the alias model vertex shader
+extern VkDescriptorSet vk_aliasTablesDescSet;
 
 // *** pipelines ***
 extern qvkpipeline_t vk_drawTexQuadPipeline;
 extern qvkpipeline_t vk_drawColorQuadPipeline[2];
-extern qvkpipeline_t vk_drawModelPipelineStrip[2];
 extern qvkpipeline_t vk_drawModelPipelineFan[2];
-extern qvkpipeline_t vk_drawNoDepthModelPipelineStrip;
 extern qvkpipeline_t vk_drawNoDepthModelPipelineFan;
-extern qvkpipeline_t vk_drawLefthandModelPipelineStrip;
 extern qvkpipeline_t vk_drawLefthandModelPipelineFan;
 extern qvkpipeline_t vk_drawNullModelPipeline;
 extern qvkpipeline_t vk_drawParticlesPipeline;
@@ -298,6 +320,10 @@ void		QVk_CreateTexture(qvktexture_t *texture, const unsigned char *data, uint32
 void		QVk_UpdateTextureData(qvktexture_t *texture, const unsigned char *data, uint32_t offset_x, uint32_t offset_y, uint32_t width, uint32_t height);
 VkSampler	QVk_UpdateTextureSampler(qvktexture_t *texture, qvksampler_t samplerType);
 void		QVk_ReleaseTexture(qvktexture_t *texture);
+void		QVk_DestroyTexture(qvktexture_t *texture);
+void		QVk_UpdateTextureRegions(qvktexture_t *texture, const qvktextureregion_t *regions, uint32_t numRegions);
+void		QVk_DeferBufferRelease(const qvkbuffer_t *buffer);
+void		QVk_DeferTextureRelease(const qvktexture_t *texture);
 void		QVk_ReadPixels(uint8_t *dstBuffer, uint32_t width, uint32_t height);
 VkResult	QVk_BeginCommand(const VkCommandBuffer *commandBuffer);
 void		QVk_SubmitCommand(const VkCommandBuffer *commandBuffer, const VkQueue *queue);
@@ -306,6 +332,7 @@ const char*	QVk_GetError(VkResult errorCode);
 VkResult	QVk_BeginFrame(void);
 VkResult	QVk_EndFrame(qboolean force);
 void		QVk_BeginRenderpass(qvkrenderpasstype_t rpType);
+void		QVk_EndRenderpass(void);
 void		QVk_RecreateSwapchain(void);
 VkResult	QVk_CreateBuffer(VkDeviceSize size, qvkbuffer_t *dstBuffer, const qvkbufferopts_t options);
 void		QVk_FreeBuffer(qvkbuffer_t *buffer);
@@ -313,12 +340,17 @@ VkResult	QVk_CreateStagingBuffer(VkDeviceSize size, qvkbuffer_t *dstBuffer, VkMe
 VkResult	QVk_CreateUniformBuffer(VkDeviceSize size, qvkbuffer_t *dstBuffer, VkMemoryPropertyFlags reqMemFlags, VkMemoryPropertyFlags prefMemFlags);
 void		QVk_CreateVertexBuffer(const void *data, VkDeviceSize size, qvkbuffer_t *dstBuffer, qvkbuffer_t *stagingBuffer, VkMemoryPropertyFlags reqMemFlags, VkMemoryPropertyFlags prefMemFlags);
 void		QVk_CreateIndexBuffer(const void *data, VkDeviceSize size, qvkbuffer_t *dstBuffer, qvkbuffer_t *stagingBuffer, VkMemoryPropertyFlags reqMemFlags, VkMemoryPropertyFlags prefMemFlags);
+void		QVk_CreateStorageBuffer(const void *data, VkDeviceSize size, qvkbuffer_t *dstBuffer, qvkbuffer_t *stagingBuffer, VkMemoryPropertyFlags reqMemFlags, VkMemoryPropertyFlags prefMemFlags);
 qvkshader_t QVk_CreateShader(const uint32_t *shaderSrc, size_t shaderCodeSize, VkShaderStageFlagBits shaderStage);
 void		QVk_CreatePipeline(const VkDescriptorSetLayout *descriptorLayout, const uint32_t desLayoutCount, const VkPipelineVertexInputStateCreateInfo *vertexInputInfo, qvkpipeline_t *pipeline, const qvkrenderpass_t *renderpass, const qvkshader_t *shaders, uint32_t shaderCount, VkPushConstantRange *pcRange);
 void		QVk_DestroyPipeline(qvkpipeline_t *pipeline);
+void		QVk_CreatePipelineCache(void);
+void		QVk_DestroyPipelineCache(void);
 uint8_t*	QVk_GetVertexBuffer(VkDeviceSize size, VkBuffer *dstBuffer, VkDeviceSize *dstOffset);
-uint8_t*	QVk_GetIndexBuffer(VkDeviceSize size, VkDeviceSize *dstOffset);
+uint8_t*	QVk_GetIndexBuffer(VkDeviceSize size, VkBuffer *dstBuffer, VkDeviceSize *dstOffset);
 uint8_t*	QVk_GetUniformBuffer(VkDeviceSize size, uint32_t *dstOffset, VkDescriptorSet *dstUboDescriptorSet);
+void		QVk_UpdateLightStyles(const float scales[][3], int count);
+VkDescriptorSet QVk_GetLightStyleDescriptorSet(void);
 uint8_t*	QVk_GetStagingBuffer(VkDeviceSize size, int alignment, VkCommandBuffer *cmdBuffer, VkBuffer *buffer, uint32_t *dstOffset);
 VkBuffer	QVk_GetTriangleFanIbo(VkDeviceSize indexCount);
 void		QVk_DrawColorRect(float *ubo, VkDeviceSize uboSize, qvkrenderpasstype_t rpType);
@@ -339,4 +371,10 @@ void		QVk_DebugLabelInsert(const VkCommandBuffer *cmdBuffer, const char *labelNa
 #define		QVk_DebugLabelEnd(a)
 #define		QVk_DebugLabelInsert(a, b, c, d, e)
 #endif
+
+// count draws and descriptor set binds for the profiler - a function-like macro is not
+// expanded again inside its own replacement, so these still call the Vulkan entry points
+#define vkCmdDraw(...)					(vk_recordStats->drawCalls++, vkCmdDraw(__VA_ARGS__))
+#define vkCmdDrawIndexed(...)			(vk_recordStats->drawCalls++, vkCmdDrawIndexed(__VA_ARGS__))
+#define vkCmdBindDescriptorSets(...)	(vk_recordStats->descriptorBinds++, vkCmdBindDescriptorSets(__VA_ARGS__))
 #endif
@@ -1,47 +1,100 @@
 	// 1011.1.0
 	 #pragma once
 const uint32_t particle_vert_spv[] = {
-	0x07230203,0x00010000,0x0008000a,0x0000002d,0x00000000,0x00020011,0x00000001,0x0006000b,
+	0x07230203,0x00010000,0x0008000a,0x00000074,0x00000000,0x00020011,0x00000001,0x0006000b,
 	0x00000001,0x4c534c47,0x6474732e,0x3035342e,0x00000000,0x0003000e,0x00000000,0x00000001,
-	0x000c000f,0x00000000,0x00000004,0x6e69616d,0x00000000,0x0000000a,0x00000016,0x00000022,
-	0x00000024,0x00000026,0x00000028,0x0000002b,0x00030003,0x00000002,0x000001c2,0x00090004,
+	0x000c000f,0x00000000,0x0000003d,0x6e69616d,0x00000000,0x0000000e,0x00000010,0x00000021,
+	0x00000025,0x00000012,0x00000026,0x00000027,0x00030003,0x00000002,0x000001c2,0x00090004,
 	0x415f4c47,0x735f4252,0x72617065,0x5f657461,0x64616873,0x6f5f7265,0x63656a62,0x00007374,
-	0x00040005,0x00000004,0x6e69616d,0x00000000,0x00060005,0x00000008,0x505f6c67,0x65567265,
-	0x78657472,0x00000000,0x00060006,0x00000008,0x00000000,0x505f6c67,0x7469736f,0x006e6f69,
-	0x00030005,0x0000000a,0x00000000,0x00060005,0x0000000e,0x68737550,0x736e6f43,0x746e6174,
-	0x00000000,0x00060006,0x0000000e,0x00000000,0x4d70766d,0x69727461,0x00000078,0x00030005,
-	0x00000010,0x00006370,0x00050005,0x00000016,0x65566e69,0x78657472,0x00000000,0x00050005,
-	0x00000022,0x43786574,0x64726f6f,0x00000000,0x00050005,0x00000024,0x65546e69,0x6f6f4378,
-	0x00006472,0x00040005,0x00000026,0x6f6c6f63,0x00000072,0x00040005,0x00000028,0x6f436e69,
-	0x00726f6c,0x00050005,0x0000002b,0x65725461,0x6c6f6873,0x00000064,0x00050048,0x00000008,
-	0x00000000,0x0000000b,0x00000000,0x00030047,0x00000008,0x00000002,0x00040048,0x0000000e,
-	0x00000000,0x00000005,0x00050048,0x0000000e,0x00000000,0x00000023,0x00000000,0x00050048,
-	0x0000000e,0x00000000,0x00000007,0x00000010,0x00030047,0x0000000e,0x00000002,0x00040047,
-	0x00000016,0x0000001e,0x00000000,0x00040047,0x00000022,0x0000001e,0x00000000,0x00040047,
-	0x00000024,0x0000001e,0x00000002,0x00040047,0x00000026,0x0000001e,0x00000001,0x00040047,
-	0x00000028,0x0000001e,0x00000001,0x00040047,0x0000002b,0x0000001e,0x00000002,0x00020013,
-	0x00000002,0x00030021,0x00000003,0x00000002,0x00030016,0x00000006,0x00000020,0x00040017,
-	0x00000007,0x00000006,0x00000004,0x0003001e,0x00000008,0x00000007,0x00040020,0x00000009,
-	0x00000003,0x00000008,0x0004003b,0x00000009,0x0000000a,0x00000003,0x00040015,0x0000000b,
-	0x00000020,0x00000001,0x0004002b,0x0000000b,0x0000000c,0x00000000,0x00040018,0x0000000d,
-	0x00000007,0x00000004,0x0003001e,0x0000000e,0x0000000d,0x00040020,0x0000000f,0x00000009,
-	0x0000000e,0x0004003b,0x0000000f,0x00000010,0x00000009,0x00040020,0x00000011,0x00000009,
-	0x0000000d,0x00040017,0x00000014,0x00000006,0x00000003,0x00040020,0x00000015,0x00000001,
-	0x00000014,0x0004003b,0x00000015,0x00000016,0x00000001,0x0004002b,0x00000006,0x00000018,
-	0x3f800000,0x00040020,0x0000001e,0x00000003,0x00000007,0x00040017,0x00000020,0x00000006,
-	0x00000002,0x00040020,0x00000021,0x00000003,0x00000020,0x0004003b,0x00000021,0x00000022,
-	0x00000003,0x00040020,0x00000023,0x00000001,0x00000020,0x0004003b,0x00000023,0x00000024,
-	0x00000001,0x0004003b,0x0000001e,0x00000026,0x00000003,0x00040020,0x00000027,0x00000001,
-	0x00000007,0x0004003b,0x00000027,0x00000028,0x00000001,0x00040020,0x0000002a,0x00000003,
-	0x00000006,0x0004003b,0x0000002a,0x0000002b,0x00000003,0x0004002b,0x00000006,0x0000002c,
-	0x00000000,0x00050036,0x00000002,0x00000004,0x00000000,0x00000003,0x000200f8,0x00000005,
-	0x00050041,0x00000011,0x00000012,0x00000010,0x0000000c,0x0004003d,0x0000000d,0x00000013,
-	0x00000012,0x0004003d,0x00000014,0x00000017,0x00000016,0x00050051,0x00000006,0x00000019,
-	0x00000017,0x00000000,0x00050051,0x00000006,0x0000001a,0x00000017,0x00000001,0x00050051,
-	0x00000006,0x0000001b,0x00000017,0x00000002,0x00070050,0x00000007,0x0000001c,0x00000019,
-	0x0000001a,0x0000001b,0x00000018,0x00050091,0x00000007,0x0000001d,0x00000013,0x0000001c,
-	0x00050041,0x0000001e,0x0000001f,0x0000000a,0x0000000c,0x0003003e,0x0000001f,0x0000001d,
-	0x0004003d,0x00000020,0x00000025,0x00000024,0x0003003e,0x00000022,0x00000025,0x0004003d,
-	0x00000007,0x00000029,0x00000028,0x0003003e,0x00000026,0x00000029,0x0003003e,0x0000002b,
-	0x0000002c,0x000100fd,0x00010038
+	0x00040005,0x0000003d,0x6e69616d,0x00000000,0x00060005,0x0000000e,0x565f6c67,0x65747265,
+	0x646e4978,0x00007865,0x00050005,0x00000010,0x724f6e69,0x6e696769,0x00000000,0x00060005,
+	0x00000014,0x68737550,0x736e6f43,0x746e6174,0x00000000,0x00060006,0x00000014,0x00000000,
+	0x4d70766d,0x69727461,0x00000078,0x00040006,0x00000014,0x00000001,0x00007075,0x00050006,
+	0x00000014,0x00000002,0x68676972,0x00000074,0x00060006,0x00000014,0x00000003,0x77656976,
+	0x6769724f,0x00006e69,0x00060006,0x00000014,0x00000004,0x77656976,0x77726f46,0x00647261,
+	0x00030005,0x00000016,0x00006370,0x00060005,0x0000001f,0x505f6c67,0x65567265,0x78657472,
+	0x00000000,0x00060006,0x0000001f,0x00000000,0x505f6c67,0x7469736f,0x006e6f69,0x00030005,
+	0x00000021,0x00000000,0x00050005,0x00000025,0x43786574,0x64726f6f,0x00000000,0x00070005,
+	0x0000001b,0x66696e55,0x426d726f,0x65666675,0x6a624f72,0x00746365,0x00050006,0x0000001b,
+	0x00000000,0x656c6170,0x00657474,0x00030005,0x0000001d,0x006f6275,0x00040005,0x00000012,
+	0x6f436e69,0x00726f6c,0x00040005,0x00000026,0x6f6c6f63,0x00000072,0x00050005,0x00000027,
+	0x65725461,0x6c6f6873,0x00000064,0x00040047,0x0000000e,0x0000000b,0x0000002a,0x00040047,
+	0x00000010,0x0000001e,0x00000000,0x00040048,0x00000014,0x00000000,0x00000005,0x00050048,
+	0x00000014,0x00000000,0x00000023,0x00000000,0x00050048,0x00000014,0x00000000,0x00000007,
+	0x00000010,0x00050048,0x00000014,0x00000001,0x00000023,0x00000040,0x00050048,0x00000014,
+	0x00000002,0x00000023,0x00000050,0x00050048,0x00000014,0x00000003,0x00000023,0x00000060,
+	0x00050048,0x00000014,0x00000004,0x00000023,0x00000070,0x00030047,0x00000014,0x00000002,
+	0x00050048,0x0000001f,0x00000000,0x0000000b,0x00000000,0x00030047,0x0000001f,0x00000002,
+	0x00040047,0x00000025,0x0000001e,0x00000000,0x00040047,0x0000001a,0x00000006,0x00000010,
+	0x00050048,0x0000001b,0x00000000,0x00000023,0x00000000,0x00030047,0x0000001b,0x00000002,
+	0x00040047,0x0000001d,0x00000022,0x00000001,0x00040047,0x0000001d,0x00000021,0x00000000,
+	0x00040047,0x00000012,0x0000001e,0x00000001,0x00040047,0x00000026,0x0000001e,0x00000001,
+	0x00040047,0x00000027,0x0000001e,0x00000002,0x00020013,0x00000002,0x00030021,0x00000003,
+	0x00000002,0x00030016,0x00000004,0x00000020,0x00040017,0x00000005,0x00000004,0x00000002,
+	0x00040017,0x00000006,0x00000004,0x00000003,0x00040017,0x00000007,0x00000004,0x00000004,
+	0x00040015,0x00000008,0x00000020,0x00000001,0x00040015,0x00000009,0x00000020,0x00000000,
+	0x00040017,0x0000000a,0x00000009,0x00000004,0x00020014,0x0000000b,0x00040018,0x0000000c,
+	0x00000007,0x00000004,0x00040020,0x0000000d,0x00000001,0x00000008,0x0004003b,0x0000000d,
+	0x0000000e,0x00000001,0x00040020,0x0000000f,0x00000001,0x00000006,0x0004003b,0x0000000f,
+	0x00000010,0x00000001,0x00040020,0x00000011,0x00000001,0x0000000a,0x0004003b,0x00000011,
+	0x00000012,0x00000001,0x00040020,0x00000013,0x00000001,0x00000009,0x0007001e,0x00000014,
+	0x0000000c,0x00000007,0x00000007,0x00000007,0x00000007,0x00040020,0x00000015,0x00000009,
+	0x00000014,0x0004003b,0x00000015,0x00000016,0x00000009,0x00040020,0x00000017,0x00000009,
+	0x00000007,0x00040020,0x00000018,0x00000009,0x0000000c,0x0004002b,0x00000009,0x00000019,
+	0x00000040,0x0004001c,0x0000001a,0x0000000a,0x00000019,0x0003001e,0x0000001b,0x0000001a,
+	0x00040020,0x0000001c,0x00000002,0x0000001b,0x0004003b,0x0000001c,0x0000001d,0x00000002,
+	0x00040020,0x0000001e,0x00000002,0x00000009,0x0003001e,0x0000001f,0x00000007,0x00040020,
+	0x00000020,0x00000003,0x0000001f,0x0004003b,0x00000020,0x00000021,0x00000003,0x00040020,
+	0x00000022,0x00000003,0x00000007,0x00040020,0x00000023,0x00000003,0x00000005,0x00040020,
+	0x00000024,0x00000003,0x00000004,0x0004003b,0x00000023,0x00000025,0x00000003,0x0004003b,
+	0x00000022,0x00000026,0x00000003,0x0004003b,0x00000024,0x00000027,0x00000003,0x0004002b,
+	0x00000008,0x00000028,0x00000000,0x0004002b,0x00000008,0x00000029,0x00000001,0x0004002b,
+	0x00000008,0x0000002a,0x00000002,0x0004002b,0x00000008,0x0000002b,0x00000003,0x0004002b,
+	0x00000008,0x0000002c,0x00000004,0x0004002b,0x00000009,0x0000002d,0x00000000,0x0004002b,
+	0x00000009,0x0000002e,0x00000001,0x0004002b,0x00000009,0x0000002f,0x00000002,0x0004002b,
+	0x00000009,0x00000030,0x00000003,0x0004002b,0x00000009,0x00000031,0x00000008,0x0004002b,
+	0x00000009,0x00000032,0x00000010,0x0004002b,0x00000009,0x00000033,0x000000ff,0x0007002c,
+	0x0000000a,0x00000034,0x00000033,0x00000033,0x00000033,0x00000033,0x0004002b,0x00000004,
+	0x00000035,0x00000000,0x0004002b,0x00000004,0x00000036,0x3f800000,0x0004002b,0x00000004,
+	0x00000037,0x41a00000,0x0004002b,0x00000004,0x00000038,0x3b83126f,0x0004002b,0x00000004,
+	0x00000039,0x3d800000,0x0005002c,0x00000005,0x0000003a,0x00000039,0x00000039,0x0004002b,
+	0x00000004,0x0000003b,0x437f0000,0x0007002c,0x00000007,0x0000003c,0x0000003b,0x0000003b,
+	0x0000003b,0x0000003b,0x00050036,0x00000002,0x0000003d,0x00000000,0x00000003,0x000200f8,
+	0x0000003e,0x0004003d,0x00000008,0x0000003f,0x0000000e,0x000500aa,0x0000000b,0x00000040,
+	0x0000003f,0x00000029,0x000600a9,0x00000004,0x00000041,0x00000040,0x00000036,0x00000035,
+	0x000500aa,0x0000000b,0x00000042,0x0000003f,0x0000002a,0x000600a9,0x00000004,0x00000043,
+	0x00000042,0x00000036,0x00000035,0x00050050,0x00000005,0x00000044,0x00000041,0x00000043,
+	0x0004003d,0x00000006,0x00000045,0x00000010,0x00050041,0x00000017,0x00000046,0x00000016,
+	0x0000002b,0x0004003d,0x00000007,0x00000047,0x00000046,0x0008004f,0x00000006,0x00000048,
+	0x00000047,0x00000047,0x00000000,0x00000001,0x00000002,0x00050083,0x00000006,0x00000049,
+	0x00000045,0x00000048,0x00050041,0x00000017,0x0000004a,0x00000016,0x0000002c,0x0004003d,
+	0x00000007,0x0000004b,0x0000004a,0x0008004f,0x00000006,0x0000004c,0x0000004b,0x0000004b,
+	0x00000000,0x00000001,0x00000002,0x00050094,0x00000004,0x0000004d,0x00000049,0x0000004c,
+	0x000500b8,0x0000000b,0x0000004e,0x0000004d,0x00000037,0x00050085,0x00000004,0x0000004f,
+	0x0000004d,0x00000038,0x00050081,0x00000004,0x00000050,0x00000036,0x0000004f,0x000600a9,
+	0x00000004,0x00000051,0x0000004e,0x00000036,0x00000050,0x00050041,0x00000017,0x00000052,
+	0x00000016,0x00000029,0x0004003d,0x00000007,0x00000053,0x00000052,0x0008004f,0x00000006,
+	0x00000054,0x00000053,0x00000053,0x00000000,0x00000001,0x00000002,0x0005008e,0x00000006,
+	0x00000055,0x00000054,0x00000041,0x00050041,0x00000017,0x00000056,0x00000016,0x0000002a,
+	0x0004003d,0x00000007,0x00000057,0x00000056,0x0008004f,0x00000006,0x00000058,0x00000057,
+	0x00000057,0x00000000,0x00000001,0x00000002,0x0005008e,0x00000006,0x00000059,0x00000058,
+	0x00000043,0x00050081,0x00000006,0x0000005a,0x00000055,0x00000059,0x0005008e,0x00000006,
+	0x0000005b,0x0000005a,0x00000051,0x00050081,0x00000006,0x0000005c,0x00000045,0x0000005b,
+	0x00050041,0x00000018,0x0000005d,0x00000016,0x00000028,0x0004003d,0x0000000c,0x0000005e,
+	0x0000005d,0x00050051,0x00000004,0x0000005f,0x0000005c,0x00000000,0x00050051,0x00000004,
+	0x00000060,0x0000005c,0x00000001,0x00050051,0x00000004,0x00000061,0x0000005c,0x00000002,
+	0x00070050,0x00000007,0x00000062,0x0000005f,0x00000060,0x00000061,0x00000036,0x00050091,
+	0x00000007,0x00000063,0x0000005e,0x00000062,0x00050041,0x00000022,0x00000064,0x00000021,
+	0x00000028,0x0003003e,0x00000064,0x00000063,0x00050081,0x00000005,0x00000065,0x00000044,
+	0x0000003a,0x0003003e,0x00000025,0x00000065,0x00050041,0x00000013,0x00000066,0x00000012,
+	0x0000002d,0x0004003d,0x00000009,0x00000067,0x00000066,0x000500c2,0x00000009,0x00000068,
+	0x00000067,0x0000002f,0x000500c7,0x00000009,0x00000069,0x00000067,0x00000030,0x00070041,
+	0x0000001e,0x0000006a,0x0000001d,0x00000028,0x00000068,0x00000069,0x0004003d,0x00000009,
+	0x0000006b,0x0000006a,0x000500c2,0x00000009,0x0000006c,0x0000006b,0x00000031,0x000500c2,
+	0x00000009,0x0000006d,0x0000006b,0x00000032,0x00050041,0x00000013,0x0000006e,0x00000012,
+	0x0000002e,0x0004003d,0x00000009,0x0000006f,0x0000006e,0x00070050,0x0000000a,0x00000070,
+	0x0000006b,0x0000006c,0x0000006d,0x0000006f,0x000500c7,0x0000000a,0x00000071,0x00000070,
+	0x00000034,0x00040070,0x00000007,0x00000072,0x00000071,0x00050088,0x00000007,0x00000073,
+	0x00000072,0x0000003c,0x0003003e,0x00000026,0x00000073,0x0003003e,0x00000027,0x00000035,
+	0x000100fd,0x00010038
 };
@@ -167,3 +167,16 @@ void QVk_CreateIndexBuffer(const void *data, VkDeviceSize size, qvkbuffer_t *dst
 
 	createStagedBuffer(data, size, dstBuffer, dstOpts, stagingBuffer);
 }
+
+void QVk_CreateStorageBuffer(const void *data, VkDeviceSize size, qvkbuffer_t *dstBuffer, qvkbuffer_t *stagingBuffer, VkMemoryPropertyFlags reqMemFlags, VkMemoryPropertyFlags prefMemFlags)
+{
+	qvkbufferopts_t dstOpts = {
+		.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		.reqMemFlags = reqMemFlags,
+		.prefMemFlags = prefMemFlags,
+		.vmaUsage = VMA_MEMORY_USAGE_GPU_ONLY,
+		.vmaFlags = 0
+	};
+
+	createStagedBuffer(data, size, dstBuffer, dstOpts, stagingBuffer);
+}
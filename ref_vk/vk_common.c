@@ -29,6 +29,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 ** QVk_Shutdown() - unloads libraries, NULLs function pointers
 */
 #include <float.h>
+#include <time.h>
 #include "../ref_vk/vk_local.h"
 #ifdef _WIN32
 #include "../win32/vk_win.h"
@@ -96,7 +97,9 @@ qvkrenderpass_t vk_renderpasses[RP_COUNT] = {
 VkCommandPool vk_commandPool[NUM_CMDBUFFERS] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
 VkCommandPool vk_transferCommandPool = VK_NULL_HANDLE;
 VkDescriptorPool vk_descriptorPool = VK_NULL_HANDLE;
-static VkCommandPool vk_stagingCommandPool[NUM_DYNBUFFERS] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+// more staging buffers are added while the GPU is still busy copying from the others, up to this count
+#define MAX_STAGINGBUFFERS 8
+static VkCommandPool vk_stagingCommandPool[MAX_STAGINGBUFFERS];
 // Vulkan image views
 VkImageView *vk_imageviews = NULL;
 // Vulkan framebuffers
@@ -135,15 +138,28 @@ int vk_activeStagingBuffer = 0;
 qboolean vk_frameStarted = false;
 // renderer needs to restart next frame?
 qboolean vk_restart = false;
+// profiler counters of each command buffer's frame, collected once its fence has been waited on
+static qvkprofile_t vk_frameStats[NUM_CMDBUFFERS];
+// profiler counters of the frame being recorded and results of the last completed one
+qvkprofile_t *vk_recordStats = &vk_frameStats[0];
+qvkprofile_t vk_profileStats;
+// render pass timestamp queries: 2*rpType marks the beginning of a pass, 2*rpType+1 its end
+static VkQueryPool vk_timestampPools[NUM_CMDBUFFERS];
+// queries written into each command buffer's pool this frame
+static uint32_t vk_timestampMask[NUM_CMDBUFFERS];
+// timestampValidBits of the graphics queue, 0 if it can't write timestamps
+static uint64_t vk_timestampValidMask = 0;
+// is the active frame writing timestamps?
+static qboolean vk_writeTimestamps = false;
+// render pass currently being recorded and when it was begun
+static qvkrenderpasstype_t vk_activeRenderpass = RP_WORLD;
+static double vk_renderpassStart = 0.0;
 
 // render pipelines
 qvkpipeline_t vk_drawTexQuadPipeline = QVKPIPELINE_INIT;
 qvkpipeline_t vk_drawColorQuadPipeline[2]  = { QVKPIPELINE_INIT, QVKPIPELINE_INIT };
-qvkpipeline_t vk_drawModelPipelineStrip[2] = { QVKPIPELINE_INIT, QVKPIPELINE_INIT };
 qvkpipeline_t vk_drawModelPipelineFan[2]   = { QVKPIPELINE_INIT, QVKPIPELINE_INIT };
-qvkpipeline_t vk_drawNoDepthModelPipelineStrip = QVKPIPELINE_INIT;
 qvkpipeline_t vk_drawNoDepthModelPipelineFan = QVKPIPELINE_INIT;
-qvkpipeline_t vk_drawLefthandModelPipelineStrip = QVKPIPELINE_INIT;
 qvkpipeline_t vk_drawLefthandModelPipelineFan = QVKPIPELINE_INIT;
 qvkpipeline_t vk_drawNullModelPipeline = QVKPIPELINE_INIT;
 qvkpipeline_t vk_drawParticlesPipeline = QVKPIPELINE_INIT;
@@ -233,34 +249,58 @@ PFN_vkReleaseFullScreenExclusiveModeEXT qvkReleaseFullScreenExclusiveModeEXT;
 qvkbuffer_t vk_texRectVbo;
 qvkbuffer_t vk_colorRectVbo;
 qvkbuffer_t vk_rectIbo;
+qvkbuffer_t vk_aliasTablesSbo;
 
-// global dynamic buffers (double buffered)
-static qvkbuffer_t vk_dynVertexBuffers[NUM_DYNBUFFERS];
-static qvkbuffer_t vk_dynIndexBuffers[NUM_DYNBUFFERS];
-static qvkbuffer_t vk_dynUniformBuffers[NUM_DYNBUFFERS];
-static VkDescriptorSet vk_uboDescriptorSets[NUM_DYNBUFFERS];
-static qvkstagingbuffer_t vk_stagingBuffers[NUM_DYNBUFFERS];
+// global dynamic buffers: every frame in flight owns a ring of persistently mapped pages which
+// are suballocated linearly and rewound once the frame's fence has been waited on. Running out
+// of space appends a page instead of replacing the buffers, so nothing the frame already
+// recorded is invalidated and nothing needs to be released later.
+#define MAX_DYNBUFFER_PAGES 32
+
+typedef enum
+{
+	DYNBUFFER_VERTEX,
+	DYNBUFFER_INDEX,
+	DYNBUFFER_UNIFORM,
+	DYNBUFFER_COUNT
+} qvkdynbuffertype_t;
+
+typedef struct
+{
+	qvkbuffer_t		pages[MAX_DYNBUFFER_PAGES];
+	VkDeviceSize	pageSizes[MAX_DYNBUFFER_PAGES];
+	VkDescriptorSet	descriptorSets[MAX_DYNBUFFER_PAGES];	// uniform pages only
+	int				numPages;
+	int				activePage;
+	VkDeviceSize	usage;									// bytes handed out this frame
+} qvkdynring_t;
+
+static qvkdynring_t vk_dynRings[DYNBUFFER_COUNT][NUM_DYNBUFFERS];
+// lightstyle colours read by the lightmapped polygon shader, rewritten every frame
+static qvkbuffer_t vk_lightStyleSbo[NUM_DYNBUFFERS];
+static VkDescriptorSet vk_lightStyleDescSets[NUM_DYNBUFFERS];
+static qvkstagingbuffer_t vk_stagingBuffers[MAX_STAGINGBUFFERS];
+static int vk_numStagingBuffers = 0;
 static int vk_activeDynBufferIdx = 0;
 static int vk_activeSwapBufferIdx = 0;
 
 // index buffer for triangle fan emulation - all because Metal/MoltenVK don't support them
-static VkBuffer *vk_triangleFanIbo = NULL;
-static uint32_t  vk_triangleFanIboUsage = 0;
+static qvkbuffer_t vk_triangleFanIbo;
 
-// swap buffers used if primary dynamic buffers get full
+// buffers and textures released mid-frame are destroyed once no frame in flight can use them anymore
 #define NUM_SWAPBUFFER_SLOTS 4
 static int vk_swapBuffersCnt[NUM_SWAPBUFFER_SLOTS];
-static int vk_swapDescSetsCnt[NUM_SWAPBUFFER_SLOTS];
 static qvkbuffer_t *vk_swapBuffers[NUM_SWAPBUFFER_SLOTS];
-static VkDescriptorSet *vk_swapDescriptorSets[NUM_SWAPBUFFER_SLOTS];
+static int vk_swapTexturesCnt[NUM_SWAPBUFFER_SLOTS];
+static qvktexture_t *vk_swapTextures[NUM_SWAPBUFFER_SLOTS];
 
-// by how much will the dynamic buffers be resized if we run out of space?
+// by how much will the triangle fan index buffer be resized if we run out of space?
 #define BUFFER_RESIZE_FACTOR 2.f
 // size in bytes used for uniform descriptor update
 #define UNIFORM_ALLOC_SIZE 1024
-// start values for dynamic buffer sizes - bound to change if the application runs out of space (sizes in bytes)
+// dynamic buffer page sizes - larger requests get a page of their own (sizes in bytes)
 #define VERTEX_BUFFER_SIZE (1024 * 1024)
-#define INDEX_BUFFER_SIZE (2 * 1024)
+#define INDEX_BUFFER_SIZE (256 * 1024)
 #define UNIFORM_BUFFER_SIZE (2048 * 1024)
 // staging buffer is constant in size but has a max limit beyond which it will be submitted
 #define STAGING_BUFFER_MAXSIZE (8192 * 1024)
@@ -271,6 +311,9 @@ static VkDescriptorSet *vk_swapDescriptorSets[NUM_SWAPBUFFER_SLOTS];
 VkDescriptorSetLayout vk_uboDescSetLayout;
 VkDescriptorSetLayout vk_samplerDescSetLayout;
 VkDescriptorSetLayout vk_samplerLightmapDescSetLayout;
+// read-only storage buffer with constant tables
+VkDescriptorSetLayout vk_storageDescSetLayout;
+VkDescriptorSet vk_aliasTablesDescSet;
 
 extern cvar_t *vk_msaa;
 extern cvar_t *vid_ref;
@@ -801,10 +844,15 @@ static void CreateDescriptorSetLayouts()
 	VK_VERIFY(vkCreateDescriptorSetLayout(vk_device.logical, &layoutInfo, NULL, &vk_samplerDescSetLayout));
 	// secondary sampler: lightmaps
 	VK_VERIFY(vkCreateDescriptorSetLayout(vk_device.logical, &layoutInfo, NULL, &vk_samplerLightmapDescSetLayout));
+	// storage buffer layout
+	layoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	layoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	VK_VERIFY(vkCreateDescriptorSetLayout(vk_device.logical, &layoutInfo, NULL, &vk_storageDescSetLayout));
 
 	QVk_DebugSetObjectName((uint64_t)vk_uboDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Descriptor Set Layout: UBO");
 	QVk_DebugSetObjectName((uint64_t)vk_samplerDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Descriptor Set Layout: Sampler");
 	QVk_DebugSetObjectName((uint64_t)vk_samplerLightmapDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Descriptor Set Layout: Sampler + Lightmap");
+	QVk_DebugSetObjectName((uint64_t)vk_storageDescSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Descriptor Set Layout: Storage Buffer");
 }
 
 // internal helper
@@ -897,12 +945,18 @@ static void CreateDescriptorPool()
 		// UBO
 		{
 			.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-			.descriptorCount = 16
+			// one per dynamic uniform buffer page
+			.descriptorCount = MAX_DYNBUFFER_PAGES * NUM_DYNBUFFERS
 		},
 		// sampler
 		{
 			.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
 			.descriptorCount = MAX_VKTEXTURES + 32
+		},
+		// storage buffers: alias model tables and per frame lightstyles
+		{
+			.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1 + NUM_DYNBUFFERS
 		}
 	};
 
@@ -910,7 +964,7 @@ static void CreateDescriptorPool()
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
 		.pNext = NULL,
 		.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-		.maxSets = MAX_VKTEXTURES + 32,
+		.maxSets = MAX_VKTEXTURES + 32 + MAX_DYNBUFFER_PAGES * NUM_DYNBUFFERS + 1 + NUM_DYNBUFFERS,
 		.poolSizeCount = sizeof(poolSizes) / sizeof(poolSizes[0]),
 		.pPoolSizes = poolSizes,
 	};
@@ -957,28 +1011,147 @@ static void CreateUboDescriptorSet(VkDescriptorSet *descSet, VkBuffer buffer)
 	vkUpdateDescriptorSets(vk_device.logical, 1, &descriptorWrite, 0, NULL);
 }
 
+// internal helper
+static void CreateStorageDescriptorSet(VkDescriptorSet *descSet, VkBuffer buffer, VkDeviceSize range)
+{
+	VkDescriptorSetAllocateInfo dsAllocInfo = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = NULL,
+		.descriptorPool = vk_descriptorPool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &vk_storageDescSetLayout
+	};
+
+	VK_VERIFY(vkAllocateDescriptorSets(vk_device.logical, &dsAllocInfo, descSet));
+
+	VkDescriptorBufferInfo bufferInfo = {
+		.buffer = buffer,
+		.offset = 0,
+		.range = range
+	};
+
+	VkWriteDescriptorSet descriptorWrite = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = NULL,
+		.dstSet = *descSet,
+		.dstBinding = 0,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.pImageInfo = NULL,
+		.pBufferInfo = &bufferInfo,
+		.pTexelBufferView = NULL,
+	};
+
+	vkUpdateDescriptorSets(vk_device.logical, 1, &descriptorWrite, 0, NULL);
+}
+
+static const char *vk_dynBufferNames[DYNBUFFER_COUNT] = { "Vertex", "Index", "Uniform" };
+static const VkDeviceSize vk_dynPageSizes[DYNBUFFER_COUNT] = { VERTEX_BUFFER_SIZE, INDEX_BUFFER_SIZE, UNIFORM_BUFFER_SIZE };
+
+// internal helper
+static void CreateDynamicPage(qvkdynbuffertype_t type, int ringIdx, VkDeviceSize size)
+{
+	qvkdynring_t *ring = &vk_dynRings[type][ringIdx];
+	int page = ring->numPages;
+
+	if (page == MAX_DYNBUFFER_PAGES)
+		Sys_Error("CreateDynamicPage(): out of dynamic %s buffer pages!", vk_dynBufferNames[type]);
+
+	switch (type)
+	{
+	case DYNBUFFER_VERTEX:
+		QVk_CreateVertexBuffer(NULL, size, &ring->pages[page], NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+		break;
+	case DYNBUFFER_INDEX:
+		QVk_CreateIndexBuffer(NULL, size, &ring->pages[page], NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+		break;
+	default:
+		VK_VERIFY(QVk_CreateUniformBuffer(size, &ring->pages[page], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
+		// create descriptor set for the uniform buffer
+		CreateUboDescriptorSet(&ring->descriptorSets[page], ring->pages[page].buffer);
+		QVk_DebugSetObjectName((uint64_t)ring->descriptorSets[page], VK_OBJECT_TYPE_DESCRIPTOR_SET, va("Dynamic UBO Descriptor Set #%d.%d", ringIdx, page));
+		break;
+	}
+
+	// keep dynamic buffers persistently mapped
+	VK_VERIFY(vmaMapMemory(vk_malloc, ring->pages[page].allocation, &ring->pages[page].allocInfo.pMappedData));
+	ring->pages[page].currentOffset = 0;
+	ring->pageSizes[page] = size;
+	ring->numPages++;
+
+	QVk_DebugSetObjectName((uint64_t)ring->pages[page].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic %s Buffer #%d.%d", vk_dynBufferNames[type], ringIdx, page));
+	QVk_DebugSetObjectName((uint64_t)ring->pages[page].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic %s Buffer #%d.%d", vk_dynBufferNames[type], ringIdx, page));
+}
+
 // internal helper
 static void CreateDynamicBuffers()
 {
+	for (int type = 0; type < DYNBUFFER_COUNT; ++type)
+	{
+		for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+		{
+			memset(&vk_dynRings[type][i], 0, sizeof(qvkdynring_t));
+			CreateDynamicPage(type, i, vk_dynPageSizes[type]);
+		}
+	}
+
 	for (int i = 0; i < NUM_DYNBUFFERS; ++i)
 	{
-		QVk_CreateVertexBuffer(NULL, vk_config.vertex_buffer_size, &vk_dynVertexBuffers[i], NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
-		QVk_CreateIndexBuffer(NULL, vk_config.index_buffer_size, &vk_dynIndexBuffers[i], NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
-		VK_VERIFY(QVk_CreateUniformBuffer(vk_config.uniform_buffer_size, &vk_dynUniformBuffers[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
-		// keep dynamic buffers persistently mapped
-		VK_VERIFY(vmaMapMemory(vk_malloc, vk_dynVertexBuffers[i].allocation, &vk_dynVertexBuffers[i].allocInfo.pMappedData));
-		VK_VERIFY(vmaMapMemory(vk_malloc, vk_dynIndexBuffers[i].allocation, &vk_dynIndexBuffers[i].allocInfo.pMappedData));
-		VK_VERIFY(vmaMapMemory(vk_malloc, vk_dynUniformBuffers[i].allocation, &vk_dynUniformBuffers[i].allocInfo.pMappedData));
-		// create descriptor set for the uniform buffer
-		CreateUboDescriptorSet(&vk_uboDescriptorSets[i], vk_dynUniformBuffers[i].buffer);
+		qvkbufferopts_t opts = {
+			.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			.reqMemFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			.prefMemFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+			.vmaUsage = VMA_MEMORY_USAGE_CPU_TO_GPU,
+			.vmaFlags = 0
+		};
+
+		// matches LightStyles in polygon_lmap.vert (std430)
+		VK_VERIFY(QVk_CreateBuffer(sizeof(float) * 4 * MAX_LIGHTSTYLES, &vk_lightStyleSbo[i], opts));
+		VK_VERIFY(vmaMapMemory(vk_malloc, vk_lightStyleSbo[i].allocation, &vk_lightStyleSbo[i].allocInfo.pMappedData));
+		memset(vk_lightStyleSbo[i].allocInfo.pMappedData, 0, sizeof(float) * 4 * MAX_LIGHTSTYLES);
+		CreateStorageDescriptorSet(&vk_lightStyleDescSets[i], vk_lightStyleSbo[i].buffer, sizeof(float) * 4 * MAX_LIGHTSTYLES);
+
+		QVk_DebugSetObjectName((uint64_t)vk_lightStyleSbo[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Lightstyle SBO #%d", i));
+		QVk_DebugSetObjectName((uint64_t)vk_lightStyleSbo[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Lightstyle SBO #%d", i));
+		QVk_DebugSetObjectName((uint64_t)vk_lightStyleDescSets[i], VK_OBJECT_TYPE_DESCRIPTOR_SET, va("Descriptor Set: Dynamic Lightstyles #%d", i));
+	}
+
+	vk_config.vertex_buffer_size = VERTEX_BUFFER_SIZE;
+	vk_config.index_buffer_size = INDEX_BUFFER_SIZE;
+	vk_config.uniform_buffer_size = UNIFORM_BUFFER_SIZE;
+	vk_config.vertex_buffer_pages = vk_config.index_buffer_pages = vk_config.uniform_buffer_pages = 1;
+}
 
-		QVk_DebugSetObjectName((uint64_t)vk_uboDescriptorSets[i], VK_OBJECT_TYPE_DESCRIPTOR_SET, va("Dynamic UBO Descriptor Set #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_dynVertexBuffers[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Vertex Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_dynVertexBuffers[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Vertex Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_dynIndexBuffers[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Index Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_dynIndexBuffers[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Index Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_dynUniformBuffers[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Uniform Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_dynUniformBuffers[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Uniform Buffer #%d", i));
+// internal helper
+static void DestroyDynamicBuffers()
+{
+	for (int type = 0; type < DYNBUFFER_COUNT; ++type)
+	{
+		for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+		{
+			qvkdynring_t *ring = &vk_dynRings[type][i];
+
+			// uniform descriptor sets go away with the descriptor pool
+			for (int page = 0; page < ring->numPages; ++page)
+			{
+				vmaUnmapMemory(vk_malloc, ring->pages[page].allocation);
+				QVk_FreeBuffer(&ring->pages[page]);
+			}
+			ring->numPages = 0;
+		}
+	}
+
+	// lightstyle descriptor sets go away with the descriptor pool as well
+	for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+	{
+		if (vk_lightStyleSbo[i].buffer == VK_NULL_HANDLE)
+			continue;
+
+		vmaUnmapMemory(vk_malloc, vk_lightStyleSbo[i].allocation);
+		QVk_FreeBuffer(&vk_lightStyleSbo[i]);
+		memset(&vk_lightStyleSbo[i], 0, sizeof(vk_lightStyleSbo[i]));
+		vk_lightStyleDescSets[i] = VK_NULL_HANDLE;
 	}
 }
 
@@ -998,17 +1171,33 @@ static void ReleaseSwapBuffers()
 		vk_swapBuffersCnt[releaseBufferIdx] = 0;
 	}
 
-	if (vk_swapDescSetsCnt[releaseBufferIdx] > 0)
+	if (vk_swapTexturesCnt[releaseBufferIdx] > 0)
 	{
-		vkFreeDescriptorSets(vk_device.logical, vk_descriptorPool, vk_swapDescSetsCnt[releaseBufferIdx], vk_swapDescriptorSets[releaseBufferIdx]);
-		vk_config.allocated_ubo_descriptor_set_count--;
+		for (int i = 0; i < vk_swapTexturesCnt[releaseBufferIdx]; i++)
+			QVk_DestroyTexture(&vk_swapTextures[releaseBufferIdx][i]);
 
-		free(vk_swapDescriptorSets[releaseBufferIdx]);
-		vk_swapDescriptorSets[releaseBufferIdx] = NULL;
-		vk_swapDescSetsCnt[releaseBufferIdx] = 0;
+		free(vk_swapTextures[releaseBufferIdx]);
+		vk_swapTextures[releaseBufferIdx] = NULL;
+		vk_swapTexturesCnt[releaseBufferIdx] = 0;
 	}
 }
 
+void QVk_DeferBufferRelease(const qvkbuffer_t *buffer)
+{
+	int cnt = ++vk_swapBuffersCnt[vk_activeSwapBufferIdx];
+
+	vk_swapBuffers[vk_activeSwapBufferIdx] = realloc(vk_swapBuffers[vk_activeSwapBufferIdx], sizeof(qvkbuffer_t) * cnt);
+	vk_swapBuffers[vk_activeSwapBufferIdx][cnt - 1] = *buffer;
+}
+
+void QVk_DeferTextureRelease(const qvktexture_t *texture)
+{
+	int cnt = ++vk_swapTexturesCnt[vk_activeSwapBufferIdx];
+
+	vk_swapTextures[vk_activeSwapBufferIdx] = realloc(vk_swapTextures[vk_activeSwapBufferIdx], sizeof(qvktexture_t) * cnt);
+	vk_swapTextures[vk_activeSwapBufferIdx][cnt - 1] = *texture;
+}
+
 // internal helper
 static int NextPow2(int v)
 {
@@ -1026,9 +1215,7 @@ static int NextPow2(int v)
 static void RebuildTriangleFanIndexBuffer()
 {
 	int idx = 0;
-	VkDeviceSize dstOffset = 0;
 	VkDeviceSize bufferSize = 3 * vk_config.triangle_fan_index_count * sizeof(uint16_t);
-	uint16_t *iboData = NULL;
 	uint16_t *fanData = malloc(bufferSize);
 
 	// fill the index buffer so that we can emulate triangle fans via triangle lists
@@ -1039,49 +1226,146 @@ static void RebuildTriangleFanIndexBuffer()
 		fanData[idx++] = i + 2;
 	}
 
-	for (int i = 0; i < NUM_DYNBUFFERS; ++i)
-	{
-		vk_activeDynBufferIdx = (vk_activeDynBufferIdx + 1) % NUM_DYNBUFFERS;
-		vmaInvalidateAllocation(vk_malloc, vk_dynIndexBuffers[i].allocation, 0, VK_WHOLE_SIZE);
+	// the old buffer may still be referenced by the frame being recorded
+	if (vk_triangleFanIbo.buffer != VK_NULL_HANDLE)
+		QVk_DeferBufferRelease(&vk_triangleFanIbo);
 
-		iboData = (uint16_t *)QVk_GetIndexBuffer(bufferSize, &dstOffset);
-		memcpy(iboData, fanData, bufferSize);
-
-		vmaFlushAllocation(vk_malloc, vk_dynIndexBuffers[i].allocation, 0, VK_WHOLE_SIZE);
-	}
-
-	vk_triangleFanIbo = &vk_dynIndexBuffers[vk_activeDynBufferIdx].buffer;
-	vk_triangleFanIboUsage = ((bufferSize % 4) == 0) ? bufferSize : (bufferSize + 4 - (bufferSize % 4));
+	QVk_CreateIndexBuffer(fanData, bufferSize, &vk_triangleFanIbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+	QVk_DebugSetObjectName((uint64_t)vk_triangleFanIbo.buffer, VK_OBJECT_TYPE_BUFFER, "Static Buffer: Triangle Fan IBO");
+	QVk_DebugSetObjectName((uint64_t)vk_triangleFanIbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Memory: Triangle Fan IBO");
 	free(fanData);
 }
 
 // internal helper
-static void CreateStagingBuffers()
+static void CreateStagingBuffer(int i)
 {
 	VkFenceCreateInfo fCreateInfo = {
 		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
 		.flags = 0
 	};
 
-	for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+	VK_VERIFY(QVk_CreateCommandPool(&vk_stagingCommandPool[i], vk_device.gfxFamilyIndex));
+	QVk_DebugSetObjectName((uint64_t)vk_stagingCommandPool[i], VK_OBJECT_TYPE_COMMAND_POOL, va("Command Pool #%d: Staging", i));
+
+	VK_VERIFY(QVk_CreateStagingBuffer(STAGING_BUFFER_MAXSIZE, &vk_stagingBuffers[i].buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
+	VK_VERIFY(vmaMapMemory(vk_malloc, vk_stagingBuffers[i].buffer.allocation, &vk_stagingBuffers[i].buffer.allocInfo.pMappedData));
+	vk_stagingBuffers[i].buffer.currentOffset = 0;
+	vk_stagingBuffers[i].submitted = false;
+
+	VK_VERIFY(vkCreateFence(vk_device.logical, &fCreateInfo, NULL, &vk_stagingBuffers[i].fence));
+
+	vk_stagingBuffers[i].cmdBuffer = QVk_CreateCommandBuffer(&vk_stagingCommandPool[i], VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+	VK_VERIFY(QVk_BeginCommand(&vk_stagingBuffers[i].cmdBuffer));
+
+	QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].fence, VK_OBJECT_TYPE_FENCE, va("Fence: Staging Buffer #%d", i));
+	QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].buffer.buffer, VK_OBJECT_TYPE_BUFFER, va("Staging Buffer #%d", i));
+	QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].buffer.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Staging Buffer #%d", i));
+	QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].cmdBuffer, VK_OBJECT_TYPE_COMMAND_BUFFER, va("Command Buffer: Staging Buffer #%d", i));
+}
+
+// internal helper
+// high resolution wall clock in ms, used for the profiler's recording times
+static double ProfileTime()
+{
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// internal helper
+static void CreateTimestampQueries()
+{
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(vk_device.physical, &queueFamilyCount, NULL);
+	VkQueueFamilyProperties *queueFamilies = (VkQueueFamilyProperties *)malloc(queueFamilyCount * sizeof(VkQueueFamilyProperties));
+	vkGetPhysicalDeviceQueueFamilyProperties(vk_device.physical, &queueFamilyCount, queueFamilies);
+	const uint32_t validBits = queueFamilies[vk_device.gfxFamilyIndex].timestampValidBits;
+	free(queueFamilies);
+
+	memset(vk_frameStats, 0, sizeof(vk_frameStats));
+	memset(&vk_profileStats, 0, sizeof(vk_profileStats));
+	memset(vk_timestampMask, 0, sizeof(vk_timestampMask));
+	vk_recordStats = &vk_frameStats[0];
+
+	// software implementations may not support timestamps at all, the profiler then only reports CPU side costs
+	if (validBits == 0 || vk_device.properties.limits.timestampPeriod <= 0.f)
 	{
-		VK_VERIFY(QVk_CreateCommandPool(&vk_stagingCommandPool[i], vk_device.gfxFamilyIndex));
-		QVk_DebugSetObjectName((uint64_t)vk_stagingCommandPool[i], VK_OBJECT_TYPE_COMMAND_POOL, va("Command Pool #%d: Staging", i));
+		vk_timestampValidMask = 0;
+		ri.Con_Printf(PRINT_ALL, "...GPU timestamps not supported\n");
+		return;
+	}
+
+	vk_timestampValidMask = validBits >= 64 ? UINT64_MAX : ((uint64_t)1 << validBits) - 1;
+
+	VkQueryPoolCreateInfo qpCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = RP_COUNT * 2,
+		.pipelineStatistics = 0
+	};
+
+	for (int i = 0; i < NUM_CMDBUFFERS; ++i)
+	{
+		VK_VERIFY(vkCreateQueryPool(vk_device.logical, &qpCreateInfo, NULL, &vk_timestampPools[i]));
+		QVk_DebugSetObjectName((uint64_t)vk_timestampPools[i], VK_OBJECT_TYPE_QUERY_POOL, va("Query Pool: Timestamps #%d", i));
+	}
+}
+
+// internal helper
+// writes a render pass timestamp into the active frame's pool, once per frame
+static void WriteTimestamp(uint32_t query, VkPipelineStageFlagBits stage)
+{
+	if (!vk_writeTimestamps || (vk_timestampMask[vk_activeBufferIdx] & (1u << query)))
+		return;
+
+	vkCmdWriteTimestamp(vk_commandbuffers[vk_activeBufferIdx], stage, vk_timestampPools[vk_activeBufferIdx], query);
+	vk_timestampMask[vk_activeBufferIdx] |= 1u << query;
+}
+
+// internal helper
+// makes the results of the frame recorded into command buffer idx the current vk_profileStats, its fence must have been waited on
+static void CollectFrameStats(int idx)
+{
+	qvkprofile_t *stats = &vk_frameStats[idx];
 
-		VK_VERIFY(QVk_CreateStagingBuffer(STAGING_BUFFER_MAXSIZE, &vk_stagingBuffers[i].buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
-		VK_VERIFY(vmaMapMemory(vk_malloc, vk_stagingBuffers[i].buffer.allocation, &vk_stagingBuffers[i].buffer.allocInfo.pMappedData));
-		vk_stagingBuffers[i].submitted = false;
+	for (int i = 0; i < RP_COUNT; ++i)
+		stats->gpuTime[i] = -1.f;
 
-		VK_VERIFY(vkCreateFence(vk_device.logical, &fCreateInfo, NULL, &vk_stagingBuffers[i].fence));
+	if (vk_timestampMask[idx])
+	{
+		// timestamp and availability pairs - VK_NOT_READY only means some passes weren't recorded in that frame
+		uint64_t results[RP_COUNT * 2][2];
+		vkGetQueryPoolResults(vk_device.logical, vk_timestampPools[idx], 0, RP_COUNT * 2, sizeof(results), results, sizeof(results[0]),
+							  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
 
-		vk_stagingBuffers[i].cmdBuffer = QVk_CreateCommandBuffer(&vk_stagingCommandPool[i], VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-		VK_VERIFY(QVk_BeginCommand(&vk_stagingBuffers[i].cmdBuffer));
+		for (int i = 0; i < RP_COUNT; ++i)
+		{
+			const uint32_t passMask = 3u << (i * 2);
+			if ((vk_timestampMask[idx] & passMask) != passMask || !results[i * 2][1] || !results[i * 2 + 1][1])
+				continue;
 
-		QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].fence, VK_OBJECT_TYPE_FENCE, va("Fence: Staging Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].buffer.buffer, VK_OBJECT_TYPE_BUFFER, va("Staging Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].buffer.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Staging Buffer #%d", i));
-		QVk_DebugSetObjectName((uint64_t)vk_stagingBuffers[i].cmdBuffer, VK_OBJECT_TYPE_COMMAND_BUFFER, va("Command Buffer: Staging Buffer #%d", i));
+			const uint64_t ticks = (results[i * 2 + 1][0] - results[i * 2][0]) & vk_timestampValidMask;
+			stats->gpuTime[i] = (float)(ticks * vk_device.properties.limits.timestampPeriod / 1000000.0);
+		}
 	}
+
+	stats->frame = vk_profileStats.frame + 1;
+	vk_profileStats = *stats;
+	memset(stats, 0, sizeof(qvkprofile_t));
+	vk_timestampMask[idx] = 0;
+}
+
+// internal helper
+static void CreateStagingBuffers()
+{
+	for (vk_numStagingBuffers = 0; vk_numStagingBuffers < NUM_DYNBUFFERS; ++vk_numStagingBuffers)
+		CreateStagingBuffer(vk_numStagingBuffers);
+
+	vk_activeStagingBuffer = 0;
+	vk_config.staging_buffer_count = vk_numStagingBuffers;
+	vk_config.staging_buffer_stalls = 0;
 }
 
 // internal helper
@@ -1111,7 +1395,7 @@ static void SubmitStagingBuffer(int index)
 	VK_VERIFY(vkQueueSubmit(vk_device.gfxQueue, 1, &submitInfo, vk_stagingBuffers[index].fence));
 
 	vk_stagingBuffers[index].submitted = true;
-	vk_activeStagingBuffer = (vk_activeStagingBuffer + 1) % NUM_DYNBUFFERS;
+	vk_activeStagingBuffer = (vk_activeStagingBuffer + 1) % vk_numStagingBuffers;
 }
 
 // internal helper
@@ -1129,9 +1413,24 @@ static void CreateStaticBuffers()
 
 	const uint32_t indices[] = { 0, 1, 2, 0, 3, 1 };
 
+	// matches AliasTables in model.vert (std430)
+	static struct {
+		float normals[NUMVERTEXNORMALS][4];
+		float dots[SHADEDOT_QUANT][256];
+	} aliasTables;
+
+	for (int i = 0; i < NUMVERTEXNORMALS; ++i)
+	{
+		VectorCopy(r_avertexnormals[i], aliasTables.normals[i]);
+		aliasTables.normals[i][3] = 0.f;
+	}
+	memcpy(aliasTables.dots, r_avertexnormal_dots, sizeof(aliasTables.dots));
+
 	QVk_CreateVertexBuffer(texVerts, sizeof(texVerts), &vk_texRectVbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
 	QVk_CreateVertexBuffer(colorVerts, sizeof(colorVerts), &vk_colorRectVbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
 	QVk_CreateIndexBuffer(indices, sizeof(indices), &vk_rectIbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+	QVk_CreateStorageBuffer(&aliasTables, sizeof(aliasTables), &vk_aliasTablesSbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+	CreateStorageDescriptorSet(&vk_aliasTablesDescSet, vk_aliasTablesSbo.buffer, sizeof(aliasTables));
 
 	QVk_DebugSetObjectName((uint64_t)vk_texRectVbo.buffer, VK_OBJECT_TYPE_BUFFER, "Static Buffer: Textured Rectangle VBO");
 	QVk_DebugSetObjectName((uint64_t)vk_texRectVbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Memory: Textured Rectangle VBO");
@@ -1139,6 +1438,9 @@ static void CreateStaticBuffers()
 	QVk_DebugSetObjectName((uint64_t)vk_colorRectVbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Memory: Colored Rectangle VBO");
 	QVk_DebugSetObjectName((uint64_t)vk_rectIbo.buffer, VK_OBJECT_TYPE_BUFFER, "Static Buffer: Rectangle IBO");
 	QVk_DebugSetObjectName((uint64_t)vk_rectIbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Memory: Rectangle IBO");
+	QVk_DebugSetObjectName((uint64_t)vk_aliasTablesSbo.buffer, VK_OBJECT_TYPE_BUFFER, "Static Buffer: Alias Model Tables SBO");
+	QVk_DebugSetObjectName((uint64_t)vk_aliasTablesSbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Memory: Alias Model Tables SBO");
+	QVk_DebugSetObjectName((uint64_t)vk_aliasTablesDescSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Descriptor Set: Alias Model Tables");
 }
 
 // internal helper
@@ -1158,22 +1460,46 @@ static void CreatePipelines()
 	VK_VERTINFO(RGB_RGB, sizeof(float) * 6,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
 											VK_INPUTATTR_DESC(1, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3));
 
-	VK_VERTINFO(RGB_RGBA,  sizeof(float) * 7,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
-												VK_INPUTATTR_DESC(1, VK_FORMAT_R32G32B32A32_SFLOAT, sizeof(float) * 3));
+	// point particles: color and alpha packed into bytes, the shaders still see a vec4
+	VK_VERTINFO(RGB_RGBA8, sizeof(float) * 4,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
+												VK_INPUTATTR_DESC(1, VK_FORMAT_R8G8B8A8_UNORM, sizeof(float) * 3));
+
+	// lightmapped polygons: lightmap layer step and the surface's lightstyles follow the texture coordinates
+	VK_VERTINFO(RGB_RG_RG_R_RGBA8UI, sizeof(float) * 9,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
+														VK_INPUTATTR_DESC(1, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 3),
+														VK_INPUTATTR_DESC(2, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 5),
+														VK_INPUTATTR_DESC(3, VK_FORMAT_R32_SFLOAT, sizeof(float) * 7),
+														VK_INPUTATTR_DESC(4, VK_FORMAT_R8G8B8A8_UINT, sizeof(float) * 8));
 
-	VK_VERTINFO(RGB_RG_RG, sizeof(float) * 7,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
-												VK_INPUTATTR_DESC(1, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 3),
-												VK_INPUTATTR_DESC(2, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 5));
 
-	VK_VERTINFO(RGB_RGBA_RG, sizeof(float) * 9,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
-												VK_INPUTATTR_DESC(1, VK_FORMAT_R32G32B32A32_SFLOAT, sizeof(float) * 3),
-												VK_INPUTATTR_DESC(2, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 7));
+	// alias models: current and old frame vertices are separate bindings into the same
+	// per-model buffer, texture coordinates follow all frames in a third one
+	VkVertexInputBindingDescription aliasBindingDesc[] = {
+		{ .binding = 0, .stride = sizeof(uint8_t) * 4, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
+		{ .binding = 1, .stride = sizeof(uint8_t) * 4, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
+		{ .binding = 2, .stride = sizeof(float) * 2, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX }
+	};
+	VkVertexInputAttributeDescription aliasAttrDesc[] = {
+		{ .binding = 0, .location = 0, .format = VK_FORMAT_R8G8B8A8_UINT, .offset = 0 },
+		{ .binding = 1, .location = 1, .format = VK_FORMAT_R8G8B8A8_UINT, .offset = 0 },
+		{ .binding = 2, .location = 2, .format = VK_FORMAT_R32G32_SFLOAT, .offset = 0 }
+	};
+	VkPipelineVertexInputStateCreateInfo vertInfoAlias = VK_VERTEXINPUT_CINF(aliasBindingDesc[0], aliasAttrDesc);
+	vertInfoAlias.vertexBindingDescriptionCount = sizeof(aliasBindingDesc) / sizeof(aliasBindingDesc[0]);
+
+	// textured particles: one instance per particle, origin followed by palette index and alpha bytes
+	VK_VERTINFO(RGB_RGBA8UI, sizeof(float) * 4,	VK_INPUTATTR_DESC(0, VK_FORMAT_R32G32B32_SFLOAT, 0),
+												VK_INPUTATTR_DESC(1, VK_FORMAT_R8G8B8A8_UINT, sizeof(float) * 3));
+	RGB_RGBA8UIbindingDesc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
 	// no vertices passed to the pipeline (postprocessing)
 	VkPipelineVertexInputStateCreateInfo vertInfoNull = VK_NULL_VERTEXINPUT_CINF;
 
 	// shared descriptor set layouts
 	VkDescriptorSetLayout samplerUboDsLayouts[] = { vk_samplerDescSetLayout, vk_uboDescSetLayout };
 	VkDescriptorSetLayout samplerUboLmapDsLayouts[] = { vk_samplerDescSetLayout, vk_uboDescSetLayout, vk_samplerLightmapDescSetLayout };
+	VkDescriptorSetLayout samplerUboStorageDsLayouts[] = { vk_samplerDescSetLayout, vk_uboDescSetLayout, vk_storageDescSetLayout };
+	VkDescriptorSetLayout samplerUboLmapStorageDsLayouts[] = { vk_samplerDescSetLayout, vk_uboDescSetLayout, vk_samplerLightmapDescSetLayout, vk_storageDescSetLayout };
 
 	// shader array (vertex and fragment, no compute... yet)
 	qvkshader_t shaders[2] = { 0, 0 };
@@ -1184,6 +1510,18 @@ static void CreatePipelines()
 		.offset = 0,
 		.size = 16 * sizeof(float)
 	};
+	// alias model push constant: view-projection matrix followed by the frame lerp (move, front and back scales)
+	VkPushConstantRange pushConstantRangeAlias = {
+		.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+		.offset = 0,
+		.size = 28 * sizeof(float)
+	};
+	// textured particle push constant: view-projection matrix followed by the billboard axes and the view origin and direction
+	VkPushConstantRange pushConstantRangeParticle = {
+		.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+		.offset = 0,
+		.size = 32 * sizeof(float)
+	};
 	// underwater world warp effect push constant
 	VkPushConstantRange pushConstantRangeWorldWarpFrag = {
 		.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
@@ -1207,7 +1545,7 @@ static void CreatePipelines()
 	// draw particles pipeline (using a texture)
 	VK_LOAD_VERTFRAG_SHADERS(shaders, particle, basic);
 	vk_drawParticlesPipeline.blendOpts.blendEnable = VK_TRUE;
-	QVk_CreatePipeline(&vk_samplerDescSetLayout, 1, &vertInfoRGB_RGBA_RG, &vk_drawParticlesPipeline, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
+	QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA8UI, &vk_drawParticlesPipeline, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeParticle);
 	QVk_DebugSetObjectName((uint64_t)vk_drawParticlesPipeline.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: textured particles");
 	QVk_DebugSetObjectName((uint64_t)vk_drawParticlesPipeline.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: textured particles");
 
@@ -1215,7 +1553,7 @@ static void CreatePipelines()
 	VK_LOAD_VERTFRAG_SHADERS(shaders, point_particle, point_particle);
 	vk_drawPointParticlesPipeline.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
 	vk_drawPointParticlesPipeline.blendOpts.blendEnable = VK_TRUE;
-	QVk_CreatePipeline(&vk_uboDescSetLayout, 1, &vertInfoRGB_RGBA, &vk_drawPointParticlesPipeline, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
+	QVk_CreatePipeline(&vk_uboDescSetLayout, 1, &vertInfoRGB_RGBA8, &vk_drawPointParticlesPipeline, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
 	QVk_DebugSetObjectName((uint64_t)vk_drawPointParticlesPipeline.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: point particles");
 	QVk_DebugSetObjectName((uint64_t)vk_drawPointParticlesPipeline.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: point particles");
 
@@ -1244,48 +1582,27 @@ static void CreatePipelines()
 	VK_LOAD_VERTFRAG_SHADERS(shaders, model, model);
 	for (int i = 0; i < 2; ++i)
 	{
-		vk_drawModelPipelineStrip[i].topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
-		vk_drawModelPipelineStrip[i].blendOpts.blendEnable = VK_TRUE;
-		QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA_RG, &vk_drawModelPipelineStrip[i], &vk_renderpasses[i], shaders, 2, &pushConstantRangeMatrix);
-
 		vk_drawModelPipelineFan[i].topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 		vk_drawModelPipelineFan[i].blendOpts.blendEnable = VK_TRUE;
-		QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA_RG, &vk_drawModelPipelineFan[i], &vk_renderpasses[i], shaders, 2, &pushConstantRangeMatrix);
+		QVk_CreatePipeline(samplerUboStorageDsLayouts, 3, &vertInfoAlias, &vk_drawModelPipelineFan[i], &vk_renderpasses[i], shaders, 2, &pushConstantRangeAlias);
 	}
-	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineStrip[0].layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: draw model: strip (RP_WORLD)");
-	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineStrip[0].pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: draw model: strip (RP_WORLD)");
-	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineStrip[1].layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: draw model: strip (RP_UI)");
-	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineStrip[1].pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: draw model: strip (RP_UI)");
 	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineFan[0].layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: draw model: fan (RP_WORLD)");
 	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineFan[0].pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: draw model: fan (RP_WORLD)");
 	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineFan[1].layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: draw model: fan (RP_UI)");
 	QVk_DebugSetObjectName((uint64_t)vk_drawModelPipelineFan[1].pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: draw model: fan (RP_UI)");
 
 	// dedicated model pipelines for translucent objects with depth write disabled
-	vk_drawNoDepthModelPipelineStrip.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
-	vk_drawNoDepthModelPipelineStrip.depthWriteEnable = VK_FALSE;
-	vk_drawNoDepthModelPipelineStrip.blendOpts.blendEnable = VK_TRUE;
-	QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA_RG, &vk_drawNoDepthModelPipelineStrip, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
-	QVk_DebugSetObjectName((uint64_t)vk_drawNoDepthModelPipelineStrip.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: translucent model: strip");
-	QVk_DebugSetObjectName((uint64_t)vk_drawNoDepthModelPipelineStrip.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: translucent model: strip");
-
 	vk_drawNoDepthModelPipelineFan.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	vk_drawNoDepthModelPipelineFan.depthWriteEnable = VK_FALSE;
 	vk_drawNoDepthModelPipelineFan.blendOpts.blendEnable = VK_TRUE;
-	QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA_RG, &vk_drawNoDepthModelPipelineFan, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
+	QVk_CreatePipeline(samplerUboStorageDsLayouts, 3, &vertInfoAlias, &vk_drawNoDepthModelPipelineFan, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeAlias);
 	QVk_DebugSetObjectName((uint64_t)vk_drawNoDepthModelPipelineFan.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: translucent model: fan");
 	QVk_DebugSetObjectName((uint64_t)vk_drawNoDepthModelPipelineFan.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: translucent model: fan");
 
 	// dedicated model pipelines for when left-handed weapon model is drawn
-	vk_drawLefthandModelPipelineStrip.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
-	vk_drawLefthandModelPipelineStrip.cullMode = VK_CULL_MODE_FRONT_BIT;
-	QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA_RG, &vk_drawLefthandModelPipelineStrip, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
-	QVk_DebugSetObjectName((uint64_t)vk_drawLefthandModelPipelineStrip.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: left-handed model: strip");
-	QVk_DebugSetObjectName((uint64_t)vk_drawLefthandModelPipelineStrip.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: left-handed model: strip");
-
 	vk_drawLefthandModelPipelineFan.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	vk_drawLefthandModelPipelineFan.cullMode = VK_CULL_MODE_FRONT_BIT;
-	QVk_CreatePipeline(samplerUboDsLayouts, 2, &vertInfoRGB_RGBA_RG, &vk_drawLefthandModelPipelineFan, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
+	QVk_CreatePipeline(samplerUboStorageDsLayouts, 3, &vertInfoAlias, &vk_drawLefthandModelPipelineFan, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeAlias);
 	QVk_DebugSetObjectName((uint64_t)vk_drawLefthandModelPipelineFan.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: left-handed model: fan");
 	QVk_DebugSetObjectName((uint64_t)vk_drawLefthandModelPipelineFan.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: left-handed model: fan");
 
@@ -1307,7 +1624,7 @@ static void CreatePipelines()
 	// draw lightmapped polygon
 	VK_LOAD_VERTFRAG_SHADERS(shaders, polygon_lmap, polygon_lmap);
 	vk_drawPolyLmapPipeline.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	QVk_CreatePipeline(samplerUboLmapDsLayouts, 3, &vertInfoRGB_RG_RG, &vk_drawPolyLmapPipeline, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
+	QVk_CreatePipeline(samplerUboLmapStorageDsLayouts, 4, &vertInfoRGB_RG_RG_R_RGBA8UI, &vk_drawPolyLmapPipeline, &vk_renderpasses[RP_WORLD], shaders, 2, &pushConstantRangeMatrix);
 	QVk_DebugSetObjectName((uint64_t)vk_drawPolyLmapPipeline.layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Pipeline Layout: lightmapped polygon");
 	QVk_DebugSetObjectName((uint64_t)vk_drawPolyLmapPipeline.pl, VK_OBJECT_TYPE_PIPELINE, "Pipeline: lightmapped polygon");
 
@@ -1409,14 +1726,11 @@ void QVk_Shutdown( void )
 		for (int i = 0; i < 2; ++i)
 		{
 			QVk_DestroyPipeline(&vk_drawColorQuadPipeline[i]);
-			QVk_DestroyPipeline(&vk_drawModelPipelineStrip[i]);
 			QVk_DestroyPipeline(&vk_drawModelPipelineFan[i]);
 		}
 		QVk_DestroyPipeline(&vk_drawTexQuadPipeline);
 		QVk_DestroyPipeline(&vk_drawNullModelPipeline);
-		QVk_DestroyPipeline(&vk_drawNoDepthModelPipelineStrip);
 		QVk_DestroyPipeline(&vk_drawNoDepthModelPipelineFan);
-		QVk_DestroyPipeline(&vk_drawLefthandModelPipelineStrip);
 		QVk_DestroyPipeline(&vk_drawLefthandModelPipelineFan);
 		QVk_DestroyPipeline(&vk_drawParticlesPipeline);
 		QVk_DestroyPipeline(&vk_drawPointParticlesPipeline);
@@ -1432,26 +1746,31 @@ void QVk_Shutdown( void )
 		QVk_DestroyPipeline(&vk_shadowsPipelineFan);
 		QVk_DestroyPipeline(&vk_worldWarpPipeline);
 		QVk_DestroyPipeline(&vk_postprocessPipeline);
+		QVk_DestroyPipelineCache();
 		QVk_FreeBuffer(&vk_texRectVbo);
 		QVk_FreeBuffer(&vk_colorRectVbo);
 		QVk_FreeBuffer(&vk_rectIbo);
-		for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+		QVk_FreeBuffer(&vk_aliasTablesSbo);
+		if (vk_triangleFanIbo.buffer != VK_NULL_HANDLE)
+			QVk_FreeBuffer(&vk_triangleFanIbo);
+		memset(&vk_triangleFanIbo, 0, sizeof(vk_triangleFanIbo));
+		for (int i = 0; i < NUM_SWAPBUFFER_SLOTS; ++i)
+		{
+			for (int j = 0; j < vk_swapBuffersCnt[i]; ++j)
+				QVk_FreeBuffer(&vk_swapBuffers[i][j]);
+			free(vk_swapBuffers[i]);
+			vk_swapBuffers[i] = NULL;
+			vk_swapBuffersCnt[i] = 0;
+			// textures released since the last frames still hold their descriptor sets
+			for (int j = 0; j < vk_swapTexturesCnt[i]; ++j)
+				QVk_DestroyTexture(&vk_swapTextures[i][j]);
+			free(vk_swapTextures[i]);
+			vk_swapTextures[i] = NULL;
+			vk_swapTexturesCnt[i] = 0;
+		}
+		DestroyDynamicBuffers();
+		for (int i = 0; i < vk_numStagingBuffers; ++i)
 		{
-			if (vk_dynUniformBuffers[i].buffer != VK_NULL_HANDLE)
-			{
-				vmaUnmapMemory(vk_malloc, vk_dynUniformBuffers[i].allocation);
-				QVk_FreeBuffer(&vk_dynUniformBuffers[i]);
-			}
-			if (vk_dynIndexBuffers[i].buffer != VK_NULL_HANDLE)
-			{
-				vmaUnmapMemory(vk_malloc, vk_dynIndexBuffers[i].allocation);
-				QVk_FreeBuffer(&vk_dynIndexBuffers[i]);
-			}
-			if (vk_dynVertexBuffers[i].buffer != VK_NULL_HANDLE)
-			{
-				vmaUnmapMemory(vk_malloc, vk_dynVertexBuffers[i].allocation);
-				QVk_FreeBuffer(&vk_dynVertexBuffers[i]);
-			}
 			if (vk_stagingBuffers[i].buffer.buffer != VK_NULL_HANDLE)
 			{
 				vmaUnmapMemory(vk_malloc, vk_stagingBuffers[i].buffer.allocation);
@@ -1463,7 +1782,9 @@ void QVk_Shutdown( void )
 				vkDestroyCommandPool(vk_device.logical, vk_stagingCommandPool[i], NULL);
 				vk_stagingCommandPool[i] = VK_NULL_HANDLE;
 			}
+			memset(&vk_stagingBuffers[i], 0, sizeof(qvkstagingbuffer_t));
 		}
+		vk_numStagingBuffers = 0;
 		if (vk_descriptorPool != VK_NULL_HANDLE)
 			vkDestroyDescriptorPool(vk_device.logical, vk_descriptorPool, NULL);
 		if (vk_uboDescSetLayout != VK_NULL_HANDLE)
@@ -1472,6 +1793,8 @@ void QVk_Shutdown( void )
 			vkDestroyDescriptorSetLayout(vk_device.logical, vk_samplerDescSetLayout, NULL);
 		if (vk_samplerLightmapDescSetLayout != VK_NULL_HANDLE)
 			vkDestroyDescriptorSetLayout(vk_device.logical, vk_samplerLightmapDescSetLayout, NULL);
+		if (vk_storageDescSetLayout != VK_NULL_HANDLE)
+			vkDestroyDescriptorSetLayout(vk_device.logical, vk_storageDescSetLayout, NULL);
 		for (int i = 0; i < RP_COUNT; i++)
 		{
 			if (vk_renderpasses[i].rp != VK_NULL_HANDLE)
@@ -1517,6 +1840,11 @@ void QVk_Shutdown( void )
 			vkDestroySemaphore(vk_device.logical, vk_imageAvailableSemaphores[i], NULL);
 			vkDestroySemaphore(vk_device.logical, vk_renderFinishedSemaphores[i], NULL);
 			vkDestroyFence(vk_device.logical, vk_fences[i], NULL);
+			if (vk_timestampPools[i] != VK_NULL_HANDLE)
+			{
+				vkDestroyQueryPool(vk_device.logical, vk_timestampPools[i], NULL);
+				vk_timestampPools[i] = VK_NULL_HANDLE;
+			}
 		}
 		if (vk_malloc != VK_NULL_HANDLE)
 			vmaDestroyAllocator(vk_malloc);
@@ -1533,6 +1861,8 @@ void QVk_Shutdown( void )
 		vk_uboDescSetLayout = VK_NULL_HANDLE;
 		vk_samplerDescSetLayout = VK_NULL_HANDLE;
 		vk_samplerLightmapDescSetLayout = VK_NULL_HANDLE;
+		vk_storageDescSetLayout = VK_NULL_HANDLE;
+		vk_aliasTablesDescSet = VK_NULL_HANDLE;
 		vk_transferCommandPool = VK_NULL_HANDLE;
 		vk_activeBufferIdx = 0;
 		vk_imageIndex = 0;
@@ -1580,12 +1910,15 @@ qboolean QVk_Init()
 	vk_config.vertex_buffer_usage  = 0;
 	vk_config.vertex_buffer_max_usage = 0;
 	vk_config.vertex_buffer_size   = VERTEX_BUFFER_SIZE;
+	vk_config.vertex_buffer_pages  = 0;
 	vk_config.index_buffer_usage   = 0;
 	vk_config.index_buffer_max_usage = 0;
 	vk_config.index_buffer_size    = INDEX_BUFFER_SIZE;
+	vk_config.index_buffer_pages   = 0;
 	vk_config.uniform_buffer_usage = 0;
 	vk_config.uniform_buffer_max_usage = 0;
 	vk_config.uniform_buffer_size  = UNIFORM_BUFFER_SIZE;
+	vk_config.uniform_buffer_pages = 0;
 	vk_config.triangle_fan_index_usage = 0;
 	vk_config.triangle_fan_index_max_usage = 0;
 	vk_config.triangle_fan_index_count = TRIANGLE_FAN_INDEX_CNT;
@@ -1810,6 +2143,9 @@ qboolean QVk_Init()
 	}
 	ri.Con_Printf(PRINT_ALL, "...created synchronization objects\n");
 
+	// setup profiler queries
+	CreateTimestampQueries();
+
 	// setup render passes
 	for (int i = 0; i < RP_COUNT; ++i)
 	{
@@ -1917,9 +2253,14 @@ qboolean QVk_Init()
 	CreateDynamicBuffers();
 	// create staging buffers
 	CreateStagingBuffers();
-	// assign a dynamic index buffer for triangle fan emulation
+	// create the static index buffer for triangle fan emulation
 	RebuildTriangleFanIndexBuffer();
+	// the pipeline cache from the previous run makes this mostly a lookup
+	int pipelineStart = Sys_Milliseconds();
+	QVk_CreatePipelineCache();
 	CreatePipelines();
+	vk_config.pipeline_creation_time = Sys_Milliseconds() - pipelineStart;
+	ri.Con_Printf(PRINT_ALL, "...created pipelines in %d ms\n", vk_config.pipeline_creation_time);
 	CreateSamplers();
 
 	// main and world warp color buffers will be sampled for postprocessing effects, so they need descriptors and samplers
@@ -1948,8 +2289,7 @@ VkResult QVk_BeginFrame()
 	// reset tracking variables
 	vk_state.current_pipeline = VK_NULL_HANDLE;
 	vk_config.vertex_buffer_usage  = 0;
-	// triangle fan index buffer data will not be cleared between frames unless the buffer itself is too small
-	vk_config.index_buffer_usage   = vk_triangleFanIboUsage;
+	vk_config.index_buffer_usage   = 0;
 	vk_config.uniform_buffer_usage = 0;
 	vk_config.triangle_fan_index_usage = 0;
 
@@ -2013,19 +2353,28 @@ VkResult QVk_BeginFrame()
 
 	vk_activeCmdbuffer = vk_commandbuffers[vk_activeBufferIdx];
 
-	// swap dynamic buffers
+	// swap dynamic buffers and rewind the pages the frame used last time around
 	vk_activeDynBufferIdx = (vk_activeDynBufferIdx + 1) % NUM_DYNBUFFERS;
-	vk_dynUniformBuffers[vk_activeDynBufferIdx].currentOffset = 0;
-	vk_dynVertexBuffers[vk_activeDynBufferIdx].currentOffset = 0;
-	// triangle fan index data is placed in the beginning of the buffer
-	vk_dynIndexBuffers[vk_activeDynBufferIdx].currentOffset = vk_triangleFanIboUsage;
-	vmaInvalidateAllocation(vk_malloc, vk_dynUniformBuffers[vk_activeDynBufferIdx].allocation, 0, VK_WHOLE_SIZE);
-	vmaInvalidateAllocation(vk_malloc, vk_dynVertexBuffers[vk_activeDynBufferIdx].allocation, 0, VK_WHOLE_SIZE);
-	vmaInvalidateAllocation(vk_malloc, vk_dynIndexBuffers[vk_activeDynBufferIdx].allocation, 0, VK_WHOLE_SIZE);
+	for (int type = 0; type < DYNBUFFER_COUNT; ++type)
+	{
+		qvkdynring_t *ring = &vk_dynRings[type][vk_activeDynBufferIdx];
+
+		for (int page = 0; page <= ring->activePage; ++page)
+		{
+			ring->pages[page].currentOffset = 0;
+			vmaInvalidateAllocation(vk_malloc, ring->pages[page].allocation, 0, VK_WHOLE_SIZE);
+		}
+		ring->activePage = 0;
+		ring->usage = 0;
+	}
 
 	VK_VERIFY(vkWaitForFences(vk_device.logical, 1, &vk_fences[vk_activeBufferIdx], VK_TRUE, UINT32_MAX));
 	VK_VERIFY(vkResetFences(vk_device.logical, 1, &vk_fences[vk_activeBufferIdx]));
 
+	// the GPU is done with this command buffer's previous frame, so its profiler results are complete
+	CollectFrameStats(vk_activeBufferIdx);
+	vk_recordStats = &vk_frameStats[vk_activeBufferIdx];
+
 	// setup command buffers and render pass for drawing
 	VkCommandBufferBeginInfo beginInfo = {
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -2043,6 +2392,11 @@ VkResult QVk_BeginFrame()
 	vkCmdSetViewport(vk_commandbuffers[vk_activeBufferIdx], 0, 1, &vk_viewport);
 	vkCmdSetScissor(vk_commandbuffers[vk_activeBufferIdx], 0, 1, &vk_scissor);
 
+	// queries have to be reset outside of a render pass
+	vk_writeTimestamps = vk_timestampValidMask && (vk_profile->value || vk_profilecsv->value);
+	if (vk_writeTimestamps)
+		vkCmdResetQueryPool(vk_commandbuffers[vk_activeBufferIdx], vk_timestampPools[vk_activeBufferIdx], 0, RP_COUNT * 2);
+
 	vk_frameStarted = true;
 	return VK_SUCCESS;
 }
@@ -2062,11 +2416,15 @@ VkResult QVk_EndFrame(qboolean force)
 
 	// submit
 	QVk_SubmitStagingBuffers();
-	vmaFlushAllocation(vk_malloc, vk_dynUniformBuffers[vk_activeDynBufferIdx].allocation, 0, VK_WHOLE_SIZE);
-	vmaFlushAllocation(vk_malloc, vk_dynVertexBuffers[vk_activeDynBufferIdx].allocation, 0, VK_WHOLE_SIZE);
-	vmaFlushAllocation(vk_malloc, vk_dynIndexBuffers[vk_activeDynBufferIdx].allocation, 0, VK_WHOLE_SIZE);
+	for (int type = 0; type < DYNBUFFER_COUNT; ++type)
+	{
+		qvkdynring_t *ring = &vk_dynRings[type][vk_activeDynBufferIdx];
 
-	vkCmdEndRenderPass(vk_commandbuffers[vk_activeBufferIdx]);
+		for (int page = 0; page <= ring->activePage; ++page)
+			vmaFlushAllocation(vk_malloc, ring->pages[page].allocation, 0, VK_WHOLE_SIZE);
+	}
+
+	QVk_EndRenderpass();
 	QVk_DebugLabelEnd(&vk_commandbuffers[vk_activeBufferIdx]);
 	VK_VERIFY(vkEndCommandBuffer(vk_commandbuffers[vk_activeBufferIdx]));
 
@@ -2178,9 +2536,21 @@ void QVk_BeginRenderpass(qvkrenderpasstype_t rpType)
 	}
 #endif
 
+	WriteTimestamp(rpType * 2, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+	vk_activeRenderpass = rpType;
+	vk_renderpassStart = ProfileTime();
+
 	vkCmdBeginRenderPass(vk_commandbuffers[vk_activeBufferIdx], &renderBeginInfo[rpType], VK_SUBPASS_CONTENTS_INLINE);
 }
 
+void QVk_EndRenderpass()
+{
+	vkCmdEndRenderPass(vk_commandbuffers[vk_activeBufferIdx]);
+
+	WriteTimestamp(vk_activeRenderpass * 2 + 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	vk_recordStats->cpuTime[vk_activeRenderpass] += (float)(ProfileTime() - vk_renderpassStart);
+}
+
 void QVk_RecreateSwapchain()
 {
 	vkDeviceWaitIdle( vk_device.logical );
@@ -2198,85 +2568,84 @@ void QVk_RecreateSwapchain()
 	VK_VERIFY(CreateFramebuffers());
 }
 
-uint8_t *QVk_GetVertexBuffer(VkDeviceSize size, VkBuffer *dstBuffer, VkDeviceSize *dstOffset)
+// internal helper
+// hands out size bytes from the active frame's ring, reserve bytes have to fit in the page from the returned offset on
+static uint8_t *DynamicBufferAlloc(qvkdynbuffertype_t type, VkDeviceSize size, VkDeviceSize reserve, int *dstPage, VkDeviceSize *dstOffset)
 {
-	if (vk_dynVertexBuffers[vk_activeDynBufferIdx].currentOffset + size > vk_config.vertex_buffer_size)
-	{
-		vk_config.vertex_buffer_size = max(vk_config.vertex_buffer_size * BUFFER_RESIZE_FACTOR, NextPow2(size));
+	qvkdynring_t *ring = &vk_dynRings[type][vk_activeDynBufferIdx];
+	qvkbuffer_t *page = &ring->pages[ring->activePage];
 
-		ri.Con_Printf(PRINT_ALL, "Resizing dynamic vertex buffer to %ukB\n", vk_config.vertex_buffer_size / 1024);
-		int swapBufferOffset = vk_swapBuffersCnt[vk_activeSwapBufferIdx];
-		vk_swapBuffersCnt[vk_activeSwapBufferIdx] += NUM_DYNBUFFERS;
-
-		if (vk_swapBuffers[vk_activeSwapBufferIdx] == NULL)
-			vk_swapBuffers[vk_activeSwapBufferIdx] = malloc(sizeof(qvkbuffer_t) * vk_swapBuffersCnt[vk_activeSwapBufferIdx]);
-		else
-			vk_swapBuffers[vk_activeSwapBufferIdx] = realloc(vk_swapBuffers[vk_activeSwapBufferIdx], sizeof(qvkbuffer_t) * vk_swapBuffersCnt[vk_activeSwapBufferIdx]);
-
-		for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+	if (page->currentOffset + reserve > ring->pageSizes[ring->activePage])
+	{
+		// move on to the next page, skipping any that are too small for this request
+		do
 		{
-			vk_swapBuffers[vk_activeSwapBufferIdx][swapBufferOffset + i] = vk_dynVertexBuffers[i];
-			vmaUnmapMemory(vk_malloc, vk_dynVertexBuffers[i].allocation);
+			ring->activePage++;
+			if (ring->activePage == ring->numPages)
+			{
+				VkDeviceSize pageSize = max(vk_dynPageSizes[type], NextPow2(reserve));
 
-			QVk_CreateVertexBuffer(NULL, vk_config.vertex_buffer_size, &vk_dynVertexBuffers[i], NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
-			VK_VERIFY(vmaMapMemory(vk_malloc, vk_dynVertexBuffers[i].allocation, &vk_dynVertexBuffers[i].allocInfo.pMappedData));
+				// grow every ring at once so that the other frames in flight don't hitch on the same load again
+				for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+				{
+					if (vk_dynRings[type][i].numPages == ring->activePage)
+						CreateDynamicPage(type, i, pageSize);
+				}
 
-			QVk_DebugSetObjectName((uint64_t)vk_dynVertexBuffers[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Vertex Buffer #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_dynVertexBuffers[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Vertex Buffer #%d", i));
-		}
+				ri.Con_Printf(PRINT_DEVELOPER, "Adding %ukB page to dynamic %s buffers\n", (uint32_t)(pageSize / 1024), vk_dynBufferNames[type]);
+			}
+		} while (reserve > ring->pageSizes[ring->activePage]);
+
+		page = &ring->pages[ring->activePage];
+		page->currentOffset = 0;
 	}
 
-	*dstOffset = vk_dynVertexBuffers[vk_activeDynBufferIdx].currentOffset;
-	*dstBuffer = vk_dynVertexBuffers[vk_activeDynBufferIdx].buffer;
-	vk_dynVertexBuffers[vk_activeDynBufferIdx].currentOffset += size;
+	*dstPage = ring->activePage;
+	*dstOffset = page->currentOffset;
+	page->currentOffset += size;
+	ring->usage += size;
 
-	vk_config.vertex_buffer_usage = vk_dynVertexBuffers[vk_activeDynBufferIdx].currentOffset;
-	if (vk_config.vertex_buffer_max_usage < vk_config.vertex_buffer_usage)
-		vk_config.vertex_buffer_max_usage = vk_config.vertex_buffer_usage;
-	
-	return (uint8_t *)vk_dynVertexBuffers[vk_activeDynBufferIdx].allocInfo.pMappedData + (*dstOffset);
+	return (uint8_t *)page->allocInfo.pMappedData + (*dstOffset);
 }
 
-uint8_t *QVk_GetIndexBuffer(VkDeviceSize size, VkDeviceSize *dstOffset)
+// internal helper
+static void UpdateDynamicBufferStats(qvkdynbuffertype_t type, uint32_t *usage, uint32_t *maxUsage, uint32_t *size, uint32_t *pages)
 {
-	// align to 4 bytes, so that we can reuse the buffer for both VK_INDEX_TYPE_UINT16 and VK_INDEX_TYPE_UINT32
-	const int align_mod = size % 4;
-	const uint32_t aligned_size = ((size % 4) == 0) ? size : (size + 4 - align_mod);
-
-	if (vk_dynIndexBuffers[vk_activeDynBufferIdx].currentOffset + aligned_size > vk_config.index_buffer_size)
-	{
-		vk_config.index_buffer_size = max(vk_config.index_buffer_size * BUFFER_RESIZE_FACTOR, NextPow2(size));
+	const qvkdynring_t *ring = &vk_dynRings[type][vk_activeDynBufferIdx];
 
-		ri.Con_Printf(PRINT_ALL, "Resizing dynamic index buffer to %ukB\n", vk_config.index_buffer_size / 1024);
-		int swapBufferOffset = vk_swapBuffersCnt[vk_activeSwapBufferIdx];
-		vk_swapBuffersCnt[vk_activeSwapBufferIdx] += NUM_DYNBUFFERS;
+	*usage = ring->usage;
+	if (*maxUsage < *usage)
+		*maxUsage = *usage;
 
-		if (vk_swapBuffers[vk_activeSwapBufferIdx] == NULL)
-			vk_swapBuffers[vk_activeSwapBufferIdx] = malloc(sizeof(qvkbuffer_t) * vk_swapBuffersCnt[vk_activeSwapBufferIdx]);
-		else
-			vk_swapBuffers[vk_activeSwapBufferIdx] = realloc(vk_swapBuffers[vk_activeSwapBufferIdx], sizeof(qvkbuffer_t) * vk_swapBuffersCnt[vk_activeSwapBufferIdx]);
+	*size = 0;
+	for (int i = 0; i < ring->numPages; ++i)
+		*size += ring->pageSizes[i];
+	*pages = ring->numPages;
+}
 
-		for (int i = 0; i < NUM_DYNBUFFERS; ++i)
-		{
-			vk_swapBuffers[vk_activeSwapBufferIdx][swapBufferOffset + i] = vk_dynIndexBuffers[i];
-			vmaUnmapMemory(vk_malloc, vk_dynIndexBuffers[i].allocation);
+uint8_t *QVk_GetVertexBuffer(VkDeviceSize size, VkBuffer *dstBuffer, VkDeviceSize *dstOffset)
+{
+	int page;
+	uint8_t *data = DynamicBufferAlloc(DYNBUFFER_VERTEX, size, size, &page, dstOffset);
 
-			QVk_CreateIndexBuffer(NULL, vk_config.index_buffer_size, &vk_dynIndexBuffers[i], NULL, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
-			VK_VERIFY(vmaMapMemory(vk_malloc, vk_dynIndexBuffers[i].allocation, &vk_dynIndexBuffers[i].allocInfo.pMappedData));
+	*dstBuffer = vk_dynRings[DYNBUFFER_VERTEX][vk_activeDynBufferIdx].pages[page].buffer;
+	UpdateDynamicBufferStats(DYNBUFFER_VERTEX, &vk_config.vertex_buffer_usage, &vk_config.vertex_buffer_max_usage, &vk_config.vertex_buffer_size, &vk_config.vertex_buffer_pages);
 
-			QVk_DebugSetObjectName((uint64_t)vk_dynIndexBuffers[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Index Buffer #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_dynIndexBuffers[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Index Buffer #%d", i));
-		}
-	}
+	return data;
+}
 
-	*dstOffset = vk_dynIndexBuffers[vk_activeDynBufferIdx].currentOffset;
-	vk_dynIndexBuffers[vk_activeDynBufferIdx].currentOffset += aligned_size;
+uint8_t *QVk_GetIndexBuffer(VkDeviceSize size, VkBuffer *dstBuffer, VkDeviceSize *dstOffset)
+{
+	// align to 4 bytes, so that we can reuse the buffer for both VK_INDEX_TYPE_UINT16 and VK_INDEX_TYPE_UINT32
+	const int align_mod = size % 4;
+	const uint32_t aligned_size = ((size % 4) == 0) ? size : (size + 4 - align_mod);
+	int page;
+	uint8_t *data = DynamicBufferAlloc(DYNBUFFER_INDEX, aligned_size, aligned_size, &page, dstOffset);
 
-	vk_config.index_buffer_usage = vk_dynIndexBuffers[vk_activeDynBufferIdx].currentOffset;
-	if (vk_config.index_buffer_max_usage < vk_config.index_buffer_usage)
-		vk_config.index_buffer_max_usage = vk_config.index_buffer_usage;
+	*dstBuffer = vk_dynRings[DYNBUFFER_INDEX][vk_activeDynBufferIdx].pages[page].buffer;
+	UpdateDynamicBufferStats(DYNBUFFER_INDEX, &vk_config.index_buffer_usage, &vk_config.index_buffer_max_usage, &vk_config.index_buffer_size, &vk_config.index_buffer_pages);
 
-	return (uint8_t *)vk_dynIndexBuffers[vk_activeDynBufferIdx].allocInfo.pMappedData + (*dstOffset);
+	return data;
 }
 
 uint8_t *QVk_GetUniformBuffer(VkDeviceSize size, uint32_t *dstOffset, VkDescriptorSet *dstUboDescriptorSet)
@@ -2284,52 +2653,40 @@ uint8_t *QVk_GetUniformBuffer(VkDeviceSize size, uint32_t *dstOffset, VkDescript
 	// 0x100 alignment is required by Vulkan spec
 	const int align_mod = size % 256;
 	const uint32_t aligned_size = ((size % 256) == 0) ? size : (size + 256 - align_mod);
+	int page;
+	VkDeviceSize offset;
+	// the descriptor always covers UNIFORM_ALLOC_SIZE bytes from the dynamic offset
+	uint8_t *data = DynamicBufferAlloc(DYNBUFFER_UNIFORM, aligned_size, max(aligned_size, UNIFORM_ALLOC_SIZE), &page, &offset);
 
-	if (vk_dynUniformBuffers[vk_activeDynBufferIdx].currentOffset + UNIFORM_ALLOC_SIZE > vk_config.uniform_buffer_size)
-	{
-		vk_config.uniform_buffer_size = max(vk_config.uniform_buffer_size * BUFFER_RESIZE_FACTOR, NextPow2(size));
-
-		ri.Con_Printf(PRINT_ALL, "Resizing dynamic uniform buffer to %ukB\n", vk_config.uniform_buffer_size / 1024);
-		int swapBufferOffset   = vk_swapBuffersCnt[vk_activeSwapBufferIdx];
-		int swapDescSetsOffset = vk_swapDescSetsCnt[vk_activeSwapBufferIdx];
-		vk_swapBuffersCnt[vk_activeSwapBufferIdx]  += NUM_DYNBUFFERS;
-		vk_swapDescSetsCnt[vk_activeSwapBufferIdx] += NUM_DYNBUFFERS;
-
-		if (vk_swapBuffers[vk_activeSwapBufferIdx] == NULL)
-			vk_swapBuffers[vk_activeSwapBufferIdx] = malloc(sizeof(qvkbuffer_t) * vk_swapBuffersCnt[vk_activeSwapBufferIdx]);
-		else
-			vk_swapBuffers[vk_activeSwapBufferIdx] = realloc(vk_swapBuffers[vk_activeSwapBufferIdx], sizeof(qvkbuffer_t) * vk_swapBuffersCnt[vk_activeSwapBufferIdx]);
-
-		if (vk_swapDescriptorSets[vk_activeSwapBufferIdx] == NULL)
-			vk_swapDescriptorSets[vk_activeSwapBufferIdx] = malloc(sizeof(VkDescriptorSet) * vk_swapDescSetsCnt[vk_activeSwapBufferIdx]);
-		else
-			vk_swapDescriptorSets[vk_activeSwapBufferIdx] = realloc(vk_swapDescriptorSets[vk_activeSwapBufferIdx], sizeof(VkDescriptorSet) * vk_swapDescSetsCnt[vk_activeSwapBufferIdx]);
+	*dstOffset = (uint32_t)offset;
+	*dstUboDescriptorSet = vk_dynRings[DYNBUFFER_UNIFORM][vk_activeDynBufferIdx].descriptorSets[page];
+	UpdateDynamicBufferStats(DYNBUFFER_UNIFORM, &vk_config.uniform_buffer_usage, &vk_config.uniform_buffer_max_usage, &vk_config.uniform_buffer_size, &vk_config.uniform_buffer_pages);
 
-		for (int i = 0; i < NUM_DYNBUFFERS; ++i)
-		{
-			vk_swapBuffers[vk_activeSwapBufferIdx][swapBufferOffset + i] = vk_dynUniformBuffers[i];
-			vk_swapDescriptorSets[vk_activeSwapBufferIdx][swapDescSetsOffset + i] = vk_uboDescriptorSets[i];;
-			vmaUnmapMemory(vk_malloc, vk_dynUniformBuffers[i].allocation);
+	return data;
+}
 
-			VK_VERIFY(QVk_CreateUniformBuffer(vk_config.uniform_buffer_size, &vk_dynUniformBuffers[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT));
-			VK_VERIFY(vmaMapMemory(vk_malloc, vk_dynUniformBuffers[i].allocation, &vk_dynUniformBuffers[i].allocInfo.pMappedData));
-			CreateUboDescriptorSet(&vk_uboDescriptorSets[i], vk_dynUniformBuffers[i].buffer);
+/*
+** QVk_UpdateLightStyles
+**
+** Writes this frame's lightstyle colours for the lightmapped polygon shader.
+*/
+void QVk_UpdateLightStyles(const float scales[][3], int count)
+{
+	qvkbuffer_t *sbo = &vk_lightStyleSbo[vk_activeDynBufferIdx];
+	float *dst = (float *)sbo->allocInfo.pMappedData;
 
-			QVk_DebugSetObjectName((uint64_t)vk_uboDescriptorSets[i], VK_OBJECT_TYPE_DESCRIPTOR_SET, va("Dynamic UBO Descriptor Set #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_dynUniformBuffers[i].buffer, VK_OBJECT_TYPE_BUFFER, va("Dynamic Uniform Buffer #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_dynUniformBuffers[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Dynamic Uniform Buffer #%d", i));
-		}
+	for (int i = 0; i < count && i < MAX_LIGHTSTYLES; ++i, dst += 4)
+	{
+		VectorCopy(scales[i], dst);
+		dst[3] = 0.f;
 	}
 
-	*dstOffset = vk_dynUniformBuffers[vk_activeDynBufferIdx].currentOffset;
-	*dstUboDescriptorSet = vk_uboDescriptorSets[vk_activeDynBufferIdx];
-	vk_dynUniformBuffers[vk_activeDynBufferIdx].currentOffset += aligned_size;
-
-	vk_config.uniform_buffer_usage = vk_dynUniformBuffers[vk_activeDynBufferIdx].currentOffset;
-	if (vk_config.uniform_buffer_max_usage < vk_config.uniform_buffer_usage)
-		vk_config.uniform_buffer_max_usage = vk_config.uniform_buffer_usage;
+	vmaFlushAllocation(vk_malloc, sbo->allocation, 0, VK_WHOLE_SIZE);
+}
 
-	return (uint8_t *)vk_dynUniformBuffers[vk_activeDynBufferIdx].allocInfo.pMappedData + (*dstOffset);
+VkDescriptorSet QVk_GetLightStyleDescriptorSet(void)
+{
+	return vk_lightStyleDescSets[vk_activeDynBufferIdx];
 }
 
 uint8_t *QVk_GetStagingBuffer(VkDeviceSize size, int alignment, VkCommandBuffer *cmdBuffer, VkBuffer *buffer, uint32_t *dstOffset)
@@ -2342,10 +2699,37 @@ uint8_t *QVk_GetStagingBuffer(VkDeviceSize size, int alignment, VkCommandBuffer
 	if (size > STAGING_BUFFER_MAXSIZE)
 		Sys_Error("QVk_GetStagingBuffer(): Cannot allocate staging buffer space!");
 
+	vk_recordStats->stagingBytes += (uint32_t)size;
+
 	if ((stagingBuffer->buffer.currentOffset + size) >= STAGING_BUFFER_MAXSIZE && !stagingBuffer->submitted)
 		SubmitStagingBuffer(vk_activeStagingBuffer);
 
 	stagingBuffer = &vk_stagingBuffers[vk_activeStagingBuffer];
+	if (stagingBuffer->submitted && vkGetFenceStatus(vk_device.logical, stagingBuffer->fence) != VK_SUCCESS)
+	{
+		// rather than stalling on the next buffer in line, take any other one the GPU is done with or add a new one
+		int i;
+		for (i = 0; i < vk_numStagingBuffers; ++i)
+		{
+			if (vk_stagingBuffers[i].submitted && vkGetFenceStatus(vk_device.logical, vk_stagingBuffers[i].fence) == VK_SUCCESS)
+				break;
+		}
+
+		if (i == vk_numStagingBuffers && vk_numStagingBuffers < MAX_STAGINGBUFFERS)
+		{
+			CreateStagingBuffer(vk_numStagingBuffers++);
+			vk_config.staging_buffer_count = vk_numStagingBuffers;
+			ri.Con_Printf(PRINT_DEVELOPER, "Adding staging buffer #%d\n", i);
+		}
+
+		if (i < vk_numStagingBuffers)
+			vk_activeStagingBuffer = i;
+		else
+			vk_config.staging_buffer_stalls++;
+
+		stagingBuffer = &vk_stagingBuffers[vk_activeStagingBuffer];
+	}
+
 	if (stagingBuffer->submitted)
 	{
 		VK_VERIFY(vkWaitForFences(vk_device.logical, 1, &stagingBuffer->fence, VK_TRUE, UINT64_MAX));
@@ -2388,17 +2772,18 @@ VkBuffer QVk_GetTriangleFanIbo(VkDeviceSize indexCount)
 
 	if (indexCount > vk_config.triangle_fan_index_count)
 	{
-		vk_config.triangle_fan_index_count *= BUFFER_RESIZE_FACTOR;
+		while (indexCount > vk_config.triangle_fan_index_count)
+			vk_config.triangle_fan_index_count *= BUFFER_RESIZE_FACTOR;
 		ri.Con_Printf(PRINT_ALL, "Resizing triangle fan index buffer to %u indices.\n", vk_config.triangle_fan_index_count);
 		RebuildTriangleFanIndexBuffer();
 	}
 
-	return *vk_triangleFanIbo;
+	return vk_triangleFanIbo.buffer;
 }
 
 void QVk_SubmitStagingBuffers()
 {
-	for (int i = 0; i < NUM_DYNBUFFERS; ++i)
+	for (int i = 0; i < vk_numStagingBuffers; ++i)
 	{
 		if (!vk_stagingBuffers[i].submitted && vk_stagingBuffers[i].buffer.currentOffset > 0)
 			SubmitStagingBuffer(i);
@@ -2470,6 +2855,7 @@ void QVk_BindPipeline(qvkpipeline_t *pipeline)
 	{
 		vkCmdBindPipeline(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pl);
 		vk_state.current_pipeline = pipeline->pl;
+		vk_recordStats->pipelineBinds++;
 	}
 }
 
@@ -446,11 +446,88 @@ void QVk_UpdateTextureData(qvktexture_t *texture, const unsigned char *data, uin
 	}
 }
 
+/*
+** QVk_UpdateTextureRegions
+**
+** Uploads any number of rectangles into a texture with a single staging
+** allocation, one copy command and one pair of layout transitions.
+** Only the base level is written, so this is meant for textures without mipmaps.
+*/
+void QVk_UpdateTextureRegions(qvktexture_t *texture, const qvktextureregion_t *regions, uint32_t numRegions)
+{
+	int unifiedTransferAndGfx = vk_device.transferQueue == vk_device.gfxQueue ? 1 : 0;
+	VkDeviceSize imageSize = 0;
+	uint32_t i;
+
+	if (!numRegions)
+		return;
+
+	// assuming 32bit images
+	for (i = 0; i < numRegions; i++)
+		imageSize += regions[i].rect.extent.width * regions[i].rect.extent.height * 4;
+
+	VkBuffer staging_buffer;
+	VkCommandBuffer command_buffer;
+	uint32_t staging_offset;
+	uint8_t *imgData = QVk_GetStagingBuffer(imageSize, 4, &command_buffer, &staging_buffer, &staging_offset);
+	VkBufferImageCopy *copyRegions = malloc(sizeof(VkBufferImageCopy) * numRegions);
+
+	for (i = 0; i < numRegions; i++)
+	{
+		uint32_t regionSize = regions[i].rect.extent.width * regions[i].rect.extent.height * 4;
+
+		memcpy(imgData, regions[i].data, regionSize);
+
+		copyRegions[i] = (VkBufferImageCopy) {
+			.bufferOffset = staging_offset,
+			.bufferRowLength = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.imageSubresource.mipLevel = 0,
+			.imageSubresource.baseArrayLayer = 0,
+			.imageSubresource.layerCount = 1,
+			.imageOffset = { regions[i].rect.offset.x, regions[i].rect.offset.y, 0 },
+			.imageExtent = { regions[i].rect.extent.width, regions[i].rect.extent.height, 1 }
+		};
+
+		imgData += regionSize;
+		staging_offset += regionSize;
+	}
+
+	transitionImageLayout(&command_buffer, &vk_device.transferQueue, texture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	vkCmdCopyBufferToImage(command_buffer, staging_buffer, texture->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, numRegions, copyRegions);
+
+	// for non-unified transfer and graphics, this step begins queue ownership transfer to graphics queue (for exclusive sharing only)
+	if (unifiedTransferAndGfx || texture->sharingMode == VK_SHARING_MODE_EXCLUSIVE)
+		transitionImageLayout(&command_buffer, &vk_device.transferQueue, texture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	if (!unifiedTransferAndGfx)
+	{
+		transitionImageLayout(&command_buffer, &vk_device.gfxQueue, texture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	free(copyRegions);
+}
+
+/*
+** QVk_ReleaseTexture
+**
+** Frames in flight and pending staging uploads may still reference the
+** texture, so it is only destroyed once they are done with it.
+** The caller is free to reuse the qvktexture_t right away.
+*/
 void QVk_ReleaseTexture(qvktexture_t *texture)
 {
-	QVk_SubmitStagingBuffers();
-	vkDeviceWaitIdle(vk_device.logical);
+	if (texture->image != VK_NULL_HANDLE || texture->imageView != VK_NULL_HANDLE || texture->descriptorSet != VK_NULL_HANDLE)
+		QVk_DeferTextureRelease(texture);
+
+	texture->image = VK_NULL_HANDLE;
+	texture->imageView = VK_NULL_HANDLE;
+	texture->descriptorSet = VK_NULL_HANDLE;
+}
 
+void QVk_DestroyTexture(qvktexture_t *texture)
+{
 	if (texture->image != VK_NULL_HANDLE)
 		vmaDestroyImage(vk_malloc, texture->image, texture->allocation);
 	if (texture->imageView != VK_NULL_HANDLE)
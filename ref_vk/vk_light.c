@@ -22,8 +22,19 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "vk_local.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LIGHTMAP_SSE2
+#  include <emmintrin.h>
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#  define LIGHTMAP_NEON
+#  include <arm_neon.h>
+#endif
+
 int	r_dlightframecount;
 
+// lightstyle colours scaled by vk_modulate, see R_SetupLightStyles
+static float r_stylescales[MAX_LIGHTSTYLES][3];
+
 #define	DLIGHT_CUTOFF	64
 
 /*
@@ -266,15 +277,14 @@ int RecursiveLightPoint (mnode_t *node, vec3_t start, vec3_t end)
 		VectorCopy (vec3_origin, pointcolor);
 		if (lightmap)
 		{
-			vec3_t scale;
+			const float *scale;
 
 			lightmap += 3*(dt * ((surf->extents[0]>>4)+1) + ds);
 
 			for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
 					maps++)
 			{
-				for (i=0 ; i<3 ; i++)
-					scale[i] = vk_modulate->value*r_newrefdef.lightstyles[surf->styles[maps]].rgb[i];
+				scale = r_stylescales[surf->styles[maps]];
 
 				pointcolor[0] += lightmap[0] * scale[0] * (1.0/255);
 				pointcolor[1] += lightmap[1] * scale[1] * (1.0/255);
@@ -350,6 +360,254 @@ void R_LightPoint (vec3_t p, vec3_t color)
 //===================================================================
 
 static float s_blocklights[34*34*3];
+
+/*
+** R_SetupLightStyles
+**
+** Lightstyles are evaluated once per refdef: every style's colour is
+** multiplied by vk_modulate here and handed to the lightmapped polygon
+** shader, which scales the surfaces' lightmap layers with them. The CPU only
+** looks them up for dynamically lit lightmaps and light points.
+*/
+void R_SetupLightStyles (void)
+{
+	int i;
+
+	// model views in the menus don't carry any lightstyles
+	if (!r_newrefdef.lightstyles)
+		return;
+
+	for (i = 0; i < MAX_LIGHTSTYLES; i++)
+		VectorScale (r_newrefdef.lightstyles[i].rgb, vk_modulate->value, r_stylescales[i]);
+
+	QVk_UpdateLightStyles(r_stylescales, MAX_LIGHTSTYLES);
+}
+
+/*
+=============================================================================
+
+LIGHTMAP KERNELS
+
+The per-luxel work of R_BuildLightMap is done by a pair of kernels: one adds
+a scaled lightstyle layer into s_blocklights, the other clamps a row of
+s_blocklights into RGBA texels. Every kernel set produces bit-identical
+output to the plain C one; the vector versions handle four (SSE2) or eight
+(NEON) luxels per iteration and leave the remainder to the C loop.
+
+=============================================================================
+*/
+
+typedef struct
+{
+	const char	*name;
+	void		(*accumulate) (float *bl, const byte *lightmap, const float *scale, int size);
+	void		(*storerow) (const float *bl, byte *dest, int size);
+} lightmapkernels_t;
+
+static void R_LightmapAccumulate_C (float *bl, const byte *lightmap, const float *scale, int size)
+{
+	int i;
+
+	for (i=0 ; i<size ; i++, bl+=3, lightmap+=3)
+	{
+		bl[0] += lightmap[0] * scale[0];
+		bl[1] += lightmap[1] * scale[1];
+		bl[2] += lightmap[2] * scale[2];
+	}
+}
+
+static void R_LightmapStoreRow_C (const float *bl, byte *dest, int size)
+{
+	int i;
+	int r, g, b, a, max;
+
+	for (i=0 ; i<size ; i++, bl+=3, dest+=4)
+	{
+		r = Q_ftol(bl[0]);
+		g = Q_ftol(bl[1]);
+		b = Q_ftol(bl[2]);
+
+		// catch negative lights
+		if (r < 0)
+			r = 0;
+		if (g < 0)
+			g = 0;
+		if (b < 0)
+			b = 0;
+
+		/*
+		** determine the brightest of the three color components
+		*/
+		if (r > g)
+			max = r;
+		else
+			max = g;
+		if (b > max)
+			max = b;
+
+		/*
+		** alpha is ONLY used for the mono lightmap case.  For this reason
+		** we set it to the brightest of the color components so that
+		** things don't get too dim.
+		*/
+		a = max;
+
+		/*
+		** rescale all the color components if the intensity of the greatest
+		** channel exceeds 1.0
+		*/
+		if (max > 255)
+		{
+			float t = 255.0F / max;
+
+			r = r * t;
+			g = g * t;
+			b = b * t;
+			a = a * t;
+		}
+
+		dest[0] = r;
+		dest[1] = g;
+		dest[2] = b;
+		dest[3] = a;
+	}
+}
+
+static const lightmapkernels_t lm_kernels_c = { "C", R_LightmapAccumulate_C, R_LightmapStoreRow_C };
+
+#if defined(LIGHTMAP_SSE2)
+static void R_LightmapAccumulate_SSE2 (float *bl, const byte *lightmap, const float *scale, int size)
+{
+	// scale vectors line up with the r,g,b,r / g,b,r,g / b,r,g,b pattern of 4 interleaved luxels
+	const __m128 s0 = _mm_setr_ps(scale[0], scale[1], scale[2], scale[0]);
+	const __m128 s1 = _mm_setr_ps(scale[1], scale[2], scale[0], scale[1]);
+	const __m128 s2 = _mm_setr_ps(scale[2], scale[0], scale[1], scale[2]);
+	const __m128i zero = _mm_setzero_si128();
+	int i;
+
+	for (i=0 ; i+4<=size ; i+=4, bl+=12, lightmap+=12)
+	{
+		int tail;
+		__m128i lo, hi;
+
+		memcpy(&tail, lightmap + 8, sizeof(tail));
+		lo = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)lightmap), zero);
+		hi = _mm_unpacklo_epi8(_mm_cvtsi32_si128(tail), zero);
+
+		_mm_storeu_ps(bl + 0, _mm_add_ps(_mm_loadu_ps(bl + 0), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), s0)));
+		_mm_storeu_ps(bl + 4, _mm_add_ps(_mm_loadu_ps(bl + 4), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), s1)));
+		_mm_storeu_ps(bl + 8, _mm_add_ps(_mm_loadu_ps(bl + 8), _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), s2)));
+	}
+
+	R_LightmapAccumulate_C(bl, lightmap, scale, size - i);
+}
+
+static void R_LightmapStoreRow_SSE2 (const float *bl, byte *dest, int size)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 c255 = _mm_set1_ps(255.f);
+	int i;
+
+	for (i=0 ; i+4<=size ; i+=4, bl+=12, dest+=16)
+	{
+		__m128 v0 = _mm_loadu_ps(bl + 0);
+		__m128 v1 = _mm_loadu_ps(bl + 4);
+		__m128 v2 = _mm_loadu_ps(bl + 8);
+		__m128 r, g, b, m, t, over;
+		__m128i px;
+
+		// deinterleave into r0..r3, g0..g3, b0..b3
+		r = _mm_shuffle_ps(_mm_shuffle_ps(v0, v0, _MM_SHUFFLE(3,3,0,0)), _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1,1,2,2)), _MM_SHUFFLE(2,0,2,0));
+		g = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0,0,1,1)), _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2,2,3,3)), _MM_SHUFFLE(2,0,2,0));
+		b = _mm_shuffle_ps(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1,1,2,2)), _mm_shuffle_ps(v2, v2, _MM_SHUFFLE(3,3,0,0)), _MM_SHUFFLE(2,0,2,0));
+
+		// truncate like Q_ftol and catch negative lights
+		r = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_max_ps(r, zero)));
+		g = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_max_ps(g, zero)));
+		b = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_max_ps(b, zero)));
+
+		// rescale luxels whose brightest channel exceeds 1.0, alpha is the brightest channel
+		m = _mm_max_ps(r, _mm_max_ps(g, b));
+		over = _mm_cmpgt_ps(m, c255);
+		t = _mm_or_ps(_mm_and_ps(over, _mm_div_ps(c255, m)), _mm_andnot_ps(over, one));
+
+		px = _mm_cvttps_epi32(_mm_mul_ps(r, t));
+		px = _mm_or_si128(px, _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(g, t)), 8));
+		px = _mm_or_si128(px, _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(b, t)), 16));
+		px = _mm_or_si128(px, _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(m, t)), 24));
+		_mm_storeu_si128((__m128i *)dest, px);
+	}
+
+	R_LightmapStoreRow_C(bl, dest, size - i);
+}
+
+static const lightmapkernels_t lm_kernels_simd = { "SSE2", R_LightmapAccumulate_SSE2, R_LightmapStoreRow_SSE2 };
+static const lightmapkernels_t *lm_kernels = &lm_kernels_simd;
+#elif defined(LIGHTMAP_NEON)
+static void R_LightmapAccumulate_NEON (float *bl, const byte *lightmap, const float *scale, int size)
+{
+	int i, c;
+
+	for (i=0 ; i+8<=size ; i+=8, bl+=24, lightmap+=24)
+	{
+		uint8x8x3_t lm = vld3_u8(lightmap);
+		float32x4x3_t lo = vld3q_f32(bl);
+		float32x4x3_t hi = vld3q_f32(bl + 12);
+
+		for (c=0 ; c<3 ; c++)
+		{
+			uint16x8_t w = vmovl_u8(lm.val[c]);
+
+			lo.val[c] = vaddq_f32(lo.val[c], vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))), scale[c]));
+			hi.val[c] = vaddq_f32(hi.val[c], vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))), scale[c]));
+		}
+
+		vst3q_f32(bl, lo);
+		vst3q_f32(bl + 12, hi);
+	}
+
+	R_LightmapAccumulate_C(bl, lightmap, scale, size - i);
+}
+
+static void R_LightmapStoreRow_NEON (const float *bl, byte *dest, int size)
+{
+	const float32x4_t zero = vdupq_n_f32(0.f);
+	const float32x4_t one = vdupq_n_f32(1.f);
+	const float32x4_t c255 = vdupq_n_f32(255.f);
+	int i;
+
+	for (i=0 ; i+4<=size ; i+=4, bl+=12, dest+=16)
+	{
+		float32x4x3_t v = vld3q_f32(bl);
+		float32x4_t r, g, b, m, t;
+		uint32x4_t px;
+
+		// truncate like Q_ftol and catch negative lights
+		r = vcvtq_f32_s32(vcvtq_s32_f32(vmaxq_f32(v.val[0], zero)));
+		g = vcvtq_f32_s32(vcvtq_s32_f32(vmaxq_f32(v.val[1], zero)));
+		b = vcvtq_f32_s32(vcvtq_s32_f32(vmaxq_f32(v.val[2], zero)));
+
+		// rescale luxels whose brightest channel exceeds 1.0, alpha is the brightest channel
+		m = vmaxq_f32(r, vmaxq_f32(g, b));
+		t = vbslq_f32(vcgtq_f32(m, c255), vdivq_f32(c255, m), one);
+
+		px = vcvtq_u32_f32(vmulq_f32(r, t));
+		px = vorrq_u32(px, vshlq_n_u32(vcvtq_u32_f32(vmulq_f32(g, t)), 8));
+		px = vorrq_u32(px, vshlq_n_u32(vcvtq_u32_f32(vmulq_f32(b, t)), 16));
+		px = vorrq_u32(px, vshlq_n_u32(vcvtq_u32_f32(vmulq_f32(m, t)), 24));
+		vst1q_u8(dest, vreinterpretq_u8_u32(px));
+	}
+
+	R_LightmapStoreRow_C(bl, dest, size - i);
+}
+
+static const lightmapkernels_t lm_kernels_simd = { "NEON", R_LightmapAccumulate_NEON, R_LightmapStoreRow_NEON };
+static const lightmapkernels_t *lm_kernels = &lm_kernels_simd;
+#else
+static const lightmapkernels_t *lm_kernels = &lm_kernels_c;
+#endif
+
 /*
 ===============
 R_AddDynamicLights
@@ -430,20 +688,6 @@ void R_AddDynamicLights (msurface_t *surf)
 }
 
 
-/*
-** R_SetCacheState
-*/
-void R_SetCacheState( msurface_t *surf )
-{
-	int maps;
-
-	for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
-		 maps++)
-	{
-		surf->cached_light[maps] = r_newrefdef.lightstyles[surf->styles[maps]].white;
-	}
-}
-
 /*
 ===============
 R_BuildLightMap
@@ -454,13 +698,10 @@ Combine and scale multiple lightmaps into the floating format in blocklights
 void R_BuildLightMap (msurface_t *surf, byte *dest, int stride)
 {
 	int			smax, tmax;
-	int			r, g, b, a, max;
-	int			i, j, size;
+	int			i, size;
 	byte		*lightmap;
-	float		scale[4];
-	int			nummaps;
-	float		*bl;
-	lightstyle_t	*style;
+	const float	*scale;
+	int			maps;
 
 	if ( surf->texinfo->flags & (SURF_SKY|SURF_TRANS33|SURF_TRANS66|SURF_WARP) )
 		ri.Sys_Error (ERR_DROP, "R_BuildLightMap called for non-lit surface");
@@ -474,97 +715,25 @@ void R_BuildLightMap (msurface_t *surf, byte *dest, int stride)
 // set to full bright if no light data
 	if (!surf->samples)
 	{
-		int maps;
-
 		for (i=0 ; i<size*3 ; i++)
 			s_blocklights[i] = 255;
-		for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
-			 maps++)
-		{
-			style = &r_newrefdef.lightstyles[surf->styles[maps]];
-		}
 		goto store;
 	}
 
-	// count the # of maps
-	for ( nummaps = 0 ; nummaps < MAXLIGHTMAPS && surf->styles[nummaps] != 255 ;
-		 nummaps++)
-		;
-
 	lightmap = surf->samples;
 
 	// add all the lightmaps
-	if ( nummaps == 1 )
-	{
-		int maps;
-
-		for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
-			 maps++)
-		{
-			bl = s_blocklights;
-
-			for (i=0 ; i<3 ; i++)
-				scale[i] = vk_modulate->value*r_newrefdef.lightstyles[surf->styles[maps]].rgb[i];
+	memset( s_blocklights, 0, sizeof( s_blocklights[0] ) * size * 3 );
 
-			if ( scale[0] == 1.0F &&
-				 scale[1] == 1.0F &&
-				 scale[2] == 1.0F )
-			{
-				for (i=0 ; i<size ; i++, bl+=3)
-				{
-					bl[0] = lightmap[i*3+0];
-					bl[1] = lightmap[i*3+1];
-					bl[2] = lightmap[i*3+2];
-				}
-			}
-			else
-			{
-				for (i=0 ; i<size ; i++, bl+=3)
-				{
-					bl[0] = lightmap[i*3+0] * scale[0];
-					bl[1] = lightmap[i*3+1] * scale[1];
-					bl[2] = lightmap[i*3+2] * scale[2];
-				}
-			}
-			lightmap += size*3;		// skip to next lightmap
-		}
-	}
-	else
+	for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
+		 maps++)
 	{
-		int maps;
-
-		memset( s_blocklights, 0, sizeof( s_blocklights[0] ) * size * 3 );
+		scale = r_stylescales[surf->styles[maps]];
 
-		for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
-			 maps++)
-		{
-			bl = s_blocklights;
-
-			for (i=0 ; i<3 ; i++)
-				scale[i] = vk_modulate->value*r_newrefdef.lightstyles[surf->styles[maps]].rgb[i];
-
-			if ( scale[0] == 1.0F &&
-				 scale[1] == 1.0F &&
-				 scale[2] == 1.0F )
-			{
-				for (i=0 ; i<size ; i++, bl+=3 )
-				{
-					bl[0] += lightmap[i*3+0];
-					bl[1] += lightmap[i*3+1];
-					bl[2] += lightmap[i*3+2];
-				}
-			}
-			else
-			{
-				for (i=0 ; i<size ; i++, bl+=3)
-				{
-					bl[0] += lightmap[i*3+0] * scale[0];
-					bl[1] += lightmap[i*3+1] * scale[1];
-					bl[2] += lightmap[i*3+2] * scale[2];
-				}
-			}
-			lightmap += size*3;		// skip to next lightmap
-		}
+		// switched off lights add nothing
+		if (scale[0] != 0 || scale[1] != 0 || scale[2] != 0)
+			lm_kernels->accumulate(s_blocklights, lightmap, scale, size);
+		lightmap += size*3;		// skip to next lightmap
 	}
 
 // add all the dynamic lights
@@ -573,65 +742,81 @@ void R_BuildLightMap (msurface_t *surf, byte *dest, int stride)
 
 // put into texture format
 store:
-	stride -= (smax<<2);
-	bl = s_blocklights;
-
 	for (i = 0; i < tmax; i++, dest += stride)
+		lm_kernels->storerow(s_blocklights + i * smax * 3, dest, smax);
+}
+
+/*
+===============
+R_LightmapBench_f
+
+Rebuilds every lightmap of the current map with each available kernel set
+and reports the time taken and whether the results match the C kernels.
+===============
+*/
+void R_LightmapBench_f (void)
+{
+	const lightmapkernels_t *sets[2];
+	const lightmapkernels_t *saved = lm_kernels;
+	static unsigned	temp[34 * 34];
+	int			numsets, passes, set, pass, i, start, time;
+	int			numsurfs, numluxels;
+	unsigned	checksum, refsum = 0;
+	msurface_t	*surf;
+
+	if (!r_worldmodel)
 	{
-		for (j = 0; j < smax; j++)
-		{
+		ri.Con_Printf(PRINT_ALL, "No map loaded.\n");
+		return;
+	}
+
+	passes = ri.Cmd_Argc() > 1 ? atoi(ri.Cmd_Argv(1)) : 10;
+	if (passes < 1)
+		passes = 1;
 
-			r = Q_ftol(bl[0]);
-			g = Q_ftol(bl[1]);
-			b = Q_ftol(bl[2]);
-
-			// catch negative lights
-			if (r < 0)
-				r = 0;
-			if (g < 0)
-				g = 0;
-			if (b < 0)
-				b = 0;
-
-			/*
-			** determine the brightest of the three color components
-			*/
-			if (r > g)
-				max = r;
-			else
-				max = g;
-			if (b > max)
-				max = b;
-
-			/*
-			** alpha is ONLY used for the mono lightmap case.  For this reason
-			** we set it to the brightest of the color components so that
-			** things don't get too dim.
-			*/
-			a = max;
-
-			/*
-			** rescale all the color components if the intensity of the greatest
-			** channel exceeds 1.0
-			*/
-			if (max > 255)
+	sets[0] = &lm_kernels_c;
+	numsets = 1;
+	if (lm_kernels != &lm_kernels_c)
+		sets[numsets++] = lm_kernels;
+
+	for (set = 0; set < numsets; set++)
+	{
+		lm_kernels = sets[set];
+		checksum = 0;
+		numsurfs = numluxels = 0;
+		start = Sys_Milliseconds();
+
+		for (pass = 0; pass < passes; pass++)
+		{
+			for (i = 0, surf = r_worldmodel->surfaces; i < r_worldmodel->numsurfaces; i++, surf++)
 			{
-				float t = 255.0F / max;
+				int smax = (surf->extents[0] >> 4) + 1;
+				int tmax = (surf->extents[1] >> 4) + 1;
 
-				r = r * t;
-				g = g * t;
-				b = b * t;
-				a = a * t;
-			}
+				if (surf->texinfo->flags & (SURF_SKY|SURF_TRANS33|SURF_TRANS66|SURF_WARP))
+					continue;
+
+				R_BuildLightMap(surf, (void *)temp, smax * 4);
 
-			dest[0] = r;
-			dest[1] = g;
-			dest[2] = b;
-			dest[3] = a;
+				if (pass == 0)
+				{
+					int j;
 
-			bl += 3;
-			dest += 4;
+					for (j = 0; j < smax * tmax; j++)
+						checksum = checksum * 31 + temp[j];
+					numsurfs++;
+					numluxels += smax * tmax;
+				}
+			}
 		}
+
+		time = Sys_Milliseconds() - start;
+		if (set == 0)
+			refsum = checksum;
+
+		ri.Con_Printf(PRINT_ALL, "%-4s: %i surfaces, %i luxels x %i passes in %i ms%s\n", lm_kernels->name, numsurfs, numluxels, passes, time,
+					  checksum == refsum ? "" : " (MISMATCH)");
 	}
-}
 
+	lm_kernels = saved;
+}
@@ -202,6 +202,7 @@ extern	cvar_t	*vk_point_particles;
 extern	cvar_t	*vk_dynamic;
 extern	cvar_t	*vk_showtris;
 extern	cvar_t	*vk_lightmap;
+extern	cvar_t	*vk_worldbatch;
 extern	cvar_t	*vk_texturemode;
 extern	cvar_t	*vk_lmaptexturemode;
 extern	cvar_t	*vk_aniso;
@@ -209,6 +210,8 @@ extern	cvar_t	*vk_sampleshading;
 extern	cvar_t	*vk_vsync;
 extern	cvar_t	*vk_device_idx;
 extern	cvar_t	*vk_fullscreen_exclusive;
+extern	cvar_t	*vk_profile;
+extern	cvar_t	*vk_profilecsv;
 
 extern	cvar_t	*vid_fullscreen;
 extern	cvar_t	*vid_gamma;
@@ -217,6 +220,7 @@ extern	cvar_t	*intensity;
 
 extern	int		c_visible_lightmaps;
 extern	int		c_visible_textures;
+extern	int		c_world_batches;
 
 extern	float	r_viewproj_matrix[16];
 
@@ -229,6 +233,12 @@ extern	model_t	*r_worldmodel;
 
 extern	unsigned	d_8to24table[256];
 
+#define	NUMVERTEXNORMALS	162
+#define	SHADEDOT_QUANT		16
+
+extern	float	r_avertexnormals[NUMVERTEXNORMALS][3];
+extern	float	r_avertexnormal_dots[SHADEDOT_QUANT][256];
+
 extern	int		registration_sequence;
 extern	qvksampler_t vk_current_sampler;
 extern	qvksampler_t vk_current_lmap_sampler;
@@ -246,6 +256,10 @@ void R_DrawWorld (void);
 void R_RenderDlights (void);
 void R_DrawAlphaSurfaces (void);
 void R_RenderBrushPoly (msurface_t *fa, float *modelMatrix, float alpha);
+void Vk_FreeWorldBuffer (model_t *m);
+void Vk_UploadLightmapUpdates (void);
+void Vk_BuildAliasMesh (model_t *mod, dmdl_t *paliashdr);
+void Vk_FreeAliasMesh (model_t *mod);
 void R_InitParticleTexture (void);
 void Draw_InitLocal (void);
 void Vk_SubdivideSurface (msurface_t *fa);
@@ -258,6 +272,8 @@ void R_AddSkySurface (msurface_t *fa);
 void R_ClearSkyBox (void);
 void R_DrawSkyBox (void);
 void R_MarkLights (dlight_t *light, int bit, mnode_t *node);
+void R_LightmapBench_f (void);
+void R_SetupLightStyles (void);
 
 void COM_StripExtension (char *in, char *out);
 
@@ -312,12 +328,17 @@ typedef struct
 	uint32_t    vertex_buffer_usage;
 	uint32_t    vertex_buffer_max_usage;
 	uint32_t    vertex_buffer_size;
+	uint32_t    vertex_buffer_pages;
 	uint32_t    index_buffer_usage;
 	uint32_t    index_buffer_max_usage;
 	uint32_t    index_buffer_size;
+	uint32_t    index_buffer_pages;
 	uint32_t    uniform_buffer_usage;
 	uint32_t    uniform_buffer_max_usage;
 	uint32_t    uniform_buffer_size;
+	uint32_t    uniform_buffer_pages;
+	uint32_t    staging_buffer_count;
+	uint32_t    staging_buffer_stalls;
 	uint32_t    triangle_fan_index_usage;
 	uint32_t    triangle_fan_index_max_usage;
 	uint32_t    triangle_fan_index_count;
@@ -325,6 +346,8 @@ typedef struct
 	uint32_t    allocated_sampler_descriptor_set_count;
 	uint32_t    ubo_descriptor_set_count;
 	uint32_t    sampler_descriptor_set_count;
+	uint32_t    pipeline_cache_size;		// bytes loaded from disk, 0 if the cache started out empty
+	int         pipeline_creation_time;	// ms spent in CreatePipelines()
 	int         swapchain_image_count;
 	qboolean    vk_khr_portability_subset_available;  // this extension must be enabled according to the specs if the device supports it
 	qboolean    vk_khr_get_physical_device_properties2_available; // required by VK_KHR_portability_subset and VK_EXT_full_screen_exclusive
@@ -337,7 +360,7 @@ typedef struct
 	qboolean    vk_full_screen_exclusive_acquired;
 } vkconfig_t;
 
-#define MAX_LIGHTMAPS 128
+#define MAX_LIGHTMAPS 32
 #define DYNLIGHTMAP_OFFSET MAX_LIGHTMAPS
 
 typedef struct
@@ -30,8 +30,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 =============================================================
 */
 
-#define NUMVERTEXNORMALS	162
-
 float	r_avertexnormals[NUMVERTEXNORMALS][3] = {
 #include "anorms.h"
 };
@@ -44,7 +42,6 @@ vec3_t	shadevector;
 float	shadelight[3];
 
 // precalculated dot products for quantized angles
-#define SHADEDOT_QUANT 16
 float	r_avertexnormal_dots[SHADEDOT_QUANT][256] =
 #include "anormtab.h"
 ;
@@ -91,42 +88,161 @@ void Vk_LerpVerts( int nverts, dtrivertx_t *v, dtrivertx_t *ov, dtrivertx_t *ver
 }
 
 /*
-=============
-Vk_DrawAliasFrameLerp
+=================
+Vk_BuildAliasMesh
 
-interpolates between two frames and origins
-FIXME: batch lerp all vertexes
-=============
+Turns the glcmds strips and fans into a single indexed triangle list
+over the unique xyz/st pairs. Every frame's vertices are laid out in that
+order and uploaded once together with the texture coordinates, so drawing
+a frame only binds two of them and lets the vertex shader do the lerp.
+=================
 */
-void Vk_DrawAliasFrameLerp (dmdl_t *paliashdr, float backlerp, image_t *skin, float *modelMatrix, int leftHandOffset, int translucentIdx)
+void Vk_BuildAliasMesh (model_t *mod, dmdl_t *paliashdr)
 {
-	float 	l;
-	daliasframe_t	*frame, *oldframe;
-	dtrivertx_t	*v, *ov, *verts;
-	int		*order;
-	int		count;
-	float	frontlerp;
-	float	alpha;
-	vec3_t	move, delta, vectors[3];
-	vec3_t	frontv, backv;
-	int		i;
-	int		index_xyz;
-	float	*lerp;
-
-	frame = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
-		+ currententity->frame * paliashdr->framesize);
-	verts = v = frame->verts;
+	int		*order, *base;
+	int		*first, *next, *xyz;
+	int		count, numcmdverts, numindices;
+	int		i, j, vert;
+	uint16_t	*indices, *strip;
+	float	*st;
+	dtrivertx_t	*verts;
+	daliasframe_t	*frame;
 
-	oldframe = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
-		+ currententity->oldframe * paliashdr->framesize);
-	ov = oldframe->verts;
+	// count the vertices the commands reference
+	numcmdverts = 0;
+	numindices = 0;
+	for (order = (int *)((byte *)paliashdr + paliashdr->ofs_glcmds); (count = *order++) != 0; order += abs(count) * 3)
+	{
+		numcmdverts += abs(count);
+		numindices += (abs(count) - 2) * 3;
+	}
 
+	// frame vertex and texture coordinates of each mesh vertex
+	xyz = malloc(numcmdverts * sizeof(int));
+	st = malloc(numcmdverts * 2 * sizeof(float));
+	mod->numaliasverts = 0;
+	mod->numaliasindices = numindices;
+
+	indices = malloc(numindices * sizeof(uint16_t));
+	strip = malloc(numcmdverts * sizeof(uint16_t));
+	// mesh vertices sharing a frame vertex are chained off it
+	first = malloc(paliashdr->num_xyz * sizeof(int));
+	next = malloc(numcmdverts * sizeof(int));
+	for (i = 0; i < paliashdr->num_xyz; i++)
+		first[i] = -1;
+
+	numindices = 0;
 	order = (int *)((byte *)paliashdr + paliashdr->ofs_glcmds);
+	while ((count = *order++) != 0)
+	{
+		base = order;
+		order += abs(count) * 3;
 
-	if (currententity->flags & RF_TRANSLUCENT)
-		alpha = currententity->alpha;
-	else
-		alpha = 1.0;
+		for (i = 0; i < abs(count); i++, base += 3)
+		{
+			for (vert = first[base[2]]; vert >= 0; vert = next[vert])
+			{
+				if (st[vert * 2 + 0] == ((float *)base)[0] && st[vert * 2 + 1] == ((float *)base)[1])
+					break;
+			}
+
+			if (vert < 0)
+			{
+				vert = mod->numaliasverts++;
+				xyz[vert] = base[2];
+				st[vert * 2 + 0] = ((float *)base)[0];
+				st[vert * 2 + 1] = ((float *)base)[1];
+				next[vert] = first[base[2]];
+				first[base[2]] = vert;
+			}
+
+			strip[i] = vert;
+		}
+
+		for (j = 2; j < abs(count); j++)
+		{
+			if (count < 0)
+			{	// fan
+				indices[numindices++] = strip[0];
+				indices[numindices++] = strip[j - 1];
+				indices[numindices++] = strip[j];
+			}
+			else if (j & 1)
+			{	// odd strip triangles have their winding flipped
+				indices[numindices++] = strip[j - 1];
+				indices[numindices++] = strip[j - 2];
+				indices[numindices++] = strip[j];
+			}
+			else
+			{
+				indices[numindices++] = strip[j - 2];
+				indices[numindices++] = strip[j - 1];
+				indices[numindices++] = strip[j];
+			}
+		}
+	}
+
+	if (numindices > 0)
+	{
+		QVk_CreateIndexBuffer(indices, numindices * sizeof(uint16_t), &mod->aliasibo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+		QVk_DebugSetObjectName((uint64_t)mod->aliasibo.buffer, VK_OBJECT_TYPE_BUFFER, va("Index Buffer: %s", mod->name));
+		QVk_DebugSetObjectName((uint64_t)mod->aliasibo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Index Buffer: %s", mod->name));
+
+		// dtrivertx_t is read as-is: compressed position and light normal index
+		verts = malloc(paliashdr->num_frames * mod->numaliasverts * sizeof(dtrivertx_t) + mod->numaliasverts * 2 * sizeof(float));
+		for (i = 0; i < paliashdr->num_frames; i++)
+		{
+			frame = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames + i * paliashdr->framesize);
+			for (j = 0; j < mod->numaliasverts; j++)
+				verts[i * mod->numaliasverts + j] = frame->verts[xyz[j]];
+		}
+		memcpy(verts + paliashdr->num_frames * mod->numaliasverts, st, mod->numaliasverts * 2 * sizeof(float));
+
+		QVk_CreateVertexBuffer(verts, paliashdr->num_frames * mod->numaliasverts * sizeof(dtrivertx_t) + mod->numaliasverts * 2 * sizeof(float),
+							   &mod->aliasvbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+		QVk_DebugSetObjectName((uint64_t)mod->aliasvbo.buffer, VK_OBJECT_TYPE_BUFFER, va("Vertex Buffer: %s", mod->name));
+		QVk_DebugSetObjectName((uint64_t)mod->aliasvbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Vertex Buffer: %s", mod->name));
+		free(verts);
+	}
+
+	free(indices);
+	free(st);
+	free(xyz);
+	free(strip);
+	free(first);
+	free(next);
+}
+
+/*
+=================
+Vk_FreeAliasMesh
+=================
+*/
+void Vk_FreeAliasMesh (model_t *mod)
+{
+	if (mod->type != mod_alias || mod->aliasibo.buffer == VK_NULL_HANDLE)
+		return;
+
+	// frames in flight may still be reading from them
+	QVk_DeferBufferRelease(&mod->aliasibo);
+	QVk_DeferBufferRelease(&mod->aliasvbo);
+	memset(&mod->aliasibo, 0, sizeof(mod->aliasibo));
+	memset(&mod->aliasvbo, 0, sizeof(mod->aliasvbo));
+}
+
+/*
+=============
+Vk_AliasFrameMove
+
+move is the lerped frame translation plus the delta back to the
+previous origin, in model space
+=============
+*/
+static void Vk_AliasFrameMove (daliasframe_t *frame, daliasframe_t *oldframe, float backlerp, vec3_t move)
+{
+	vec3_t	delta, vectors[3];
+	float	frontlerp;
+	int		i;
 
 	frontlerp = 1.0 - backlerp;
 
@@ -144,161 +260,95 @@ void Vk_DrawAliasFrameLerp (dmdl_t *paliashdr, float backlerp, image_t *skin, fl
 	{
 		move[i] = backlerp*move[i] + frontlerp*frame->translate[i];
 	}
+}
 
-	for (i=0 ; i<3 ; i++)
-	{
-		frontv[i] = frontlerp*frame->scale[i];
-		backv[i] = backlerp*oldframe->scale[i];
-	}
-
-	lerp = s_lerped[0];
-
-	Vk_LerpVerts( paliashdr->num_xyz, v, ov, verts, lerp, move, frontv, backv );
-
-	enum {
-		TRIANGLE_STRIP = 0,
-		TRIANGLE_FAN = 1
-	} pipelineIdx;
-
-	typedef struct {
-		float vertex[3];
-		float color[4];
-		float texCoord[2];
-	} modelvert;
-
-	int vertCounts[2] = { 0, 0 };
-	static modelvert vertList[2][MAX_VERTS];
-	int pipeCounters[2] = { 0, 0 };
-	VkDeviceSize maxTriangleFanIdxCnt = 0;
+/*
+=============
+Vk_DrawAliasFrameLerp
 
-	static struct {
-		int vertexCount;
-		int firstVertex;
-	} drawInfo[2][MAX_VERTS];
+interpolates between two frames and origins in the vertex shader
+=============
+*/
+void Vk_DrawAliasFrameLerp (dmdl_t *paliashdr, float backlerp, image_t *skin, float *modelMatrix, int leftHandOffset, int translucentIdx)
+{
+	daliasframe_t	*frame, *oldframe;
+	float	alpha;
 
-	drawInfo[0][0].firstVertex = 0;
-	drawInfo[1][0].firstVertex = 0;
+	struct {
+		float vpMatrix[16];
+		float move[4];			// w: backlerp
+		float frontScale[4];
+		float backScale[4];
+	} meshPc;
 
 	struct {
 		float model[16];
+		float shadelight[4];	// w: alpha
+		float shellScale;
+		int shadedots;
 		int textured;
 	} meshUbo;
 
-	while (1)
-	{
-		// get the vertex count and primitive type
-		count = *order++;
-		if (!count)
-			break;		// done
-		if (count < 0)
-		{
-			count = -count;
-			pipelineIdx = TRIANGLE_FAN;
-		}
-		else
-		{
-			pipelineIdx = TRIANGLE_STRIP;
-		}
+	if (!currentmodel->numaliasindices)
+		return;
 
-		drawInfo[pipelineIdx][pipeCounters[pipelineIdx]].vertexCount = count;
-		maxTriangleFanIdxCnt = max(maxTriangleFanIdxCnt, ((count - 2) * 3));
+	frame = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
+		+ currententity->frame * paliashdr->framesize);
 
-		if (currententity->flags & (RF_SHELL_RED | RF_SHELL_GREEN | RF_SHELL_BLUE))
-		{
-			meshUbo.textured = 0;
-			do
-			{
-				int vertIdx = vertCounts[pipelineIdx];
-				// unused in this case, since texturing is disabled
-				vertList[pipelineIdx][vertIdx].texCoord[0] = 0.f;
-				vertList[pipelineIdx][vertIdx].texCoord[1] = 0.f;
-				index_xyz = order[2];
-				order += 3;
-
-				vertList[pipelineIdx][vertIdx].color[0] = shadelight[0];
-				vertList[pipelineIdx][vertIdx].color[1] = shadelight[1];
-				vertList[pipelineIdx][vertIdx].color[2] = shadelight[2];
-				vertList[pipelineIdx][vertIdx].color[3] = alpha;
-
-				vertList[pipelineIdx][vertIdx].vertex[0] = s_lerped[index_xyz][0];
-				vertList[pipelineIdx][vertIdx].vertex[1] = s_lerped[index_xyz][1];
-				vertList[pipelineIdx][vertIdx].vertex[2] = s_lerped[index_xyz][2];
-				vertCounts[pipelineIdx]++;
-			} while (--count);
-		}
-		else
-		{
-			meshUbo.textured = 1;
-			do
-			{
-				int vertIdx = vertCounts[pipelineIdx];
-				// texture coordinates come from the draw list
-				vertList[pipelineIdx][vertIdx].texCoord[0] = ((float *)order)[0];
-				vertList[pipelineIdx][vertIdx].texCoord[1] = ((float *)order)[1];
-				index_xyz = order[2];
-				order += 3;
-
-				// normals and vertexes come from the frame list
-				l = shadedots[verts[index_xyz].lightnormalindex];
-
-				vertList[pipelineIdx][vertIdx].color[0] = l * shadelight[0];
-				vertList[pipelineIdx][vertIdx].color[1] = l * shadelight[1];
-				vertList[pipelineIdx][vertIdx].color[2] = l * shadelight[2];
-				vertList[pipelineIdx][vertIdx].color[3] = alpha;
-
-				vertList[pipelineIdx][vertIdx].vertex[0] = s_lerped[index_xyz][0];
-				vertList[pipelineIdx][vertIdx].vertex[1] = s_lerped[index_xyz][1];
-				vertList[pipelineIdx][vertIdx].vertex[2] = s_lerped[index_xyz][2];
-				vertCounts[pipelineIdx]++;
-			} while (--count);
-		}
+	oldframe = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
+		+ currententity->oldframe * paliashdr->framesize);
 
-		pipeCounters[pipelineIdx]++;
-		drawInfo[pipelineIdx][pipeCounters[pipelineIdx]].firstVertex = vertCounts[pipelineIdx];
-	}
+	if (currententity->flags & RF_TRANSLUCENT)
+		alpha = currententity->alpha;
+	else
+		alpha = 1.0;
+
+	memcpy(meshPc.vpMatrix, r_viewproj_matrix, sizeof(r_viewproj_matrix));
+	Vk_AliasFrameMove (frame, oldframe, backlerp, meshPc.move);
+	meshPc.move[3] = backlerp;
+	VectorCopy (frame->scale, meshPc.frontScale);
+	meshPc.frontScale[3] = 0.f;
+	VectorCopy (oldframe->scale, meshPc.backScale);
+	meshPc.backScale[3] = 0.f;
+
+	memcpy(meshUbo.model, modelMatrix, sizeof(float) * 16);
+	VectorCopy (shadelight, meshUbo.shadelight);
+	meshUbo.shadelight[3] = alpha;
+	meshUbo.shadedots = (shadedots - r_avertexnormal_dots[0]) / 256;
+	//PMM -- added RF_SHELL_DOUBLE, RF_SHELL_HALF_DAM
+	if (currententity->flags & (RF_SHELL_RED | RF_SHELL_GREEN | RF_SHELL_BLUE | RF_SHELL_DOUBLE | RF_SHELL_HALF_DAM))
+		meshUbo.shellScale = POWERSUIT_SCALE;
+	else
+		meshUbo.shellScale = 0.f;
+	// shells are flat shaded with shadelight and texturing disabled
+	meshUbo.textured = (currententity->flags & (RF_SHELL_RED | RF_SHELL_GREEN | RF_SHELL_BLUE)) ? 0 : 1;
 
 	uint32_t uboOffset;
 	VkDescriptorSet uboDescriptorSet;
 	uint8_t *uboData = QVk_GetUniformBuffer(sizeof(meshUbo), &uboOffset, &uboDescriptorSet);
-	memcpy(meshUbo.model, modelMatrix, sizeof(float) * 16);
 	memcpy(uboData, &meshUbo, sizeof(meshUbo));
 
 	// player configuration screen model is using the UI renderpass
 	int pidx = r_newrefdef.rdflags & RDF_NOWORLDMODEL ? RP_UI : RP_WORLD;
+	// the mesh is a triangle list, so only the "fan" pipelines are needed
 	// non-depth write alias models don't occur with RF_WEAPONMODEL set, so no need for additional left-handed pipelines
-	qvkpipeline_t pipelines[2][4] = { { vk_drawModelPipelineStrip[pidx], vk_drawModelPipelineFan[pidx], vk_drawLefthandModelPipelineStrip, vk_drawLefthandModelPipelineFan },
-									  { vk_drawNoDepthModelPipelineStrip, vk_drawNoDepthModelPipelineFan, vk_drawLefthandModelPipelineStrip, vk_drawLefthandModelPipelineFan } };
-	for (int p = 0; p < 2; p++)
-	{
-		VkDeviceSize vaoSize = sizeof(modelvert) * vertCounts[p];
-		VkBuffer vbo;
-		VkDeviceSize vboOffset;
-		uint8_t *vertData = QVk_GetVertexBuffer(vaoSize, &vbo, &vboOffset);
-		memcpy(vertData, vertList[p], vaoSize);
-
-		QVk_BindPipeline(&pipelines[translucentIdx][p + leftHandOffset]);
-		VkDescriptorSet descriptorSets[] = { skin->vk_texture.descriptorSet, uboDescriptorSet };
-		vkCmdPushConstants(vk_activeCmdbuffer, pipelines[translucentIdx][p + leftHandOffset].layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(r_viewproj_matrix), r_viewproj_matrix);
-		vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[translucentIdx][p + leftHandOffset].layout, 0, 2, descriptorSets, 1, &uboOffset);
-		vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
-
-		if (p == TRIANGLE_STRIP)
-		{
-			for (i = 0; i < pipeCounters[p]; i++)
-			{
-				vkCmdDraw(vk_activeCmdbuffer, drawInfo[p][i].vertexCount, 1, drawInfo[p][i].firstVertex, 0);
-			}
-		}
-		else
-		{
-			vkCmdBindIndexBuffer(vk_activeCmdbuffer, QVk_GetTriangleFanIbo(maxTriangleFanIdxCnt), 0, VK_INDEX_TYPE_UINT16);
-
-			for (i = 0; i < pipeCounters[p]; i++)
-			{
-				vkCmdDrawIndexed(vk_activeCmdbuffer, (drawInfo[p][i].vertexCount - 2) * 3, 1, 0, drawInfo[p][i].firstVertex, 0);
-			}
-		}
-	}
+	qvkpipeline_t pipelines[2][2] = { { vk_drawModelPipelineFan[pidx], vk_drawLefthandModelPipelineFan },
+									  { vk_drawNoDepthModelPipelineFan, vk_drawLefthandModelPipelineFan } };
+	qvkpipeline_t *pipeline = &pipelines[translucentIdx][leftHandOffset];
+
+	// current frame, old frame and texture coordinates all come from the model's buffer
+	VkBuffer vbos[] = { currentmodel->aliasvbo.buffer, currentmodel->aliasvbo.buffer, currentmodel->aliasvbo.buffer };
+	VkDeviceSize vboOffsets[] = { currententity->frame * currentmodel->numaliasverts * sizeof(dtrivertx_t),
+								  currententity->oldframe * currentmodel->numaliasverts * sizeof(dtrivertx_t),
+								  paliashdr->num_frames * currentmodel->numaliasverts * sizeof(dtrivertx_t) };
+
+	QVk_BindPipeline(pipeline);
+	VkDescriptorSet descriptorSets[] = { skin->vk_texture.descriptorSet, uboDescriptorSet, vk_aliasTablesDescSet };
+	vkCmdPushConstants(vk_activeCmdbuffer, pipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(meshPc), &meshPc);
+	vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout, 0, 3, descriptorSets, 1, &uboOffset);
+	vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 3, vbos, vboOffsets);
+	vkCmdBindIndexBuffer(vk_activeCmdbuffer, currentmodel->aliasibo.buffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdDrawIndexed(vk_activeCmdbuffer, currentmodel->numaliasindices, 1, 0, 0, 0);
 }
 
 
@@ -309,7 +359,7 @@ Vk_DrawAliasShadow
 */
 extern	vec3_t			lightspot;
 
-void Vk_DrawAliasShadow (dmdl_t *paliashdr, int posenum, float *modelMatrix)
+void Vk_DrawAliasShadow (dmdl_t *paliashdr, float backlerp, float *modelMatrix)
 {
 	dtrivertx_t	*verts;
 	int		*order;
@@ -317,7 +367,8 @@ void Vk_DrawAliasShadow (dmdl_t *paliashdr, int posenum, float *modelMatrix)
 	float	height, lheight;
 	int		count;
 	int		i;
-	daliasframe_t	*frame;
+	daliasframe_t	*frame, *oldframe;
+	vec3_t	move, frontv, backv;
 	qvkpipeline_t pipelines[2] = { vk_shadowsPipelineStrip, vk_shadowsPipelineFan };
 
 	enum {
@@ -331,6 +382,18 @@ void Vk_DrawAliasShadow (dmdl_t *paliashdr, int posenum, float *modelMatrix)
 		+ currententity->frame * paliashdr->framesize);
 	verts = frame->verts;
 
+	oldframe = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
+		+ currententity->oldframe * paliashdr->framesize);
+
+	// the model itself is lerped on the GPU, the shadow still needs the positions here
+	Vk_AliasFrameMove (frame, oldframe, backlerp, move);
+	for (i=0 ; i<3 ; i++)
+	{
+		frontv[i] = (1.0 - backlerp)*frame->scale[i];
+		backv[i] = backlerp*oldframe->scale[i];
+	}
+	Vk_LerpVerts( paliashdr->num_xyz, verts, oldframe->verts, verts, s_lerped[0], move, frontv, backv );
+
 	height = 0;
 
 	order = (int *)((byte *)paliashdr + paliashdr->ofs_glcmds);
@@ -706,7 +769,7 @@ void R_DrawAliasModel (entity_t *e)
 	if ( ( currententity->flags & RF_WEAPONMODEL ) && ( r_lefthand->value == 1.0F ) )
 	{
 		Mat_Scale(r_viewproj_matrix, -1.f, 1.f, 1.f);
-		leftHandOffset = 2;
+		leftHandOffset = 1;
 	}
 
 	e->angles[PITCH] = -e->angles[PITCH];	// sigh.
@@ -770,6 +833,6 @@ void R_DrawAliasModel (entity_t *e)
 		float model[16];
 		Mat_Identity(model);
 		R_RotateForEntity(e, model);
-		Vk_DrawAliasShadow (paliashdr, currententity->frame, model);
+		Vk_DrawAliasShadow (paliashdr, currententity->backlerp, model);
 	}
 }
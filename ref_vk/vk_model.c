@@ -1037,6 +1037,8 @@ void Mod_LoadAliasModel (model_t *mod, void *buffer)
 			, it_skin, NULL);
 	}
 
+	Vk_BuildAliasMesh (mod, pheader);
+
 	mod->mins[0] = -32;
 	mod->mins[1] = -32;
 	mod->mins[2] = -32;
@@ -1202,6 +1204,8 @@ Mod_Free
 */
 void Mod_Free (model_t *mod)
 {
+	Vk_FreeWorldBuffer (mod);
+	Vk_FreeAliasMesh (mod);
 	Hunk_Free (mod->extradata);
 	memset (mod, 0, sizeof(*mod));
 }
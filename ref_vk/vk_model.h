@@ -90,6 +90,7 @@ typedef struct vkpoly_s
 	struct	vkpoly_s	*chain;
 	int		numverts;
 	int		flags;			// for SURF_UNDERWATER (not needed anymore?)
+	int		firstvert;		// in the static world vertex buffer, -1 if not there
 	float	verts[4][VERTEXSIZE];	// variable sized (xyz s1t1 s2t2)
 } vkpoly_t;
 
@@ -121,7 +122,6 @@ typedef struct msurface_s
 
 	int			lightmaptexturenum;
 	byte		styles[MAXLIGHTMAPS];
-	float		cached_light[MAXLIGHTMAPS];	// values currently used in lightmap
 	byte		*samples;		// [numstyles*surfsize]
 } msurface_t;
 
@@ -239,6 +239,12 @@ typedef struct model_s
 	// for alias models and skins
 	image_t		*skins[MAX_MD2SKINS];
 
+	// alias models: the glcmds as one indexed triangle list, see Vk_BuildAliasMesh
+	int			numaliasverts;
+	int			numaliasindices;
+	qvkbuffer_t	aliasvbo;		// every frame's vertices, then the texture coordinates
+	qvkbuffer_t	aliasibo;
+
 	int			extradatasize;
 	void		*extradata;
 } model_t;
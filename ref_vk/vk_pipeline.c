@@ -20,6 +20,156 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "vk_local.h"
 
+// pipeline cache file header - the driver data is only handed back to the same device and driver
+#define PIPELINE_CACHE_MAGIC	(('C'<<24)+('P'<<16)+('K'<<8)+'V')
+#define PIPELINE_CACHE_VERSION	1
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t  uuid[VK_UUID_SIZE];
+	uint32_t dataSize;
+} pipelinecacheheader_t;
+
+static VkPipelineCache vk_pipelineCache = VK_NULL_HANDLE;
+
+static void PipelineCacheHeader(pipelinecacheheader_t *header, uint32_t dataSize)
+{
+	memset(header, 0, sizeof(*header));
+	header->magic = PIPELINE_CACHE_MAGIC;
+	header->version = PIPELINE_CACHE_VERSION;
+	header->vendorID = vk_device.properties.vendorID;
+	header->deviceID = vk_device.properties.deviceID;
+	header->driverVersion = vk_device.properties.driverVersion;
+	memcpy(header->uuid, vk_device.properties.pipelineCacheUUID, VK_UUID_SIZE);
+	header->dataSize = dataSize;
+}
+
+/*
+** QVk_CreatePipelineCache
+**
+** Creates the pipeline cache, seeded from <gamedir>/vk_pipelines.cache if it
+** was written on this device with this driver version.
+*/
+void QVk_CreatePipelineCache(void)
+{
+	char path[MAX_OSPATH];
+	pipelinecacheheader_t header, expected;
+	void *data = NULL;
+	long fileSize;
+	FILE *f;
+
+	vk_config.pipeline_cache_size = 0;
+
+	Com_sprintf(path, sizeof(path), "%s/vk_pipelines.cache", ri.FS_Gamedir());
+	f = fopen(path, "rb");
+	if (f)
+	{
+		PipelineCacheHeader(&expected, 0);
+
+		// the payload must fill the rest of the file exactly, so a corrupt header can't request a huge allocation
+		fseek(f, 0, SEEK_END);
+		fileSize = ftell(f);
+		fseek(f, 0, SEEK_SET);
+
+		if (fileSize > (long)sizeof(header) && fread(&header, sizeof(header), 1, f) == 1)
+		{
+			expected.dataSize = header.dataSize;
+			if (!memcmp(&header, &expected, sizeof(header)) && header.dataSize > 0 && header.dataSize == (unsigned long)(fileSize - sizeof(header)))
+			{
+				data = malloc(header.dataSize);
+				if (data && fread(data, header.dataSize, 1, f) != 1)
+				{
+					free(data);
+					data = NULL;
+				}
+			}
+		}
+		fclose(f);
+
+		if (!data)
+			ri.Con_Printf(PRINT_ALL, "...discarding stale pipeline cache\n");
+	}
+
+	VkPipelineCacheCreateInfo pcCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.pNext = NULL,
+		.flags = 0,
+		.initialDataSize = data ? header.dataSize : 0,
+		.pInitialData = data
+	};
+
+	VkResult res = vkCreatePipelineCache(vk_device.logical, &pcCreateInfo, NULL, &vk_pipelineCache);
+	if (res != VK_SUCCESS && data)
+	{
+		// the driver refused the data, start over with an empty cache
+		pcCreateInfo.initialDataSize = 0;
+		pcCreateInfo.pInitialData = NULL;
+		res = vkCreatePipelineCache(vk_device.logical, &pcCreateInfo, NULL, &vk_pipelineCache);
+		free(data);
+		data = NULL;
+	}
+
+	if (res != VK_SUCCESS)
+	{
+		ri.Con_Printf(PRINT_ALL, "...could not create pipeline cache: %s\n", QVk_GetError(res));
+		vk_pipelineCache = VK_NULL_HANDLE;
+	}
+	else if (data)
+	{
+		vk_config.pipeline_cache_size = header.dataSize;
+		ri.Con_Printf(PRINT_ALL, "...loaded pipeline cache (%ukB)\n", header.dataSize / 1024);
+	}
+
+	free(data);
+}
+
+/*
+** QVk_DestroyPipelineCache
+**
+** Writes the pipeline cache back to disk and destroys it.
+*/
+void QVk_DestroyPipelineCache(void)
+{
+	char path[MAX_OSPATH];
+	pipelinecacheheader_t header;
+	size_t dataSize = 0;
+	void *data;
+	FILE *f;
+
+	if (vk_pipelineCache == VK_NULL_HANDLE)
+		return;
+
+	if (vkGetPipelineCacheData(vk_device.logical, vk_pipelineCache, &dataSize, NULL) == VK_SUCCESS && dataSize > 0)
+	{
+		data = malloc(dataSize);
+		if (vkGetPipelineCacheData(vk_device.logical, vk_pipelineCache, &dataSize, data) == VK_SUCCESS)
+		{
+			Com_sprintf(path, sizeof(path), "%s/vk_pipelines.cache", ri.FS_Gamedir());
+			f = fopen(path, "wb");
+			if (f)
+			{
+				PipelineCacheHeader(&header, (uint32_t)dataSize);
+				fwrite(&header, sizeof(header), 1, f);
+				fwrite(data, dataSize, 1, f);
+				fclose(f);
+			}
+			else
+			{
+				ri.Con_Printf(PRINT_ALL, "QVk_DestroyPipelineCache(): could not write %s\n", path);
+			}
+		}
+		free(data);
+	}
+
+	vkDestroyPipelineCache(vk_device.logical, vk_pipelineCache, NULL);
+	vk_pipelineCache = VK_NULL_HANDLE;
+}
+
 qvkshader_t QVk_CreateShader(const uint32_t *shaderSrc, size_t shaderCodeSize, VkShaderStageFlagBits shaderStage)
 {
 	qvkshader_t shader;
@@ -191,7 +341,7 @@ void QVk_CreatePipeline(const VkDescriptorSetLayout *descriptorLayout, const uin
 		.basePipelineIndex = -1
 	};
 
-	VK_VERIFY(vkCreateGraphicsPipelines(vk_device.logical, VK_NULL_HANDLE, 1, &pCreateInfo, NULL, &pipeline->pl));
+	VK_VERIFY(vkCreateGraphicsPipelines(vk_device.logical, vk_pipelineCache, 1, &pCreateInfo, NULL, &pipeline->pl));
 	free(ssCreateInfos);
 }
 
@@ -48,6 +48,8 @@ float		v_blend[4];			// final blending color
 void Vk_Strings_f(void);
 void Vk_PollRestart_f(void);
 void Vk_Mem_f(void);
+void Vk_UpdateProfile(void);
+void Vk_CloseProfileLog(void);
 
 //
 // view origin
@@ -114,6 +116,7 @@ cvar_t	*vk_dynamic;
 cvar_t	*vk_msaa;
 cvar_t	*vk_showtris;
 cvar_t	*vk_lightmap;
+cvar_t	*vk_worldbatch;
 cvar_t	*vk_texturemode;
 cvar_t	*vk_lmaptexturemode;
 cvar_t	*vk_aniso;
@@ -122,6 +125,8 @@ cvar_t	*vk_sampleshading;
 cvar_t	*vk_vsync;
 cvar_t	*vk_device_idx;
 cvar_t	*vk_fullscreen_exclusive;
+cvar_t	*vk_profile;
+cvar_t	*vk_profilecsv;
 
 cvar_t	*vid_fullscreen;
 cvar_t	*vid_gamma;
@@ -400,88 +405,63 @@ void R_DrawEntitiesOnList (void)
 /*
 ** Vk_DrawParticles
 **
+** Each particle is a single instance record, the vertex shader expands it into
+** a triangle facing the viewer and looks its color up in the palette.
 */
 void Vk_DrawParticles( int num_particles, const particle_t particles[], const unsigned colortable[768] )
 {
 	const particle_t *p;
 	int				i;
-	vec3_t			up, right;
-	float			scale;
-	byte			color[4];
 
 	if (!num_particles)
 		return;
 
-	VectorScale(vup, 1.5, up);
-	VectorScale(vright, 1.5, right);
-
+	struct {
+		float mvpMatrix[16];
+		float up[4];
+		float right[4];
+		float viewOrigin[4];
+		float viewForward[4];
+	} particlePc;
+
+	memcpy(particlePc.mvpMatrix, r_viewproj_matrix, sizeof(particlePc.mvpMatrix));
+	VectorScale(vup, 1.5, particlePc.up);
+	VectorScale(vright, 1.5, particlePc.right);
+	VectorCopy(r_origin, particlePc.viewOrigin);
+	VectorCopy(vpn, particlePc.viewForward);
+	particlePc.up[3] = particlePc.right[3] = particlePc.viewOrigin[3] = particlePc.viewForward[3] = 0.f;
+
+	// palette index and alpha, the shader reads them as integers
 	typedef struct {
-		float x,y,z,r,g,b,a,u,v;
-	} pvertex;
-	
-	static pvertex visibleParticles[MAX_PARTICLES*3];
+		float x,y,z;
+		byte color, alpha, pad[2];
+	} pinstance;
 
-	for (p = particles, i = 0; i < num_particles; i++, p++)
-	{
-		// hack a scale up to keep particles from disapearing
-		scale = (p->origin[0] - r_origin[0]) * vpn[0] +
-				(p->origin[1] - r_origin[1]) * vpn[1] +
-				(p->origin[2] - r_origin[2]) * vpn[2];
+	// instances are written straight into the dynamic vertex buffer, so there is no upper limit here
+	VkBuffer vbo;
+	VkDeviceSize vboOffset;
+	uint32_t uboOffset;
+	VkDescriptorSet uboDescriptorSet;
+	pinstance *v = (pinstance *)QVk_GetVertexBuffer(sizeof(pinstance) * num_particles, &vbo, &vboOffset);
+	uint8_t *uboData = QVk_GetUniformBuffer(sizeof(unsigned) * 256, &uboOffset, &uboDescriptorSet);
 
-		if (scale < 20)
-			scale = 1;
-		else
-			scale = 1 + scale * 0.004;
-
-		*(int *)color = colortable[p->color];
-
-		int idx = i * 3;
-		float r = color[0] / 255.f;
-		float g = color[1] / 255.f;
-		float b = color[2] / 255.f;
-
-		visibleParticles[idx].x = p->origin[0];
-		visibleParticles[idx].y = p->origin[1];
-		visibleParticles[idx].z = p->origin[2];
-		visibleParticles[idx].r = r;
-		visibleParticles[idx].g = g;
-		visibleParticles[idx].b = b;
-		visibleParticles[idx].a = p->alpha;
-		visibleParticles[idx].u = 0.0625;
-		visibleParticles[idx].v = 0.0625;
-
-		visibleParticles[idx + 1].x = p->origin[0] + up[0] * scale;
-		visibleParticles[idx + 1].y = p->origin[1] + up[1] * scale;
-		visibleParticles[idx + 1].z = p->origin[2] + up[2] * scale;
-		visibleParticles[idx + 1].r = r;
-		visibleParticles[idx + 1].g = g;
-		visibleParticles[idx + 1].b = b;
-		visibleParticles[idx + 1].a = p->alpha;
-		visibleParticles[idx + 1].u = 1.0625;
-		visibleParticles[idx + 1].v = 0.0625;
-
-		visibleParticles[idx + 2].x = p->origin[0] + right[0] * scale;
-		visibleParticles[idx + 2].y = p->origin[1] + right[1] * scale;
-		visibleParticles[idx + 2].z = p->origin[2] + right[2] * scale;
-		visibleParticles[idx + 2].r = r;
-		visibleParticles[idx + 2].g = g;
-		visibleParticles[idx + 2].b = b;
-		visibleParticles[idx + 2].a = p->alpha;
-		visibleParticles[idx + 2].u = 0.0625;
-		visibleParticles[idx + 2].v = 1.0625;
+	for (p = particles, i = 0; i < num_particles; i++, p++, v++)
+	{
+		v->x = p->origin[0];
+		v->y = p->origin[1];
+		v->z = p->origin[2];
+		v->color = p->color;
+		v->alpha = p->alpha * 255;
 	}
 
-	QVk_BindPipeline(&vk_drawParticlesPipeline);
-
-	VkBuffer vbo;
-	VkDeviceSize vboOffset;
-	uint8_t *vertData = QVk_GetVertexBuffer(3 * sizeof(pvertex) * num_particles, &vbo, &vboOffset);
-	memcpy(vertData, &visibleParticles, 3 * sizeof(pvertex) * num_particles);
+	memcpy(uboData, colortable, sizeof(unsigned) * 256);
 
-	vkCmdPushConstants(vk_activeCmdbuffer, vk_drawParticlesPipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(r_viewproj_matrix), r_viewproj_matrix);
-	vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawParticlesPipeline.layout, 0, 1, &r_particletexture->vk_texture.descriptorSet, 0, NULL);
+	VkDescriptorSet descriptorSets[] = { r_particletexture->vk_texture.descriptorSet, uboDescriptorSet };
+	QVk_BindPipeline(&vk_drawParticlesPipeline);
+	vkCmdPushConstants(vk_activeCmdbuffer, vk_drawParticlesPipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(particlePc), &particlePc);
+	vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawParticlesPipeline.layout, 0, 2, descriptorSets, 1, &uboOffset);
 	vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
-	vkCmdDraw(vk_activeCmdbuffer, 3 * num_particles, 1, 0, 0);
+	vkCmdDraw(vk_activeCmdbuffer, 3, num_particles, 0, 0);
 }
 
 /*
@@ -494,14 +474,14 @@ void R_DrawParticles (void)
 	if (vk_point_particles->value)
 	{
 		int i;
-		unsigned char color[4];
 		const particle_t *p;
 
 		if (!r_newrefdef.num_particles)
 			return;
 
 		typedef struct {
-			float x, y, z, r, g, b, a;
+			float x, y, z;
+			byte color[4];
 		} ppoint;
 
 		struct {
@@ -522,35 +502,24 @@ void R_DrawParticles (void)
 		particleUbo.att_b = vk_particle_att_b->value;
 		particleUbo.att_c = vk_particle_att_c->value;
 
-		static ppoint visibleParticles[MAX_PARTICLES];
+		VkBuffer vbo;
+		VkDeviceSize vboOffset;
+		uint32_t uboOffset;
+		VkDescriptorSet uboDescriptorSet;
+		ppoint *v = (ppoint *)QVk_GetVertexBuffer(sizeof(ppoint) * r_newrefdef.num_particles, &vbo, &vboOffset);
+		uint8_t *uboData = QVk_GetUniformBuffer(sizeof(particleUbo), &uboOffset, &uboDescriptorSet);
 
-		for (i = 0, p = r_newrefdef.particles; i < r_newrefdef.num_particles; i++, p++)
+		for (i = 0, p = r_newrefdef.particles; i < r_newrefdef.num_particles; i++, p++, v++)
 		{
-			*(int *)color = d_8to24table[p->color];
-
-			float r = color[0] / 255.f;
-			float g = color[1] / 255.f;
-			float b = color[2] / 255.f;
-
-			visibleParticles[i].x = p->origin[0];
-			visibleParticles[i].y = p->origin[1];
-			visibleParticles[i].z = p->origin[2];
-			visibleParticles[i].r = r;
-			visibleParticles[i].g = g;
-			visibleParticles[i].b = b;
-			visibleParticles[i].a = p->alpha;
+			v->x = p->origin[0];
+			v->y = p->origin[1];
+			v->z = p->origin[2];
+			memcpy(v->color, &d_8to24table[p->color], sizeof(v->color));
+			v->color[3] = p->alpha * 255;
 		}
 
+		memcpy(uboData, &particleUbo, sizeof(particleUbo));
 		QVk_BindPipeline(&vk_drawPointParticlesPipeline);
-
-		VkBuffer vbo;
-		VkDeviceSize vboOffset;
-		uint32_t uboOffset;
-		VkDescriptorSet uboDescriptorSet;
-		uint8_t *vertData = QVk_GetVertexBuffer(sizeof(ppoint) * r_newrefdef.num_particles, &vbo, &vboOffset);
-		uint8_t *uboData  = QVk_GetUniformBuffer(sizeof(particleUbo), &uboOffset, &uboDescriptorSet);
-		memcpy(vertData, &visibleParticles, sizeof(ppoint) * r_newrefdef.num_particles);
-		memcpy(uboData,  &particleUbo, sizeof(particleUbo));
 		vkCmdPushConstants(vk_activeCmdbuffer, vk_drawPointParticlesPipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(r_viewproj_matrix), r_viewproj_matrix);
 		vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPointParticlesPipeline.layout, 0, 1, &uboDescriptorSet, 1, &uboOffset);
 		vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
@@ -885,10 +854,13 @@ void R_RenderView (refdef_t *fd)
 	if (!r_worldmodel && !(r_newrefdef.rdflags & RDF_NOWORLDMODEL))
 		ri.Sys_Error(ERR_DROP, "R_RenderView: NULL worldmodel");
 
+	R_SetupLightStyles();
+
 	if (r_speeds->value)
 	{
 		c_brush_polys = 0;
 		c_alias_polys = 0;
+		c_world_batches = 0;
 	}
 
 	VkRect2D scissor = {
@@ -924,11 +896,12 @@ void R_RenderView (refdef_t *fd)
 
 	if (r_speeds->value)
 	{
-		ri.Con_Printf(PRINT_ALL, "%4i wpoly %4i epoly %i tex %i lmaps\n",
+		ri.Con_Printf(PRINT_ALL, "%4i wpoly %4i epoly %i tex %i lmaps %i batches\n",
 			c_brush_polys,
 			c_alias_polys,
 			c_visible_textures,
-			c_visible_lightmaps);
+			c_visible_lightmaps,
+			c_world_batches);
 	}
 }
 
@@ -939,7 +912,7 @@ void R_EndWorldRenderpass(void)
 		return;
 
 	// finish rendering world view to offsceen buffer
-	vkCmdEndRenderPass(vk_activeCmdbuffer);
+	QVk_EndRenderpass();
 
 	// apply postprocessing effects (underwater view warp if the player is submerged in liquid) to offscreen buffer
 	QVk_BeginRenderpass(RP_WORLD_WARP);
@@ -948,7 +921,7 @@ void R_EndWorldRenderpass(void)
 	vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_worldWarpPipeline.layout, 0, 1, &vk_colorbuffer.descriptorSet, 0, NULL);
 	QVk_BindPipeline(&vk_worldWarpPipeline);
 	vkCmdDraw(vk_activeCmdbuffer, 3, 1, 0, 0);
-	vkCmdEndRenderPass(vk_activeCmdbuffer);
+	QVk_EndRenderpass();
 
 	// start drawing UI
 	QVk_BeginRenderpass(RP_UI);
@@ -1072,6 +1045,7 @@ void R_Register( void )
 	vk_msaa = ri.Cvar_Get("vk_msaa", "0", CVAR_ARCHIVE);
 	vk_showtris = ri.Cvar_Get("vk_showtris", "0", 0);
 	vk_lightmap = ri.Cvar_Get("vk_lightmap", "0", 0);
+	vk_worldbatch = ri.Cvar_Get("vk_worldbatch", "1", 0);
 	vk_texturemode = ri.Cvar_Get("vk_texturemode", "VK_MIPMAP_LINEAR", CVAR_ARCHIVE);
 	vk_lmaptexturemode = ri.Cvar_Get("vk_lmaptexturemode", "VK_MIPMAP_LINEAR", CVAR_ARCHIVE);
 	vk_aniso = ri.Cvar_Get("vk_aniso", "1", CVAR_ARCHIVE);
@@ -1080,6 +1054,8 @@ void R_Register( void )
 	vk_vsync = ri.Cvar_Get("vk_vsync", "0", CVAR_ARCHIVE);
 	vk_device_idx = ri.Cvar_Get("vk_device", "-1", CVAR_ARCHIVE);
 	vk_fullscreen_exclusive = ri.Cvar_Get("vk_fullscreen_exclusive", "1", CVAR_ARCHIVE);
+	vk_profile = ri.Cvar_Get("vk_profile", "0", 0);
+	vk_profilecsv = ri.Cvar_Get("vk_profilecsv", "0", 0);
 	// clamp vk_msaa to accepted range so that video menu doesn't crash on us
 	if (vk_msaa->value < 0)
 		ri.Cvar_Set("vk_msaa", "0");
@@ -1095,6 +1071,7 @@ void R_Register( void )
 	ri.Cmd_AddCommand("vk_strings", Vk_Strings_f);
 	ri.Cmd_AddCommand("vk_restart", Vk_PollRestart_f);
 	ri.Cmd_AddCommand("vk_mem", Vk_Mem_f);
+	ri.Cmd_AddCommand("vk_lightmapbench", R_LightmapBench_f);
 	ri.Cmd_AddCommand("imagelist", Vk_ImageList_f);
 	ri.Cmd_AddCommand("screenshot", Vk_ScreenShot_f);
 }
@@ -1214,10 +1191,12 @@ void R_Shutdown (void)
 {
 	ri.Cmd_RemoveCommand("vk_strings");
 	ri.Cmd_RemoveCommand("vk_mem");
+	ri.Cmd_RemoveCommand("vk_lightmapbench");
 	ri.Cmd_RemoveCommand("vk_restart");
 	ri.Cmd_RemoveCommand("imagelist");
 	ri.Cmd_RemoveCommand("screenshot");
 
+	Vk_CloseProfileLog();
 	vkDeviceWaitIdle(vk_device.logical);
 
 	Mod_FreeAll();
@@ -1316,6 +1295,11 @@ R_EndFrame
 */
 void R_EndFrame( void )
 {
+	// lightmaps changed this frame go into the staging buffers submitted ahead of the frame
+	Vk_UploadLightmapUpdates();
+	// profiler overlay goes on top of everything the client has drawn
+	Vk_UpdateProfile();
+
 	if (QVk_EndFrame(false) != VK_SUCCESS)
 		Vk_PollRestart_f();
 
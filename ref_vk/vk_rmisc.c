@@ -256,6 +256,10 @@ void Vk_Strings_f(void)
 	ri.Con_Printf(PRINT_ALL, "Swapchain image format: %d\n", vk_swapchain.format);
 	ri.Con_Printf(PRINT_ALL, "Swapchain image count: %d\n", vk_config.swapchain_image_count);
 	ri.Con_Printf(PRINT_ALL, "Sampler anisotropy: %s\n", vk_device.features.samplerAnisotropy ? "yes" : "no");
+	if (vk_config.pipeline_cache_size > 0)
+		ri.Con_Printf(PRINT_ALL, "Pipeline creation: %d ms (cache: %ukB)\n", vk_config.pipeline_creation_time, vk_config.pipeline_cache_size / 1024);
+	else
+		ri.Con_Printf(PRINT_ALL, "Pipeline creation: %d ms (no cache)\n", vk_config.pipeline_creation_time);
 	ri.Con_Printf(PRINT_ALL, "Supported present modes:\n");
 
 	i = 0;
@@ -298,18 +302,22 @@ void Vk_PollRestart_f(void)
 void Vk_Mem_f(void)
 {
 	ri.Con_Printf(PRINT_ALL, "\nDynamic buffer stats: \n");
-	ri.Con_Printf(PRINT_ALL, "Vertex : %u/%ukB (%.1f%% max: %ukB)\n",	vk_config.vertex_buffer_usage / 1024,
-																		vk_config.vertex_buffer_size / 1024,
-																		100.f * vk_config.vertex_buffer_usage / vk_config.vertex_buffer_size,
-																		vk_config.vertex_buffer_max_usage / 1024);
-	ri.Con_Printf(PRINT_ALL, "Index  : %u/%uB (%.1f%% max: %uB)\n",		vk_config.index_buffer_usage,
-																		vk_config.index_buffer_size,
-																		100.f * vk_config.index_buffer_usage / vk_config.index_buffer_size,
-																		vk_config.index_buffer_max_usage);
-	ri.Con_Printf(PRINT_ALL, "Uniform: %u/%ukB (%.1f%% max: %ukB)\n",	vk_config.uniform_buffer_usage / 1024,
-																		vk_config.uniform_buffer_size / 1024,
-																		100.f * vk_config.uniform_buffer_usage / vk_config.uniform_buffer_size,
-																		vk_config.uniform_buffer_max_usage / 1024);
+	ri.Con_Printf(PRINT_ALL, "Vertex : %u/%ukB in %u pages (%.1f%% max: %ukB)\n",	vk_config.vertex_buffer_usage / 1024,
+																				vk_config.vertex_buffer_size / 1024,
+																				vk_config.vertex_buffer_pages,
+																				100.f * vk_config.vertex_buffer_usage / vk_config.vertex_buffer_size,
+																				vk_config.vertex_buffer_max_usage / 1024);
+	ri.Con_Printf(PRINT_ALL, "Index  : %u/%ukB in %u pages (%.1f%% max: %ukB)\n",	vk_config.index_buffer_usage / 1024,
+																				vk_config.index_buffer_size / 1024,
+																				vk_config.index_buffer_pages,
+																				100.f * vk_config.index_buffer_usage / vk_config.index_buffer_size,
+																				vk_config.index_buffer_max_usage / 1024);
+	ri.Con_Printf(PRINT_ALL, "Uniform: %u/%ukB in %u pages (%.1f%% max: %ukB)\n",	vk_config.uniform_buffer_usage / 1024,
+																				vk_config.uniform_buffer_size / 1024,
+																				vk_config.uniform_buffer_pages,
+																				100.f * vk_config.uniform_buffer_usage / vk_config.uniform_buffer_size,
+																				vk_config.uniform_buffer_max_usage / 1024);
+	ri.Con_Printf(PRINT_ALL, "Staging: %u buffers (stalls: %u)\n", vk_config.staging_buffer_count, vk_config.staging_buffer_stalls);
 	ri.Con_Printf(PRINT_ALL, "Tri fan: %u/%u (%.1f%% max: %u)\n",	vk_config.triangle_fan_index_usage,
 																	vk_config.triangle_fan_index_count,
 																	100.f * vk_config.triangle_fan_index_usage / vk_config.triangle_fan_index_count,
@@ -322,3 +330,130 @@ void Vk_Mem_f(void)
 																		 vk_config.sampler_descriptor_set_count,
 																		 100.f * vk_config.allocated_sampler_descriptor_set_count / vk_config.sampler_descriptor_set_count);
 }
+
+static FILE		*vk_profilefp = NULL;
+static unsigned	vk_profileFrame = 0;
+
+/*
+** Vk_CloseProfileLog
+*/
+void Vk_CloseProfileLog(void)
+{
+	if (vk_profilefp)
+	{
+		fclose(vk_profilefp);
+		vk_profilefp = NULL;
+	}
+}
+
+/*
+** Vk_ProfileGpuTime
+**
+** Formats a render pass GPU time, which is negative if it wasn't measured.
+*/
+static const char *Vk_ProfileGpuTime(qvkrenderpasstype_t rpType, const char *unavailable)
+{
+	static char	buffers[RP_COUNT][16];
+
+	if (vk_profileStats.gpuTime[rpType] < 0.f)
+		return unavailable;
+
+	Com_sprintf(buffers[rpType], sizeof(buffers[rpType]), "%.3f", vk_profileStats.gpuTime[rpType]);
+	return buffers[rpType];
+}
+
+/*
+** Vk_WriteProfileLog
+**
+** Appends the last completed frame to <gamedir>/vk_profile.csv.
+*/
+static void Vk_WriteProfileLog(void)
+{
+	const qvkprofile_t *stats = &vk_profileStats;
+
+	if (!vk_profilefp)
+	{
+		char name[MAX_OSPATH];
+
+		Com_sprintf(name, sizeof(name), "%s/vk_profile.csv", ri.FS_Gamedir());
+		vk_profilefp = fopen(name, "a");
+		if (!vk_profilefp)
+		{
+			ri.Con_Printf(PRINT_ALL, "Vk_WriteProfileLog: couldn't open %s\n", name);
+			ri.Cvar_Set("vk_profilecsv", "0");
+			return;
+		}
+
+		fseek(vk_profilefp, 0, SEEK_END);
+		if (ftell(vk_profilefp) == 0)
+			fprintf(vk_profilefp, "frame,world_gpu_ms,world_cpu_ms,warp_gpu_ms,warp_cpu_ms,ui_gpu_ms,ui_cpu_ms,draws,pipeline_binds,descriptor_binds,staging_bytes\n");
+	}
+
+	fprintf(vk_profilefp, "%u,%s,%.3f,%s,%.3f,%s,%.3f,%u,%u,%u,%u\n", stats->frame,
+		Vk_ProfileGpuTime(RP_WORLD, ""), stats->cpuTime[RP_WORLD],
+		Vk_ProfileGpuTime(RP_WORLD_WARP, ""), stats->cpuTime[RP_WORLD_WARP],
+		Vk_ProfileGpuTime(RP_UI, ""), stats->cpuTime[RP_UI],
+		stats->drawCalls, stats->pipelineBinds, stats->descriptorBinds, stats->stagingBytes);
+}
+
+/*
+** Vk_DrawProfileString
+*/
+static void Vk_DrawProfileString(int x, int y, const char *str)
+{
+	const float scale = ri.Cvar_Get("hudscale", "1", 0)->value;
+
+	for (; *str; ++str, x += 8 * scale)
+		Draw_Char(x, y, *str);
+}
+
+/*
+** Vk_UpdateProfile
+**
+** Called at the end of every frame while the UI render pass is still open.
+** vk_profile draws the results of the last completed frame in the top right
+** corner, vk_profilecsv logs them. GPU times trail the CPU by NUM_CMDBUFFERS
+** frames and are missing on devices that can't write timestamps (lavapipe),
+** the CPU recording times and counters are always available.
+*/
+void Vk_UpdateProfile(void)
+{
+	const qvkprofile_t *stats = &vk_profileStats;
+	const float scale = ri.Cvar_Get("hudscale", "1", 0)->value;
+	char line[64];
+
+	if (!vk_profilecsv->value)
+		Vk_CloseProfileLog();
+	else if (stats->frame != vk_profileFrame)
+		Vk_WriteProfileLog();
+	vk_profileFrame = stats->frame;
+
+	if (!vk_profile->value || !vk_frameStarted)
+		return;
+
+	const int x = vid.width - 26 * 8 * scale;
+	int y = 8 * scale;
+
+	Vk_DrawProfileString(x, y, "pass      gpu ms   cpu ms");
+	y += 8 * scale;
+	Com_sprintf(line, sizeof(line), "world  %9s %8.3f", Vk_ProfileGpuTime(RP_WORLD, "n/a"), stats->cpuTime[RP_WORLD]);
+	Vk_DrawProfileString(x, y, line);
+	y += 8 * scale;
+	Com_sprintf(line, sizeof(line), "warp   %9s %8.3f", Vk_ProfileGpuTime(RP_WORLD_WARP, "n/a"), stats->cpuTime[RP_WORLD_WARP]);
+	Vk_DrawProfileString(x, y, line);
+	y += 8 * scale;
+	Com_sprintf(line, sizeof(line), "ui     %9s %8.3f", Vk_ProfileGpuTime(RP_UI, "n/a"), stats->cpuTime[RP_UI]);
+	Vk_DrawProfileString(x, y, line);
+	y += 16 * scale;
+	Com_sprintf(line, sizeof(line), "draws       %u", stats->drawCalls);
+	Vk_DrawProfileString(x, y, line);
+	y += 8 * scale;
+	Com_sprintf(line, sizeof(line), "pipelines   %u", stats->pipelineBinds);
+	Vk_DrawProfileString(x, y, line);
+	y += 8 * scale;
+	Com_sprintf(line, sizeof(line), "descriptors %u", stats->descriptorBinds);
+	Vk_DrawProfileString(x, y, line);
+	y += 8 * scale;
+	Com_sprintf(line, sizeof(line), "staging     %ukB", stats->stagingBytes / 1024);
+	Vk_DrawProfileString(x, y, line);
+}
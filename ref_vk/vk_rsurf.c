@@ -32,8 +32,8 @@ msurface_t	*r_alpha_surfaces;
 
 #define LIGHTMAP_BYTES 4
 
-#define	BLOCK_WIDTH		128
-#define	BLOCK_HEIGHT	128
+#define	BLOCK_WIDTH		512
+#define	BLOCK_HEIGHT	512
 
 int		c_visible_lightmaps;
 int		c_visible_textures;
@@ -53,12 +53,43 @@ typedef struct
 
 static vklightmapstate_t vk_lms;
 
+/*
+** Lightmaps rebuilt during a frame are queued here instead of being copied
+** one surface at a time, Vk_UploadLightmapUpdates then sends every lightmap
+** texture's dirty rectangles with a single copy.
+*/
+typedef struct
+{
+	unsigned	lmtex;
+	int			sequence;
+	int			dataOffset;		// in luxels
+	VkRect2D	rect;
+} lmupdate_t;
+
+/*
+** Vertex of a lightmapped polygon, the surface's lightstyle layers lie side
+** by side in the lightmap, lmapLayerStep apart.
+*/
+typedef struct
+{
+	float	vertex[3];
+	float	texCoord[2];
+	float	texCoordLmap[2];
+	float	lmapLayerStep;
+	byte	styles[MAXLIGHTMAPS];
+} lmappolyvert_t;
+
+static lmupdate_t			*lm_updates;
+static qvktextureregion_t	*lm_regions;
+static int					lm_numUpdates, lm_maxUpdates;
+static unsigned				*lm_updateData;
+static int					lm_updateDataUsed, lm_updateDataSize;
+
 
 static void		LM_InitBlock( void );
 static void		LM_UploadBlock( qboolean dynamic );
 static qboolean	LM_AllocBlock (int w, int h, int *x, int *y);
 
-extern void R_SetCacheState( msurface_t *surf );
 extern void R_BuildLightMap (msurface_t *surf, byte *dest, int stride);
 
 /*
@@ -265,6 +296,93 @@ void R_DrawTriangleOutlines (void)
 	}
 }
 
+/*
+** LM_QueueUpdate
+**
+** Returns room for a w*h lightmap that is uploaded to the given lightmap
+** texture at the end of the frame.
+*/
+static unsigned *LM_QueueUpdate( unsigned lmtex, int x, int y, int w, int h )
+{
+	lmupdate_t *u;
+
+	if (lm_numUpdates == lm_maxUpdates)
+	{
+		lm_maxUpdates = lm_maxUpdates ? lm_maxUpdates * 2 : 256;
+		lm_updates = realloc(lm_updates, sizeof(lmupdate_t) * lm_maxUpdates);
+		lm_regions = realloc(lm_regions, sizeof(qvktextureregion_t) * lm_maxUpdates);
+	}
+
+	if (lm_updateDataUsed + w * h > lm_updateDataSize)
+	{
+		lm_updateDataSize = max(lm_updateDataSize * 2, max(lm_updateDataUsed + w * h, BLOCK_WIDTH * BLOCK_HEIGHT / 4));
+		lm_updateData = realloc(lm_updateData, sizeof(unsigned) * lm_updateDataSize);
+	}
+
+	u = &lm_updates[lm_numUpdates];
+	u->lmtex = lmtex;
+	u->sequence = lm_numUpdates++;
+	u->dataOffset = lm_updateDataUsed;
+	u->rect.offset.x = x;
+	u->rect.offset.y = y;
+	u->rect.extent.width = w;
+	u->rect.extent.height = h;
+	lm_updateDataUsed += w * h;
+
+	return lm_updateData + u->dataOffset;
+}
+
+static int LM_UpdateCompare( const void *a, const void *b )
+{
+	const lmupdate_t *ua = (const lmupdate_t *)a;
+	const lmupdate_t *ub = (const lmupdate_t *)b;
+
+	if (ua->lmtex != ub->lmtex)
+		return ua->lmtex < ub->lmtex ? -1 : 1;
+	if (ua->rect.offset.y != ub->rect.offset.y)
+		return ua->rect.offset.y - ub->rect.offset.y;
+	if (ua->rect.offset.x != ub->rect.offset.x)
+		return ua->rect.offset.x - ub->rect.offset.x;
+	return ua->sequence - ub->sequence;
+}
+
+/*
+** Vk_UploadLightmapUpdates
+*/
+void Vk_UploadLightmapUpdates( void )
+{
+	int i, count;
+
+	if (!lm_numUpdates)
+		return;
+
+	qsort(lm_updates, lm_numUpdates, sizeof(lmupdate_t), LM_UpdateCompare);
+
+	for (i = 0; i < lm_numUpdates; )
+	{
+		unsigned lmtex = lm_updates[i].lmtex;
+
+		for (count = 0; i < lm_numUpdates && lm_updates[i].lmtex == lmtex; i++)
+		{
+			const lmupdate_t *u = &lm_updates[i];
+
+			// a surface relit more than once this frame only uploads its latest lightmap,
+			// regions of a single copy command must not overlap
+			if (i + 1 < lm_numUpdates && u[1].lmtex == lmtex && u[1].rect.offset.x == u->rect.offset.x && u[1].rect.offset.y == u->rect.offset.y)
+				continue;
+
+			lm_regions[count].data = (const unsigned char *)(lm_updateData + u->dataOffset);
+			lm_regions[count].rect = u->rect;
+			count++;
+		}
+
+		QVk_UpdateTextureRegions(&vk_state.lightmap_textures[lmtex], lm_regions, count);
+	}
+
+	lm_numUpdates = 0;
+	lm_updateDataUsed = 0;
+}
+
 /*
 ================
 R_RenderBrushPoly
@@ -272,9 +390,7 @@ R_RenderBrushPoly
 */
 void R_RenderBrushPoly (msurface_t *fa, float *modelMatrix, float alpha)
 {
-	int			maps;
 	image_t		*image;
-	qboolean is_dynamic = false;
 	float		color[4] = { 1.f, 1.f, 1.f, alpha };
 	c_brush_polys++;
 
@@ -298,57 +414,9 @@ void R_RenderBrushPoly (msurface_t *fa, float *modelMatrix, float alpha)
 	//PGM
 	//======
 
-	/*
-	** check for lightmap modification
-	*/
-	for (maps = 0; maps < MAXLIGHTMAPS && fa->styles[maps] != 255; maps++)
-	{
-		if (r_newrefdef.lightstyles[fa->styles[maps]].white != fa->cached_light[maps])
-			goto dynamic;
-	}
-
-	// dynamic this frame or dynamic previously
-	if (fa->dlightframe == r_framecount)
-	{
-	dynamic:
-		if (vk_dynamic->value)
-		{
-			if (!(fa->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP)))
-			{
-				is_dynamic = true;
-			}
-		}
-	}
-
-	if (is_dynamic)
-	{
-		if ((fa->styles[maps] >= 32 || fa->styles[maps] == 0) && (fa->dlightframe != r_framecount))
-		{
-			unsigned	temp[34 * 34];
-			int			smax, tmax;
-
-			smax = (fa->extents[0] >> 4) + 1;
-			tmax = (fa->extents[1] >> 4) + 1;
-
-			R_BuildLightMap(fa, (void *)temp, smax * 4);
-			R_SetCacheState(fa);
-
-			QVk_UpdateTextureData(&vk_state.lightmap_textures[fa->lightmaptexturenum], (unsigned char*)temp, fa->light_s, fa->light_t, smax, tmax);
-			
-			fa->lightmapchain = vk_lms.lightmap_surfaces[fa->lightmaptexturenum];
-			vk_lms.lightmap_surfaces[fa->lightmaptexturenum] = fa;
-		}
-		else
-		{
-			fa->lightmapchain = vk_lms.lightmap_surfaces[0];
-			vk_lms.lightmap_surfaces[0] = fa;
-		}
-	}
-	else
-	{
-		fa->lightmapchain = vk_lms.lightmap_surfaces[fa->lightmaptexturenum];
-		vk_lms.lightmap_surfaces[fa->lightmaptexturenum] = fa;
-	}
+	// lightstyles are applied by the lightmapped polygon shader, the chain is for vk_showtris
+	fa->lightmapchain = vk_lms.lightmap_surfaces[fa->lightmaptexturenum];
+	vk_lms.lightmap_surfaces[fa->lightmaptexturenum] = fa;
 }
 
 
@@ -437,30 +505,77 @@ void DrawTextureChains (void)
 }
 
 
+/*
+** Vk_UpdateSurfaceLightmap
+**
+** Lightstyles are applied by the lightmapped polygon shader, only a surface
+** hit by a dynamic light has its lightmap rebuilt on the CPU, into the
+** dynamic lightmap texture. Returns the lightmap texture it is drawn with.
+*/
+static unsigned Vk_UpdateSurfaceLightmap( msurface_t *surf )
+{
+	int		smax, tmax;
+	unsigned lmtex = surf->lightmaptexturenum + DYNLIGHTMAP_OFFSET;
+
+	if (surf->dlightframe != r_framecount || !vk_dynamic->value)
+		return surf->lightmaptexturenum;
+	if (surf->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP))
+		return surf->lightmaptexturenum;
+
+	smax = (surf->extents[0] >> 4) + 1;
+	tmax = (surf->extents[1] >> 4) + 1;
+
+	R_BuildLightMap(surf, (void *)LM_QueueUpdate(lmtex, surf->light_s, surf->light_t, smax, tmax), smax * 4);
+
+	return lmtex;
+}
+
+/*
+** Vk_SetLmapPolyVert
+**
+** Fills a lightmapped polygon vertex from a polygon vertex of surf, the
+** shader reads the surface's lightstyle layers from the lightmap and
+** scales them by the current lightstyles.
+*/
+static void Vk_SetLmapPolyVert( lmappolyvert_t *vert, const float *v, const msurface_t *surf, float scroll )
+{
+	int map;
+
+	vert->vertex[0] = v[0];
+	vert->vertex[1] = v[1];
+	vert->vertex[2] = v[2];
+	vert->texCoord[0] = v[3] + scroll;
+	vert->texCoord[1] = v[4];
+	vert->texCoordLmap[0] = v[5];
+	vert->texCoordLmap[1] = v[6];
+	vert->lmapLayerStep = (float)((surf->extents[0] >> 4) + 1) / BLOCK_WIDTH;
+
+	// without light data the single layer is fullbright
+	for (map = 0; map < MAXLIGHTMAPS; map++)
+		vert->styles[map] = surf->samples ? surf->styles[map] : 255;
+}
+
 static void Vk_RenderLightmappedPoly( msurface_t *surf, float *modelMatrix, float alpha )
 {
 	int		i, nv = surf->polys->numverts;
-	int		map;
 	float	*v;
+	float	scroll = 0.f;
 	image_t *image = R_TextureAnimation(surf->texinfo);
-	qboolean is_dynamic = false;
-	unsigned lmtex = surf->lightmaptexturenum;
+	unsigned lmtex;
 	vkpoly_t *p;
 
-	typedef struct {
-		float vertex[3];
-		float texCoord[2];
-		float texCoordLmap[2];
-	} lmappolyvert;
-
-	static lmappolyvert verts[MAX_VERTS];
+	static lmappolyvert_t verts[MAX_VERTS];
 
 	struct {
 		float model[16];
 		float viewLightmaps;
+		int dynamicLightmap;
 	} lmapPolyUbo;
 
+	lmtex = Vk_UpdateSurfaceLightmap(surf);
+
 	lmapPolyUbo.viewLightmaps = vk_lightmap->value ? 1.f : 0.f;
+	lmapPolyUbo.dynamicLightmap = lmtex >= DYNLIGHTMAP_OFFSET;
 
 	if (modelMatrix)
 	{
@@ -479,196 +594,292 @@ static void Vk_RenderLightmappedPoly( msurface_t *surf, float *modelMatrix, floa
 	uint8_t *uboData = QVk_GetUniformBuffer(sizeof(lmapPolyUbo), &uboOffset, &uboDescriptorSet);
 	memcpy(uboData, &lmapPolyUbo, sizeof(lmapPolyUbo));
 
-	for (map = 0; map < MAXLIGHTMAPS && surf->styles[map] != 255; map++)
+	c_brush_polys++;
+
+	//==========
+	//PGM
+	if (surf->texinfo->flags & SURF_FLOWING)
 	{
-		if (r_newrefdef.lightstyles[surf->styles[map]].white != surf->cached_light[map])
-			goto dynamic;
+		scroll = -64 * ((r_newrefdef.time / 40.0) - (int)(r_newrefdef.time / 40.0));
+		if (scroll == 0.0)
+			scroll = -64.0;
 	}
+	//PGM
+	//==========
+
+	VkDescriptorSet descriptorSets[] = { image->vk_texture.descriptorSet, uboDescriptorSet, vk_state.lightmap_textures[lmtex].descriptorSet, QVk_GetLightStyleDescriptorSet() };
+	vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPolyLmapPipeline.layout, 0, 4, descriptorSets, 1, &uboOffset);
 
-	// dynamic this frame or dynamic previously
-	if (surf->dlightframe == r_framecount)
+	for (p = surf->polys; p; p = p->chain)
 	{
-	dynamic:
-		if (vk_dynamic->value)
-		{
-			if (!(surf->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP)))
-			{
-				is_dynamic = true;
-			}
-		}
+		v = p->verts[0];
+		for (i = 0; i < nv; i++, v += VERTEXSIZE)
+			Vk_SetLmapPolyVert(&verts[i], v, surf, scroll);
+
+		VkBuffer vbo;
+		VkDeviceSize vboOffset;
+		uint8_t *vertData = QVk_GetVertexBuffer(sizeof(lmappolyvert_t) * nv, &vbo, &vboOffset);
+		memcpy(vertData, verts, sizeof(lmappolyvert_t) * nv);
+
+		vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
+		vkCmdBindIndexBuffer(vk_activeCmdbuffer, QVk_GetTriangleFanIbo((nv - 2) * 3), 0, VK_INDEX_TYPE_UINT16);
+		vkCmdDrawIndexed(vk_activeCmdbuffer, (nv - 2) * 3, 1, 0, 0, 0);
 	}
+}
+
+/*
+=============================================================
+
+	STATIC WORLD GEOMETRY
+
+The lightmapped polygons of the world are copied into a device local
+vertex buffer when the map is loaded. Visible surfaces are then only
+queued up, sorted by texture and lightmap and drawn with one indexed
+draw per texture/lightmap pair instead of one upload and draw each.
+
+=============================================================
+*/
+
+typedef struct
+{
+	image_t		*image;
+	unsigned	lmtex;
+	msurface_t	*surf;
+} vkbatchsurf_t;
+
+static qvkbuffer_t		vk_worldVbo;
+static model_t			*vk_worldVboModel;
 
-	if (is_dynamic)
+static vkbatchsurf_t	*vk_batchSurfs;
+static int				vk_numBatchSurfs;
+static int				vk_maxBatchSurfs;
+static int				vk_numBatchIndices;
+
+int		c_world_batches;
+
+/*
+================
+Vk_BuildWorldBuffer
+================
+*/
+static void Vk_BuildWorldBuffer (model_t *m)
+{
+	int			i, j, numverts;
+	msurface_t	*surf;
+	vkpoly_t	*p;
+	lmappolyvert_t *verts, *dst;
+
+	if (vk_worldVboModel)
+		Vk_FreeWorldBuffer(vk_worldVboModel);
+
+	numverts = 0;
+	for (i = 0, surf = m->surfaces; i < m->numsurfaces; i++, surf++)
 	{
-		unsigned	temp[128 * 128];
-		int			smax, tmax;
+		if (surf->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP))
+			continue;
 
-		if ((surf->styles[map] >= 32 || surf->styles[map] == 0) && (surf->dlightframe != r_framecount))
-		{
-			smax = (surf->extents[0] >> 4) + 1;
-			tmax = (surf->extents[1] >> 4) + 1;
+		for (p = surf->polys; p; p = p->chain)
+			numverts += p->numverts;
+	}
 
-			R_BuildLightMap(surf, (void *)temp, smax * 4);
-			R_SetCacheState(surf);
+	if (!numverts)
+		return;
 
-			lmtex = surf->lightmaptexturenum;
-			QVk_UpdateTextureData(&vk_state.lightmap_textures[surf->lightmaptexturenum], (unsigned char *)temp, surf->light_s, surf->light_t, smax, tmax);
-		}
-		else
+	verts = malloc(numverts * sizeof(lmappolyvert_t));
+	dst = verts;
+	numverts = 0;
+	for (i = 0, surf = m->surfaces; i < m->numsurfaces; i++, surf++)
+	{
+		if (surf->texinfo->flags & (SURF_SKY | SURF_TRANS33 | SURF_TRANS66 | SURF_WARP))
+			continue;
+
+		for (p = surf->polys; p; p = p->chain)
 		{
-			smax = (surf->extents[0] >> 4) + 1;
-			tmax = (surf->extents[1] >> 4) + 1;
+			for (j = 0; j < p->numverts; j++)
+				Vk_SetLmapPolyVert(dst++, p->verts[j], surf, 0.f);
+			p->firstvert = numverts;
+			numverts += p->numverts;
+		}
+	}
 
-			R_BuildLightMap(surf, (void *)temp, smax * 4);
+	QVk_CreateVertexBuffer(verts, numverts * sizeof(lmappolyvert_t), &vk_worldVbo, NULL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+	QVk_DebugSetObjectName((uint64_t)vk_worldVbo.buffer, VK_OBJECT_TYPE_BUFFER, va("Static World Buffer: %s", m->name));
+	QVk_DebugSetObjectName((uint64_t)vk_worldVbo.allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: Static World Buffer: %s", m->name));
+	free(verts);
 
-			lmtex = surf->lightmaptexturenum + DYNLIGHTMAP_OFFSET;
-			QVk_UpdateTextureData(&vk_state.lightmap_textures[lmtex], (unsigned char *)temp, surf->light_s, surf->light_t, smax, tmax);
-		}
+	vk_batchSurfs = malloc(m->numsurfaces * sizeof(vkbatchsurf_t));
+	vk_maxBatchSurfs = m->numsurfaces;
+	vk_numBatchSurfs = 0;
+	vk_numBatchIndices = 0;
+	vk_worldVboModel = m;
+}
 
-		c_brush_polys++;
+/*
+================
+Vk_FreeWorldBuffer
 
-		//==========
-		//PGM
-		if (surf->texinfo->flags & SURF_FLOWING)
-		{
-			float scroll;
+Called when a model is freed, only does something for the model that
+owns the static world buffer.
+================
+*/
+void Vk_FreeWorldBuffer (model_t *m)
+{
+	if (!m || m != vk_worldVboModel)
+		return;
 
-			scroll = -64 * ((r_newrefdef.time / 40.0) - (int)(r_newrefdef.time / 40.0));
-			if (scroll == 0.0)
-				scroll = -64.0;
+	// frames in flight may still be reading from it
+	vkDeviceWaitIdle(vk_device.logical);
+	QVk_FreeBuffer(&vk_worldVbo);
+	memset(&vk_worldVbo, 0, sizeof(vk_worldVbo));
+
+	free(vk_batchSurfs);
+	vk_batchSurfs = NULL;
+	vk_maxBatchSurfs = 0;
+	vk_numBatchSurfs = 0;
+	vk_numBatchIndices = 0;
+	vk_worldVboModel = NULL;
+}
 
-			VkBuffer vbo;
-			VkDeviceSize vboOffset;
-			VkDescriptorSet descriptorSets[] = { image->vk_texture.descriptorSet, uboDescriptorSet, vk_state.lightmap_textures[lmtex].descriptorSet };
-			vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPolyLmapPipeline.layout, 0, 3, descriptorSets, 1, &uboOffset);
+static int Vk_BatchSurfCompare (const void *a, const void *b)
+{
+	const vkbatchsurf_t *sa = (const vkbatchsurf_t *)a;
+	const vkbatchsurf_t *sb = (const vkbatchsurf_t *)b;
 
-			for (p = surf->polys; p; p = p->chain)
-			{
-				v = p->verts[0];
-				for (i = 0; i < nv; i++, v += VERTEXSIZE)
-				{
-					verts[i].vertex[0] = v[0];
-					verts[i].vertex[1] = v[1];
-					verts[i].vertex[2] = v[2];
-					verts[i].texCoord[0] = v[3] + scroll;
-					verts[i].texCoord[1] = v[4];
-					verts[i].texCoordLmap[0] = v[5];
-					verts[i].texCoordLmap[1] = v[6];
-				}
+	if (sa->image != sb->image)
+		return (uintptr_t)sa->image < (uintptr_t)sb->image ? -1 : 1;
+	if (sa->lmtex != sb->lmtex)
+		return sa->lmtex < sb->lmtex ? -1 : 1;
 
-				uint8_t *vertData = QVk_GetVertexBuffer(sizeof(lmappolyvert) * nv, &vbo, &vboOffset);
-				memcpy(vertData, verts, sizeof(lmappolyvert) * nv);
+	// keep the draw order stable between frames
+	return sa->surf < sb->surf ? -1 : (sa->surf > sb->surf);
+}
 
-				vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
-				vkCmdBindIndexBuffer(vk_activeCmdbuffer, QVk_GetTriangleFanIbo((nv - 2) * 3), 0, VK_INDEX_TYPE_UINT16);
-				vkCmdDrawIndexed(vk_activeCmdbuffer, (nv - 2) * 3, 1, 0, 0, 0);
-			}
-		}
-		else
-		{
-			VkBuffer vbo;
-			VkDeviceSize vboOffset;
-			VkDescriptorSet descriptorSets[] = { image->vk_texture.descriptorSet, uboDescriptorSet, vk_state.lightmap_textures[lmtex].descriptorSet };
-			vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPolyLmapPipeline.layout, 0, 3, descriptorSets, 1, &uboOffset);
+/*
+================
+Vk_FlushBatchedPolys
 
-			for (p = surf->polys; p; p = p->chain)
-			{
-				v = p->verts[0];
-				for (i = 0; i < nv; i++, v += VERTEXSIZE)
-				{
-					verts[i].vertex[0] = v[0];
-					verts[i].vertex[1] = v[1];
-					verts[i].vertex[2] = v[2];
-					verts[i].texCoord[0] = v[3];
-					verts[i].texCoord[1] = v[4];
-					verts[i].texCoordLmap[0] = v[5];
-					verts[i].texCoordLmap[1] = v[6];
-				}
+Draws everything queued by Vk_DrawLightmappedSurface with the given model
+matrix (NULL for the world).
+================
+*/
+static void Vk_FlushBatchedPolys (float *modelMatrix)
+{
+	int			i, j, first, count;
+	vkbatchsurf_t *b;
+	vkpoly_t	*p;
+	uint32_t	*indices;
 
-				uint8_t *vertData = QVk_GetVertexBuffer(sizeof(lmappolyvert) * nv, &vbo, &vboOffset);
-				memcpy(vertData, verts, sizeof(lmappolyvert) * nv);
+	struct {
+		float model[16];
+		float viewLightmaps;
+		int dynamicLightmap;
+	} lmapPolyUbo;
 
-				vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
-				vkCmdBindIndexBuffer(vk_activeCmdbuffer, QVk_GetTriangleFanIbo((nv - 2) * 3), 0, VK_INDEX_TYPE_UINT16);
-				vkCmdDrawIndexed(vk_activeCmdbuffer, (nv - 2) * 3, 1, 0, 0, 0);
-			}
-		}
-		//PGM
-		//==========
+	if (!vk_numBatchSurfs)
+		return;
+
+	qsort(vk_batchSurfs, vk_numBatchSurfs, sizeof(vkbatchsurf_t), Vk_BatchSurfCompare);
+
+	lmapPolyUbo.viewLightmaps = vk_lightmap->value ? 1.f : 0.f;
+	lmapPolyUbo.dynamicLightmap = 0;
+
+	if (modelMatrix)
+	{
+		memcpy(lmapPolyUbo.model, modelMatrix, sizeof(float) * 16);
 	}
 	else
 	{
-		c_brush_polys++;
+		Mat_Identity(lmapPolyUbo.model);
+	}
 
-		//==========
-		//PGM
-		if (surf->texinfo->flags & SURF_FLOWING)
-		{
-			float scroll;
+	QVk_BindPipeline(&vk_drawPolyLmapPipeline);
+	vkCmdPushConstants(vk_activeCmdbuffer, vk_drawPolyLmapPipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(r_viewproj_matrix), r_viewproj_matrix);
 
-			scroll = -64 * ((r_newrefdef.time / 40.0) - (int)(r_newrefdef.time / 40.0));
-			if (scroll == 0.0)
-				scroll = -64.0;
+	// dynamic lightmaps come already lit, they get their own uniforms when needed
+	uint32_t uboOffset[2];
+	VkDescriptorSet uboDescriptorSet[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+	uint8_t *uboData = QVk_GetUniformBuffer(sizeof(lmapPolyUbo), &uboOffset[0], &uboDescriptorSet[0]);
+	memcpy(uboData, &lmapPolyUbo, sizeof(lmapPolyUbo));
 
-			for (p = surf->polys; p; p = p->chain)
+	VkBuffer ibo;
+	VkDeviceSize iboOffset;
+	VkDeviceSize vboOffset = 0;
+	indices = (uint32_t *)QVk_GetIndexBuffer(vk_numBatchIndices * sizeof(uint32_t), &ibo, &iboOffset);
+
+	vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vk_worldVbo.buffer, &vboOffset);
+	vkCmdBindIndexBuffer(vk_activeCmdbuffer, ibo, iboOffset, VK_INDEX_TYPE_UINT32);
+
+	first = 0;
+	count = 0;
+	for (i = 0, b = vk_batchSurfs; i < vk_numBatchSurfs; i++, b++)
+	{
+		// triangle fans become triangle lists
+		for (p = b->surf->polys; p; p = p->chain)
+		{
+			for (j = 2; j < p->numverts; j++)
 			{
-				v = p->verts[0];
-				for (i = 0; i < nv; i++, v += VERTEXSIZE)
-				{
-					verts[i].vertex[0] = v[0];
-					verts[i].vertex[1] = v[1];
-					verts[i].vertex[2] = v[2];
-					verts[i].texCoord[0] = v[3] + scroll;
-					verts[i].texCoord[1] = v[4];
-					verts[i].texCoordLmap[0] = v[5];
-					verts[i].texCoordLmap[1] = v[6];
-				}
-				VkBuffer vbo;
-				VkDeviceSize vboOffset;
-				uint8_t *vertData = QVk_GetVertexBuffer(sizeof(lmappolyvert) * nv, &vbo, &vboOffset);
-				memcpy(vertData, verts, sizeof(lmappolyvert) * nv);
-
-				VkDescriptorSet descriptorSets[] = { image->vk_texture.descriptorSet, uboDescriptorSet, vk_state.lightmap_textures[lmtex].descriptorSet };
-				vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPolyLmapPipeline.layout, 0, 3, descriptorSets, 1, &uboOffset);
-				vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
-				vkCmdBindIndexBuffer(vk_activeCmdbuffer, QVk_GetTriangleFanIbo((nv - 2) * 3), 0, VK_INDEX_TYPE_UINT16);
-				vkCmdDrawIndexed(vk_activeCmdbuffer, (nv - 2) * 3, 1, 0, 0, 0);
+				*indices++ = p->firstvert;
+				*indices++ = p->firstvert + j - 1;
+				*indices++ = p->firstvert + j;
 			}
+			count += (p->numverts - 2) * 3;
 		}
-		else
+
+		if (i + 1 < vk_numBatchSurfs && b[1].image == b->image && b[1].lmtex == b->lmtex)
+			continue;
+
+		int dynamic = b->lmtex >= DYNLIGHTMAP_OFFSET;
+		if (dynamic && uboDescriptorSet[1] == VK_NULL_HANDLE)
 		{
-			//PGM
-			//==========
-			for (p = surf->polys; p; p = p->chain)
-			{
-				v = p->verts[0];
-				for (i = 0; i < nv; i++, v += VERTEXSIZE)
-				{
-					verts[i].vertex[0] = v[0];
-					verts[i].vertex[1] = v[1];
-					verts[i].vertex[2] = v[2];
-					verts[i].texCoord[0] = v[3];
-					verts[i].texCoord[1] = v[4];
-					verts[i].texCoordLmap[0] = v[5];
-					verts[i].texCoordLmap[1] = v[6];
-				}
-				VkBuffer vbo;
-				VkDeviceSize vboOffset;
-				uint8_t *vertData = QVk_GetVertexBuffer(sizeof(lmappolyvert) * nv, &vbo, &vboOffset);
-				memcpy(vertData, verts, sizeof(lmappolyvert) * nv);
-
-				VkDescriptorSet descriptorSets[] = { image->vk_texture.descriptorSet, uboDescriptorSet, vk_state.lightmap_textures[lmtex].descriptorSet };
-				vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPolyLmapPipeline.layout, 0, 3, descriptorSets, 1, &uboOffset);
-				vkCmdBindVertexBuffers(vk_activeCmdbuffer, 0, 1, &vbo, &vboOffset);
-				vkCmdBindIndexBuffer(vk_activeCmdbuffer, QVk_GetTriangleFanIbo((nv - 2) * 3), 0, VK_INDEX_TYPE_UINT16);
-				vkCmdDrawIndexed(vk_activeCmdbuffer, (nv - 2) * 3, 1, 0, 0, 0);
-			}
-			//==========
-			//PGM
+			lmapPolyUbo.dynamicLightmap = 1;
+			uboData = QVk_GetUniformBuffer(sizeof(lmapPolyUbo), &uboOffset[1], &uboDescriptorSet[1]);
+			memcpy(uboData, &lmapPolyUbo, sizeof(lmapPolyUbo));
 		}
-		//PGM
-		//==========
+
+		VkDescriptorSet descriptorSets[] = { b->image->vk_texture.descriptorSet, uboDescriptorSet[dynamic], vk_state.lightmap_textures[b->lmtex].descriptorSet, QVk_GetLightStyleDescriptorSet() };
+		vkCmdBindDescriptorSets(vk_activeCmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_drawPolyLmapPipeline.layout, 0, 4, descriptorSets, 1, &uboOffset[dynamic]);
+		vkCmdDrawIndexed(vk_activeCmdbuffer, count, 1, first, 0, 0);
+
+		first += count;
+		count = 0;
+		c_world_batches++;
+	}
+
+	vk_numBatchSurfs = 0;
+	vk_numBatchIndices = 0;
+}
+
+/*
+================
+Vk_DrawLightmappedSurface
+
+Queues the surface for Vk_FlushBatchedPolys if it is in the static world
+buffer, scrolling surfaces and vk_worldbatch 0 take the immediate path.
+================
+*/
+static void Vk_DrawLightmappedSurface (msurface_t *surf, float *modelMatrix, float alpha)
+{
+	vkbatchsurf_t *b;
+	vkpoly_t	*p;
+
+	if (!vk_worldbatch->value || !vk_worldVboModel || surf->polys->firstvert < 0 || (surf->texinfo->flags & SURF_FLOWING))
+	{
+		Vk_RenderLightmappedPoly(surf, modelMatrix, alpha);
+		return;
 	}
+
+	if (vk_numBatchSurfs == vk_maxBatchSurfs)
+		Vk_FlushBatchedPolys(modelMatrix);
+
+	b = &vk_batchSurfs[vk_numBatchSurfs++];
+	b->image = R_TextureAnimation(surf->texinfo);
+	b->lmtex = Vk_UpdateSurfaceLightmap(surf);
+	b->surf = surf;
+
+	for (p = surf->polys; p; p = p->chain)
+		vk_numBatchIndices += (p->numverts - 2) * 3;
+
+	c_brush_polys++;
 }
 
 /*
@@ -723,7 +934,7 @@ void R_DrawInlineBModel (float *modelMatrix)
 			}
 			else if (!(psurf->flags & SURF_DRAWTURB) && !vk_showtris->value)
 			{
-				Vk_RenderLightmappedPoly(psurf, modelMatrix, alpha);
+				Vk_DrawLightmappedSurface(psurf, modelMatrix, alpha);
 			}
 			else
 			{
@@ -731,6 +942,8 @@ void R_DrawInlineBModel (float *modelMatrix)
 			}
 		}
 	}
+
+	Vk_FlushBatchedPolys(modelMatrix);
 }
 
 /*
@@ -908,7 +1121,7 @@ void R_RecursiveWorldNode (mnode_t *node)
 		{
 			if (!(surf->flags & SURF_DRAWTURB) && !vk_showtris->value)
 			{
-				Vk_RenderLightmappedPoly(surf, NULL, 1.f);
+				Vk_DrawLightmappedSurface(surf, NULL, 1.f);
 			}
 			else
 			{
@@ -955,6 +1168,7 @@ void R_DrawWorld (void)
 	R_ClearSkyBox ();
 
 	R_RecursiveWorldNode (r_worldmodel->nodes);
+	Vk_FlushBatchedPolys (NULL);
 
 	/*
 	** theoretically nothing should happen in the next two functions
@@ -1156,6 +1370,7 @@ void Vk_BuildPolygonFromSurface(msurface_t *fa)
 	poly = Hunk_Alloc (sizeof(vkpoly_t) + (lnumverts-4) * VERTEXSIZE*sizeof(float));
 	poly->next = fa->polys;
 	poly->flags = fa->flags;
+	poly->firstvert = -1;
 	fa->polys = poly;
 	poly->numverts = lnumverts;
 
@@ -1214,22 +1429,32 @@ Vk_CreateSurfaceLightmap
 */
 void Vk_CreateSurfaceLightmap (msurface_t *surf)
 {
-	int		smax, tmax;
-	byte	*base;
+	int		smax, tmax, size, nummaps, numlayers;
+	int		i, j, map;
+	byte	*base, *dest, *src, fill;
 
 	if (surf->flags & (SURF_DRAWSKY|SURF_DRAWTURB))
 		return;
 
 	smax = (surf->extents[0]>>4)+1;
 	tmax = (surf->extents[1]>>4)+1;
+	size = smax*tmax;
+
+	// every lightstyle layer is stored unscaled, next to the previous one
+	for (nummaps = 0; surf->samples && nummaps < MAXLIGHTMAPS && surf->styles[nummaps] != 255; nummaps++)
+		;
+	numlayers = max(nummaps, 1);
+
+	// full bright if no light data
+	fill = surf->samples ? 0 : 255;
 
-	if ( !LM_AllocBlock( smax, tmax, &surf->light_s, &surf->light_t ) )
+	if ( !LM_AllocBlock( smax*numlayers, tmax, &surf->light_s, &surf->light_t ) )
 	{
 		LM_UploadBlock( false );
 		LM_InitBlock();
-		if ( !LM_AllocBlock( smax, tmax, &surf->light_s, &surf->light_t ) )
+		if ( !LM_AllocBlock( smax*numlayers, tmax, &surf->light_s, &surf->light_t ) )
 		{
-			ri.Sys_Error( ERR_FATAL, "Consecutive calls to LM_AllocBlock(%d,%d) failed\n", smax, tmax );
+			ri.Sys_Error( ERR_FATAL, "Consecutive calls to LM_AllocBlock(%d,%d) failed\n", smax*numlayers, tmax );
 		}
 	}
 
@@ -1238,8 +1463,23 @@ void Vk_CreateSurfaceLightmap (msurface_t *surf)
 	base = vk_lms.lightmap_buffer;
 	base += (surf->light_t * BLOCK_WIDTH + surf->light_s) * LIGHTMAP_BYTES;
 
-	R_SetCacheState( surf );
-	R_BuildLightMap (surf, base, BLOCK_WIDTH*LIGHTMAP_BYTES);
+	for (map = 0; map < numlayers; map++)
+	{
+		src = map < nummaps ? surf->samples + map*size*3 : NULL;
+
+		for (i = 0; i < tmax; i++)
+		{
+			dest = base + (i*BLOCK_WIDTH + map*smax) * LIGHTMAP_BYTES;
+
+			for (j = 0; j < smax; j++, dest += LIGHTMAP_BYTES)
+			{
+				dest[0] = src ? *src++ : fill;
+				dest[1] = src ? *src++ : fill;
+				dest[2] = src ? *src++ : fill;
+				dest[3] = 255;
+			}
+		}
+	}
 }
 
 
@@ -1251,44 +1491,15 @@ Vk_BeginBuildingLightmaps
 */
 void Vk_BeginBuildingLightmaps (model_t *m)
 {
-	static lightstyle_t	lightstyles[MAX_LIGHTSTYLES];
-	int				i;
-	unsigned		dummy[BLOCK_WIDTH * BLOCK_HEIGHT];
-
 	memset(vk_lms.allocated, 0, sizeof(vk_lms.allocated));
 
-	r_framecount = 1;		// no dlightcache
+	// queued updates refer to the previous map's lightmaps
+	lm_numUpdates = 0;
+	lm_updateDataUsed = 0;
 
-	/*
-	** setup the base lightstyles so the lightmaps won't have to be regenerated
-	** the first time they're seen
-	*/
-	for (i = 0; i < MAX_LIGHTSTYLES; i++)
-	{
-		lightstyles[i].rgb[0] = 1;
-		lightstyles[i].rgb[1] = 1;
-		lightstyles[i].rgb[2] = 1;
-		lightstyles[i].white = 3;
-	}
-	r_newrefdef.lightstyles = lightstyles;
+	r_framecount = 1;		// no dlightcache
 
 	vk_lms.current_lightmap_texture = 0;
-
-	/*
-	** initialize the dynamic lightmap textures
-	*/
-	if (vk_state.lightmap_textures[DYNLIGHTMAP_OFFSET].image == VK_NULL_HANDLE)
-	{
-		for (i = DYNLIGHTMAP_OFFSET; i < MAX_LIGHTMAPS*2; i++)
-		{
-			QVVKTEXTURE_CLEAR(vk_state.lightmap_textures[i]);
-			QVk_CreateTexture(&vk_state.lightmap_textures[i], (unsigned char*)dummy, BLOCK_WIDTH, BLOCK_HEIGHT, vk_current_lmap_sampler);
-			QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].image, VK_OBJECT_TYPE_IMAGE, va("Image: dynamic lightmap #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].imageView, VK_OBJECT_TYPE_IMAGE_VIEW, va("Image View: dynamic lightmap #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].descriptorSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, va("Descriptor Set: dynamic lightmap #%d", i));
-			QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: dynamic lightmap #%d", i));
-		}
-	}
 }
 
 /*
@@ -1298,6 +1509,28 @@ Vk_EndBuildingLightmaps
 */
 void Vk_EndBuildingLightmaps (void)
 {
+	int i;
+
 	LM_UploadBlock( false );
+
+	/*
+	** initialize the dynamic lightmap textures, only as many as the map has static ones
+	*/
+	for (i = DYNLIGHTMAP_OFFSET; i < DYNLIGHTMAP_OFFSET + vk_lms.current_lightmap_texture; i++)
+	{
+		if (vk_state.lightmap_textures[i].image != VK_NULL_HANDLE)
+			continue;
+
+		// contents don't matter, dynamic lightmaps are written before they are drawn
+		QVVKTEXTURE_CLEAR(vk_state.lightmap_textures[i]);
+		QVk_CreateTexture(&vk_state.lightmap_textures[i], vk_lms.lightmap_buffer, BLOCK_WIDTH, BLOCK_HEIGHT, vk_current_lmap_sampler);
+		QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].image, VK_OBJECT_TYPE_IMAGE, va("Image: dynamic lightmap #%d", i));
+		QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].imageView, VK_OBJECT_TYPE_IMAGE_VIEW, va("Image View: dynamic lightmap #%d", i));
+		QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].descriptorSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, va("Descriptor Set: dynamic lightmap #%d", i));
+		QVk_DebugSetObjectName((uint64_t)vk_state.lightmap_textures[i].allocInfo.deviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY, va("Memory: dynamic lightmap #%d", i));
+	}
+
+	// the polygons only exist once all faces are loaded
+	Vk_BuildWorldBuffer( currentmodel );
 }
 
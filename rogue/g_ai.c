@@ -1,6 +1,7 @@
 // g_ai.c
 
 #include "g_local.h"
+#include "../game/g_core.h"
 
 qboolean FindTarget (edict_t *self);
 extern cvar_t	*maxclients;
@@ -38,6 +39,9 @@ void AI_SetSightClient (void)
 	edict_t	*ent;
 	int		start, check;
 
+	// visible() results of the last frame are stale now
+	GC_NewVisibleFrame ();
+
 	if (level.sight_client == NULL)
 		start = 1;
 	else
@@ -339,13 +343,14 @@ int range (edict_t *self, edict_t *other)
 
 /*
 =============
-visible
+CheckVisible
 
-returns 1 if the entity is visible to self, even if not infront ()
+traces from the eyes of self to those of other
 =============
 */
-qboolean visible (edict_t *self, edict_t *other)
+static qboolean CheckVisible (void *pself, void *pother)
 {
+	edict_t	*self = pself, *other = pother;
 	vec3_t	spot1;
 	vec3_t	spot2;
 	trace_t	trace;
@@ -354,6 +359,16 @@ qboolean visible (edict_t *self, edict_t *other)
 	spot1[2] += self->viewheight;
 	VectorCopy (other->s.origin, spot2);
 	spot2[2] += other->viewheight;
+
+	// brush models can sit with their origin in solid, where the PVS sees
+	// nothing, but the trace below still accepts hitting them directly
+	if (other->solid != SOLID_BSP && !gi.inPVS (spot1, spot2))
+	{
+		gc_visiblestats.pvsrejects++;
+		return false;
+	}
+
+	gc_visiblestats.traces++;
 	trace = gi.trace (spot1, vec3_origin, vec3_origin, spot2, self, MASK_OPAQUE);
 	
 	if (trace.fraction == 1.0 || trace.ent == other)		// PGM
@@ -361,6 +376,33 @@ qboolean visible (edict_t *self, edict_t *other)
 	return false;
 }
 
+/*
+=============
+visible
+
+returns 1 if the entity is visible to self, even if not infront ()
+=============
+*/
+qboolean visible (edict_t *self, edict_t *other)
+{
+	return GC_Visible (self, self - g_edicts, self->linkcount, other, other - g_edicts, other->linkcount, CheckVisible);
+}
+
+/*
+=============
+AI_PrintVisibleStats
+
+"sv losstats": how visible() calls were answered since the last report
+=============
+*/
+void AI_PrintVisibleStats (void)
+{
+	char	text[256];
+
+	GC_VisibleStatsString (text, sizeof(text));
+	gi.cprintf (NULL, PRINT_HIGH, "%s", text);
+}
+
 
 /*
 =============
@@ -530,6 +530,8 @@ typedef struct
 	float		invincible_framenum;
 	float		double_framenum;
 //ROGUE
+	vec3_t		nav_point;		// where gi.nav_route said to walk to
+	float		nav_time;		// nav_point is asked for again after this
 } monsterinfo_t;
 
 // ROGUE
@@ -871,6 +873,7 @@ int range (edict_t *self, edict_t *other);
 void FoundTarget (edict_t *self);
 qboolean infront (edict_t *self, edict_t *other);
 qboolean visible (edict_t *self, edict_t *other);
+void AI_PrintVisibleStats (void);
 qboolean FacingIdeal(edict_t *self);
 
 //
@@ -1039,6 +1042,7 @@ void fire_doppleganger (edict_t *ent, vec3_t start, vec3_t aimdir);
 //
 // g_spawn.c
 //
+void ED_InitFieldHash (void);
 edict_t *CreateMonster(vec3_t origin, vec3_t angles, char *classname);
 edict_t *CreateFlyMonster (vec3_t origin, vec3_t angles, vec3_t mins, vec3_t maxs, char *classname);
 edict_t *CreateGroundMonster (vec3_t origin, vec3_t angles, vec3_t mins, vec3_t maxs, char *classname, int height);
@@ -247,6 +247,8 @@ void InitGame (void)
 	}
 //ROGUE
 //======
+
+	ED_InitFieldHash ();
 }
 
 //=========================================================
@@ -427,6 +427,63 @@ char *ED_NewString (char *string)
 
 
 
+#define	FIELD_HASH_SIZE	512		// power of two, at least twice the size of fields[]
+
+static field_t	*field_hash[FIELD_HASH_SIZE];
+
+static unsigned ED_HashKey (char *key)
+{
+	unsigned	hash;
+	int			c;
+
+	for (hash = 0 ; *key ; key++)
+	{
+		c = *key;
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		hash = hash * 31 + c;
+	}
+	return hash & (FIELD_HASH_SIZE - 1);
+}
+
+/*
+===============
+ED_InitFieldHash
+
+Called from InitGame.  Spawn keys are looked up through an open addressed
+table instead of scanning fields[] for every key of every entity.  The
+first entry of a name wins, like it did with the scan.
+===============
+*/
+void ED_InitFieldHash (void)
+{
+	field_t		*f;
+	unsigned	h;
+
+	memset (field_hash, 0, sizeof(field_hash));
+
+	for (f=fields ; f->name ; f++)
+	{
+		if (f->flags & FFL_NOSPAWN)
+			continue;
+		for (h = ED_HashKey (f->name) ; field_hash[h] ; h = (h + 1) & (FIELD_HASH_SIZE - 1))
+			if (!Q_stricmp (field_hash[h]->name, f->name))
+				break;
+		if (!field_hash[h])
+			field_hash[h] = f;
+	}
+}
+
+static field_t *ED_FindField (char *key)
+{
+	unsigned	h;
+
+	for (h = ED_HashKey (key) ; field_hash[h] ; h = (h + 1) & (FIELD_HASH_SIZE - 1))
+		if (!Q_stricmp (field_hash[h]->name, key))
+			return field_hash[h];
+	return NULL;
+}
+
 /*
 ===============
 ED_ParseField
@@ -442,45 +499,43 @@ void ED_ParseField (char *key, char *value, edict_t *ent)
 	float	v;
 	vec3_t	vec;
 
-	for (f=fields ; f->name ; f++)
-	{
-		if (!(f->flags & FFL_NOSPAWN) && !Q_stricmp(f->name, key))
-		{	// found it
-			if (f->flags & FFL_SPAWNTEMP)
-				b = (byte *)&st;
-			else
-				b = (byte *)ent;
+	f = ED_FindField (key);
+	if (f)
+	{	// found it
+		if (f->flags & FFL_SPAWNTEMP)
+			b = (byte *)&st;
+		else
+			b = (byte *)ent;
 
-			switch (f->type)
-			{
-			case F_LSTRING:
-				*(char **)(b+f->ofs) = ED_NewString (value);
-				break;
-			case F_VECTOR:
-				sscanf (value, "%f %f %f", &vec[0], &vec[1], &vec[2]);
-				((float *)(b+f->ofs))[0] = vec[0];
-				((float *)(b+f->ofs))[1] = vec[1];
-				((float *)(b+f->ofs))[2] = vec[2];
-				break;
-			case F_INT:
-				*(int *)(b+f->ofs) = atoi(value);
-				break;
-			case F_FLOAT:
-				*(float *)(b+f->ofs) = atof(value);
-				break;
-			case F_ANGLEHACK:
-				v = atof(value);
-				((float *)(b+f->ofs))[0] = 0;
-				((float *)(b+f->ofs))[1] = v;
-				((float *)(b+f->ofs))[2] = 0;
-				break;
-			case F_IGNORE:
-				break;
-			default:
-				break;
-			}
-			return;
+		switch (f->type)
+		{
+		case F_LSTRING:
+			*(char **)(b+f->ofs) = ED_NewString (value);
+			break;
+		case F_VECTOR:
+			sscanf (value, "%f %f %f", &vec[0], &vec[1], &vec[2]);
+			((float *)(b+f->ofs))[0] = vec[0];
+			((float *)(b+f->ofs))[1] = vec[1];
+			((float *)(b+f->ofs))[2] = vec[2];
+			break;
+		case F_INT:
+			*(int *)(b+f->ofs) = atoi(value);
+			break;
+		case F_FLOAT:
+			*(float *)(b+f->ofs) = atof(value);
+			break;
+		case F_ANGLEHACK:
+			v = atof(value);
+			((float *)(b+f->ofs))[0] = 0;
+			((float *)(b+f->ofs))[1] = v;
+			((float *)(b+f->ofs))[2] = 0;
+			break;
+		case F_IGNORE:
+			break;
+		default:
+			break;
 		}
+		return;
 	}
 	gi.dprintf ("%s is not a field\n", key);
 }
@@ -643,6 +698,8 @@ void G_FindTeams (void)
 	gi.dprintf ("%i teams with %i entities\n", c, c2);
 }
 
+#define	CLOCK_MSEC(c)	((c) * 1000.0 / CLOCKS_PER_SEC)
+
 /*
 ==============
 SpawnEntities
@@ -655,10 +712,15 @@ void SpawnEntities (char *mapname, char *entities, char *spawnpoint)
 {
 	edict_t		*ent;
 	int			inhibit;
+	clock_t		start, mark;
+	clock_t		parsetime, spawntime, teamtime;
 	char		*com_token;
 	int			i;
 	float		skill_level;
 
+	start = clock ();
+	parsetime = spawntime = 0;
+
 	skill_level = floor (skill->value);
 	if (skill_level < 0)
 		skill_level = 0;
@@ -698,7 +760,9 @@ void SpawnEntities (char *mapname, char *entities, char *spawnpoint)
 			ent = g_edicts;
 		else
 			ent = G_Spawn ();
+		mark = clock ();
 		entities = ED_ParseEdict (entities, ent);
+		parsetime += clock () - mark;
 
 		// yet another map hack
 		if (!Q_stricmp(level.mapname, "command") && !Q_stricmp(ent->classname, "trigger_once") && !Q_stricmp(ent->model, "*27"))
@@ -775,14 +839,18 @@ void SpawnEntities (char *mapname, char *entities, char *spawnpoint)
 		ent->gravityVector[2] = -1.0;
 #endif
 //PGM
+		mark = clock ();
 		ED_CallSpawn (ent);
+		spawntime += clock () - mark;
 
 		ent->s.renderfx |= RF_IR_VISIBLE;		//PGM
 	}	
 
 	gi.dprintf ("%i entities inhibited\n", inhibit);
 
+	mark = clock ();
 	G_FindTeams ();
+	teamtime = clock () - mark;
 
 	PlayerTrail_Init ();
 
@@ -805,6 +873,9 @@ void SpawnEntities (char *mapname, char *entities, char *spawnpoint)
 			DMGame.PostInitSetup ();
 	}
 // ROGUE
+
+	gi.dprintf ("SpawnEntities: %.1f ms parse, %.1f ms spawn, %.1f ms teams, %.1f ms total\n",
+		CLOCK_MSEC(parsetime), CLOCK_MSEC(spawntime), CLOCK_MSEC(teamtime), CLOCK_MSEC(clock () - start));
 }
 
 
@@ -40,6 +40,28 @@ typedef enum {
 // some qc commands are only valid before the server has finished
 // initializing (precache commands, static sounds / objects, etc)
 
+#define	SV_HISTORY		32		// frames of client positions kept for SV_TraceRewind
+								// must be power of two
+
+// a client edict at the end of a server frame
+typedef struct
+{
+	vec3_t		origin;
+	vec3_t		mins, maxs;
+	qboolean	solid;
+} clienthistory_t;
+
+#define	MAX_CACHED_TRIGGERS	15
+
+// the triggers an entity's box overlapped, see SV_TriggerEdicts
+typedef struct
+{
+	int			generation;		// sv.trigger_generation the list was made in, 0 if none
+	vec3_t		absmin, absmax;
+	short		numtriggers;
+	short		triggers[MAX_CACHED_TRIGGERS];
+} triggercache_t;
+
 typedef struct
 {
 	server_state_t	state;			// precache commands are only valid during load
@@ -64,6 +86,12 @@ typedef struct
 	// demo server information
 	FILE		*demofile;
 	qboolean	timedemo;		// don't time sync
+
+	int			history_framenum[SV_HISTORY];	// frame each row of svs.client_history holds
+
+	int			trigger_generation;			// bumped when the trigger lists change
+	qboolean	trigger_linked[MAX_EDICTS];	// edict is in a trigger list
+	triggercache_t	trigger_cache[MAX_EDICTS];
 } server_t;
 
 #define EDICT_NUM(n) ((edict_t *)((byte *)ge->edicts + ge->edict_size*(n)))
@@ -170,6 +198,8 @@ typedef struct
 	int			next_client_entities;		// next client_entity to use
 	entity_state_t	*client_entities;		// [num_client_entities]
 
+	clienthistory_t	*client_history;		// [SV_HISTORY][maxclients->value]
+
 	int			last_heartbeat;
 
 	challenge_t	challenges[MAX_CHALLENGES];	// to prevent invalid IPs from connecting
@@ -196,6 +226,7 @@ extern	cvar_t		*sv_noreload;			// don't reload level state when reentering
 extern	cvar_t		*sv_airaccelerate;		// don't reload level state when reentering
 											// development tool
 extern	cvar_t		*sv_enforcetime;
+extern	cvar_t		*sv_nav;				// build and use a navigation graph for monsters
 
 extern	client_t	*sv_client;
 extern	edict_t		*sv_player;
@@ -219,6 +250,7 @@ void SV_InitOperatorCommands (void);
 
 void SV_SendServerinfo (client_t *client);
 void SV_UserinfoChanged (client_t *cl);
+void SV_RunGameFrame (void);
 
 
 void Master_Heartbeat (void);
@@ -276,6 +308,13 @@ void SV_WriteFrameToClient (client_t *client, sizebuf_t *msg);
 void SV_RecordDemoMessage (void);
 void SV_BuildClientFrame (client_t *client);
 
+//
+// sv_nav.c
+//
+void SV_InitNav (unsigned checksum);
+void SV_NavBuild_f (void);
+qboolean SV_NavRoute (vec3_t start, vec3_t goal, vec3_t next);
+
 
 void SV_Error (char *error, ...);
 
@@ -318,6 +357,10 @@ int SV_AreaEdicts (vec3_t mins, vec3_t maxs, edict_t **list, int maxcount, int a
 // returns the number of pointers filled in
 // ??? does this always return the world?
 
+int SV_TriggerEdicts (edict_t *ent, edict_t **list, int maxcount);
+// same as SV_AreaEdicts over ent's box with AREA_TRIGGERS, but the list is
+// kept until ent's box changes or something enters or leaves a trigger list
+
 //===================================================================
 
 //
@@ -339,3 +382,13 @@ trace_t SV_Trace (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *p
 
 // passedict is explicitly excluded from clipping checks (normally NULL)
 
+void SV_TraceBatch (traceray_t *rays, int numrays, vec3_t mins, vec3_t maxs, edict_t *passedict, int contentmask);
+// same as calling SV_Trace for each ray, but the entities that can be hit
+// are only looked up once for the bounds of all of them
+
+trace_t SV_TraceRewind (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passedict, int contentmask, int msec);
+// same as SV_Trace, but clients are clipped where they were msec ago
+
+void SV_RecordHistory (void);
+// saves the client positions of the frame that just ran for SV_TraceRewind
+
@@ -181,12 +181,41 @@ void SV_WipeSavegame (char *savename)
 		s = Sys_FindNext( 0, 0 );
 	}
 	Sys_FindClose ();
+	// left behind by a save that was interrupted before SV_CommitFile
+	Com_sprintf (name, sizeof(name), "%s/save/%s/*.tmp", FS_Gamedir (), savename);
+	s = Sys_FindFirst(name, 0, 0 );
+	while (s)
+	{
+		remove (s);
+		s = Sys_FindNext( 0, 0 );
+	}
+	Sys_FindClose ();
+}
+
+
+/*
+================
+SV_CommitFile
+
+Save files are written under a temporary name and moved over the old
+file once complete, so a file is never rewritten in place.  That keeps
+a crash during a save from leaving a torn file behind and is what makes
+it safe for CopyFile to hard link between save directories.
+================
+*/
+void SV_CommitFile (char *tmpname, char *name)
+{
+	if (!Sys_ReplaceFile (tmpname, name))
+		Com_Printf ("Couldn't replace %s\n", name);
 }
 
 
 /*
 ================
 CopyFile
+
+Hard links dst to src when the filesystem supports it, which saves
+reading and writing every level of the unit on each autosave.
 ================
 */
 void CopyFile (char *src, char *dst)
@@ -197,6 +226,11 @@ void CopyFile (char *src, char *dst)
 
 	Com_DPrintf ("CopyFile (%s, %s)\n", src, dst);
 
+	// an old link to src would be truncated along with dst
+	remove (dst);
+	if (Sys_LinkFile (src, dst))
+		return;
+
 	f1 = fopen (src, "rb");
 	if (!f1)
 		return;
@@ -271,46 +305,63 @@ void SV_CopySaveGame (char *src, char *dst)
 
 /*
 ==============
-SV_WriteLevelFile
+SV_WriteLevelFileTo
 
+Saves the current level into the given directory under save/
 ==============
 */
-void SV_WriteLevelFile (void)
+static void SV_WriteLevelFileTo (const char *dir)
 {
-	char	name[MAX_OSPATH];
+	char	name[MAX_OSPATH], tmpname[MAX_OSPATH];
 	FILE	*f;
 
-	Com_DPrintf("SV_WriteLevelFile()\n");
+	Com_DPrintf("SV_WriteLevelFile(%s)\n", dir);
 
-	Com_sprintf (name, sizeof(name), "%s/save/current/%s.sv2", FS_Gamedir(), sv.name);
-	f = fopen(name, "wb");
+	Com_sprintf (name, sizeof(name), "%s/save/%s/%s.sv2", FS_Gamedir(), dir, sv.name);
+	Com_sprintf (tmpname, sizeof(tmpname), "%s.tmp", name);
+	f = fopen(tmpname, "wb");
 	if (!f)
 	{
-		Com_Printf ("Failed to open %s\n", name);
+		Com_Printf ("Failed to open %s\n", tmpname);
 		return;
 	}
 	fwrite (sv.configstrings, sizeof(sv.configstrings), 1, f);
 	CM_WritePortalState (f);
 	fclose (f);
+	SV_CommitFile (tmpname, name);
 
-	Com_sprintf (name, sizeof(name), "%s/save/current/%s.sav", FS_Gamedir(), sv.name);
-	ge->WriteLevel (name);
+	Com_sprintf (name, sizeof(name), "%s/save/%s/%s.sav", FS_Gamedir(), dir, sv.name);
+	Com_sprintf (tmpname, sizeof(tmpname), "%s.tmp", name);
+	ge->WriteLevel (tmpname);
+	SV_CommitFile (tmpname, name);
 }
 
 /*
 ==============
-SV_ReadLevelFile
+SV_WriteLevelFile
 
 ==============
 */
-void SV_ReadLevelFile (void)
+void SV_WriteLevelFile (void)
+{
+	SV_WriteLevelFileTo ("current");
+}
+
+/*
+==============
+SV_ReadLevelFileFrom
+
+Loads the current level back from the given directory under save/
+==============
+*/
+static void SV_ReadLevelFileFrom (const char *dir)
 {
 	char	name[MAX_OSPATH];
 	FILE	*f;
 
-	Com_DPrintf("SV_ReadLevelFile()\n");
+	Com_DPrintf("SV_ReadLevelFile(%s)\n", dir);
 
-	Com_sprintf (name, sizeof(name), "%s/save/current/%s.sv2", FS_Gamedir(), sv.name);
+	Com_sprintf (name, sizeof(name), "%s/save/%s/%s.sv2", FS_Gamedir(), dir, sv.name);
 	f = fopen(name, "rb");
 	if (!f)
 	{
@@ -321,10 +372,21 @@ void SV_ReadLevelFile (void)
 	CM_ReadPortalState (f);
 	fclose (f);
 
-	Com_sprintf (name, sizeof(name), "%s/save/current/%s.sav", FS_Gamedir(), sv.name);
+	Com_sprintf (name, sizeof(name), "%s/save/%s/%s.sav", FS_Gamedir(), dir, sv.name);
 	ge->ReadLevel (name);
 }
 
+/*
+==============
+SV_ReadLevelFile
+
+==============
+*/
+void SV_ReadLevelFile (void)
+{
+	SV_ReadLevelFileFrom ("current");
+}
+
 /*
 ==============
 SV_WriteServerFile
@@ -336,17 +398,19 @@ void SV_WriteServerFile (qboolean autosave)
 	FILE	*f;
 	cvar_t	*var;
 	char	name[MAX_OSPATH], string[128];
+	char	tmpname[MAX_OSPATH], ssvname[MAX_OSPATH];
 	char	comment[32];
 	time_t	aclock;
 	struct tm	*newtime;
 
 	Com_DPrintf("SV_WriteServerFile(%s)\n", autosave ? "true" : "false");
 
-	Com_sprintf (name, sizeof(name), "%s/save/current/server.ssv", FS_Gamedir());
-	f = fopen (name, "wb");
+	Com_sprintf (ssvname, sizeof(ssvname), "%s/save/current/server.ssv", FS_Gamedir());
+	Com_sprintf (tmpname, sizeof(tmpname), "%s.tmp", ssvname);
+	f = fopen (tmpname, "wb");
 	if (!f)
 	{
-		Com_Printf ("Couldn't write %s\n", name);
+		Com_Printf ("Couldn't write %s\n", tmpname);
 		return;
 	}
 	// write the comment field
@@ -392,10 +456,13 @@ void SV_WriteServerFile (qboolean autosave)
 	}
 
 	fclose (f);
+	SV_CommitFile (tmpname, ssvname);
 
 	// write game state
 	Com_sprintf (name, sizeof(name), "%s/save/current/game.ssv", FS_Gamedir());
-	ge->WriteGame (name, autosave);
+	Com_sprintf (tmpname, sizeof(tmpname), "%s.tmp", name);
+	ge->WriteGame (tmpname, autosave);
+	SV_CommitFile (tmpname, name);
 }
 
 /*
@@ -1016,6 +1083,163 @@ void SV_ServerCommand_f (void)
 	ge->ServerCommand();
 }
 
+static int SV_CompareFloats (const void *a, const void *b)
+{
+	float	fa = *(const float *)a, fb = *(const float *)b;
+
+	return fa < fb ? -1 : fa > fb;
+}
+
+/*
+===============
+SV_GameBenchSpawnTarget
+
+Connects a stand-in player in the first client slot, so monsters have a
+sight client to wake up for and chase.  It never sends or receives
+anything, whatever the game writes to it is dropped after each frame.
+===============
+*/
+static client_t *SV_GameBenchSpawnTarget (void)
+{
+	client_t	*cl;
+	char		userinfo[MAX_INFO_STRING];
+
+	cl = svs.clients;
+	memset (cl, 0, sizeof(*cl));
+	cl->edict = EDICT_NUM(1);
+	Netchan_Setup (NS_SERVER, &cl->netchan, net_from, 0);
+	SZ_Init (&cl->datagram, cl->datagram_buf, sizeof(cl->datagram_buf));
+	cl->datagram.allowoverflow = true;
+
+	strcpy (userinfo, "\\name\\gamebench\\skin\\male/grunt\\hand\\2\\ip\\loopback");
+	if (!ge->ClientConnect (cl->edict, userinfo))
+	{
+		memset (cl, 0, sizeof(*cl));
+		return NULL;
+	}
+
+	strncpy (cl->userinfo, userinfo, sizeof(cl->userinfo)-1);
+	SV_UserinfoChanged (cl);
+	cl->state = cs_spawned;
+	ge->ClientBegin (cl->edict);
+
+	// monsters should keep chasing it instead of running out of enemies
+	Cmd_TokenizeString ("god", false);
+	ge->ClientCommand (cl->edict);
+	SZ_Clear (&cl->netchan.message);
+
+	return cl;
+}
+
+/*
+===============
+SV_GameBench_f
+
+"gamebench [frames]" runs that many server frames back to back on the
+current map and prints how long the game module took.  It goes through
+the game export, so it measures whichever mod is loaded the same way.
+The frames go through SV_RunGameFrame like normal ones, but nothing is
+sent out, so it refuses to run with clients connected or a demo being
+recorded.  Outside of deathmatch a stand-in player keeps the monsters
+busy.  The level is saved to save/gamebench first and loaded back
+afterwards, so the game carries on from where the benchmark started.
+===============
+*/
+void SV_GameBench_f (void)
+{
+	client_t	*cl, *target;
+	usercmd_t	cmd;
+	float	*times;
+	double	start, total;
+	int		i, frames;
+	int		framenum, realtime;
+	unsigned	time;
+	int		history_framenum[SV_HISTORY];
+
+	if (sv.state != ss_game || !ge)
+	{
+		Com_Printf ("No game running.\n");
+		return;
+	}
+
+	for (i=0, cl=svs.clients ; i<maxclients->value ; i++, cl++)
+	{
+		if (cl->state >= cs_connected)
+		{
+			Com_Printf ("gamebench can't run with clients connected.\n");
+			return;
+		}
+	}
+
+	if (svs.demofile)
+	{
+		Com_Printf ("gamebench can't run while recording a server demo.\n");
+		return;
+	}
+
+	frames = Cmd_Argc() > 1 ? atoi (Cmd_Argv(1)) : 100;
+	if (frames < 1)
+		frames = 1;
+
+	// snapshot the level and the server's clock
+	FS_CreatePath (va("%s/save/gamebench/", FS_Gamedir()));
+	SV_WriteLevelFileTo ("gamebench");
+	framenum = sv.framenum;
+	time = sv.time;
+	realtime = svs.realtime;
+	memcpy (history_framenum, sv.history_framenum, sizeof(history_framenum));
+
+	target = NULL;
+	if (!Cvar_VariableValue ("deathmatch"))
+		target = SV_GameBenchSpawnTarget ();
+
+	memset (&cmd, 0, sizeof(cmd));
+	cmd.msec = 100;
+
+	times = Z_Malloc (frames * sizeof(*times));
+	total = 0;
+	for (i=0 ; i<frames ; i++)
+	{
+		start = Sys_DoubleTime ();
+		if (target)
+		{
+			// stand still and look around
+			cmd.angles[YAW] = ANGLE2SHORT(i * 10 % 360);
+			ge->ClientThink (target->edict, &cmd);
+		}
+		SV_RunGameFrame ();
+		times[i] = (float)((Sys_DoubleTime () - start) * 1000.0);
+		total += times[i];
+
+		SV_PrepWorldFrame ();
+		if (target)
+		{
+			SZ_Clear (&target->netchan.message);
+			SZ_Clear (&target->datagram);
+		}
+	}
+
+	if (target)
+	{
+		ge->ClientDisconnect (target->edict);
+		memset (target, 0, sizeof(*target));
+	}
+
+	// put everything back the way it was
+	SV_ClearWorld ();
+	SV_ReadLevelFileFrom ("gamebench");
+	sv.framenum = framenum;
+	sv.time = time;
+	svs.realtime = realtime;
+	memcpy (sv.history_framenum, history_framenum, sizeof(history_framenum));
+
+	qsort (times, frames, sizeof(*times), SV_CompareFloats);
+	Com_Printf ("%s %s, %i frames%s: %.3f ms mean, %.3f ms p50, %.3f ms p99, %.3f ms max\n",
+		Cvar_VariableString ("gamename"), sv.name, frames, target ? " with a sight target" : "", total / frames,
+		times[frames / 2], times[frames * 99 / 100], times[frames - 1]);
+	Z_Free (times);
+}
+
 //===========================================================
 
 /*
@@ -1048,5 +1272,7 @@ void SV_InitOperatorCommands (void)
 	Cmd_AddCommand ("killserver", SV_KillServer_f);
 
 	Cmd_AddCommand ("sv", SV_ServerCommand_f);
+	Cmd_AddCommand ("gamebench", SV_GameBench_f);
+	Cmd_AddCommand ("navbuild", SV_NavBuild_f);
 }
 
@@ -342,6 +342,10 @@ void SV_InitGameProgs (void)
 	import.unlinkentity = SV_UnlinkEdict;
 	import.BoxEdicts = SV_AreaEdicts;
 	import.trace = SV_Trace;
+	import.trace_batch = SV_TraceBatch;
+	import.trace_rewind = SV_TraceRewind;
+	import.trigger_edicts = SV_TriggerEdicts;
+	import.nav_route = SV_NavRoute;
 	import.pointcontents = SV_PointContents;
 	import.setmodel = PF_setmodel;
 	import.inPVS = PF_inPVS;
@@ -387,7 +391,7 @@ void SV_InitGameProgs (void)
 
 	if (!ge)
 		Com_Error (ERR_DROP, "failed to load game DLL");
-	if (ge->apiversion != GAME_API_VERSION)
+	if (ge->apiversion < GAME_API_VERSION_MIN || ge->apiversion > GAME_API_VERSION)
 		Com_Error (ERR_DROP, "game is version %i, not %i", ge->apiversion,
 		GAME_API_VERSION);
 
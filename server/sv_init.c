@@ -247,6 +247,9 @@ void SV_SpawnServer (char *server, char *spawnpoint, server_state_t serverstate,
 		sv.models[i+1] = CM_InlineModel (sv.configstrings[CS_MODELS+1+i]);
 	}
 
+	if (serverstate == ss_game)
+		SV_InitNav (checksum);
+
 	//
 	// spawn the rest of the entities on the map
 	//	
@@ -354,6 +357,7 @@ void SV_InitGame (void)
 	svs.clients = Z_Malloc (sizeof(client_t)*maxclients->value);
 	svs.num_client_entities = maxclients->value*UPDATE_BACKUP*64;
 	svs.client_entities = Z_Malloc (sizeof(entity_state_t)*svs.num_client_entities);
+	svs.client_history = Z_Malloc (sizeof(clienthistory_t)*SV_HISTORY*maxclients->value);
 
 	// init network stuff
 	NET_Config ( (maxclients->value > 1) );
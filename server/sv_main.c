@@ -28,6 +28,7 @@ cvar_t	*sv_paused;
 cvar_t	*sv_timedemo;
 
 cvar_t	*sv_enforcetime;
+cvar_t	*sv_nav;				// build and use a navigation graph for monsters
 
 cvar_t	*msg_timeout;			// seconds without any message
 cvar_t	*zombietime;			// seconds to sink messages after disconnect
@@ -746,6 +747,8 @@ void SV_RunGameFrame (void)
 		}
 	}
 
+	SV_RecordHistory ();
+
 	if (host_speeds->value)
 		time_after_game = Sys_Milliseconds ();
 
@@ -966,6 +969,7 @@ void SV_Init (void)
 	sv_paused = Cvar_Get ("paused", "0", 0);
 	sv_timedemo = Cvar_Get ("timedemo", "0", 0);
 	sv_enforcetime = Cvar_Get ("sv_enforcetime", "0", 0);
+	sv_nav = Cvar_Get ("sv_nav", "1", 0);
 	allow_download = Cvar_Get ("allow_download", "1", CVAR_ARCHIVE);
 	allow_download_players  = Cvar_Get ("allow_download_players", "0", CVAR_ARCHIVE);
 	allow_download_models = Cvar_Get ("allow_download_models", "1", CVAR_ARCHIVE);
@@ -1052,6 +1056,8 @@ void SV_Shutdown (char *finalmsg, qboolean reconnect)
 		Z_Free (svs.clients);
 	if (svs.client_entities)
 		Z_Free (svs.client_entities);
+	if (svs.client_history)
+		Z_Free (svs.client_history);
 	if (svs.demofile)
 		fclose (svs.demofile);
 	memset (&svs, 0, sizeof(svs));
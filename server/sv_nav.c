@@ -0,0 +1,688 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+// sv_nav.c -- walkable area graph for monster pathing
+
+/*
+The graph is a set of floor points on a NAV_GRID spaced grid, linked to
+their neighbours in the eight grid directions when a monster sized box
+can step from one to the other the way SV_movestep would let it.  It is
+flood filled through the world model alone, so doors, platforms and
+monsters don't shape it, starting from the player starts, monsters and
+path_corners in the entity string.
+
+The graph is built the first time a map is loaded and saved as
+maps/<mapname>.nav in the game directory, keyed by the map checksum and
+a hash of the entity string.  Game modules ask for the next point of
+the A* path between two positions with gi.nav_route.
+*/
+
+#include "server.h"
+
+#define	NAV_MAGIC		(('V'<<24)+('A'<<16)+('N'<<8)+'Q')
+#define	NAV_VERSION		2
+
+#define	NAV_GRID		32			// spacing of the floor samples
+#define	NAV_STEPSIZE	18			// same as STEPSIZE in m_move.c
+#define	NAV_DROP		256			// how far spawn points are dropped to the floor
+
+#define	MAX_NAV_NODES	8192
+#define	NAV_DIRS		8
+#define	NAV_HASH_SIZE	4096		// must be a power of two
+
+typedef struct
+{
+	vec3_t	origin;					// where a monster standing on the node has its origin
+	short	links[NAV_DIRS];		// node reached by stepping in each grid direction, -1 if none
+} navnode_t;
+
+typedef struct
+{
+	int		magic;
+	int		version;
+	unsigned	checksum;			// of the bsp
+	unsigned	entityhash;
+	int		numnodes;
+} navheader_t;
+
+static const int	nav_dirs[NAV_DIRS][2] = {
+	{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
+};
+
+static vec3_t	nav_mins = {-16, -16, -24};
+static vec3_t	nav_maxs = {16, 16, 32};
+
+static navnode_t	nav_nodes[MAX_NAV_NODES];
+static int			nav_numnodes;
+static unsigned		nav_checksum;
+static unsigned		nav_entityhash;
+
+// nodes sharing a grid column are chained from nav_hash
+static short		nav_hash[NAV_HASH_SIZE];
+static short		nav_hashnext[MAX_NAV_NODES];
+
+// A* state, nav_visit tells which search the other arrays belong to
+static int			nav_search;
+static int			nav_visit[MAX_NAV_NODES];
+static qboolean		nav_closed[MAX_NAV_NODES];
+static float		nav_cost[MAX_NAV_NODES];
+static float		nav_estimate[MAX_NAV_NODES];
+static short		nav_parent[MAX_NAV_NODES];
+static short		nav_heap[MAX_NAV_NODES];
+static short		nav_heappos[MAX_NAV_NODES];
+static int			nav_heapsize;
+
+
+/*
+=============
+SV_NavColumn
+
+Grid column of a position.
+=============
+*/
+static void SV_NavColumn (vec3_t origin, int *x, int *y)
+{
+	*x = (int)floor (origin[0] / NAV_GRID + 0.5);
+	*y = (int)floor (origin[1] / NAV_GRID + 0.5);
+}
+
+static int SV_NavHashColumn (int x, int y)
+{
+	return (x * 73856093 ^ y * 19349663) & (NAV_HASH_SIZE - 1);
+}
+
+static void SV_NavClearHash (void)
+{
+	memset (nav_hash, -1, sizeof(nav_hash));
+}
+
+static void SV_NavHashNode (int n)
+{
+	int		x, y, h;
+
+	SV_NavColumn (nav_nodes[n].origin, &x, &y);
+	h = SV_NavHashColumn (x, y);
+	nav_hashnext[n] = nav_hash[h];
+	nav_hash[h] = n;
+}
+
+/*
+=============
+SV_NavNodeInColumn
+
+Returns the node of column x, y that is within a step of height z, or -1.
+=============
+*/
+static int SV_NavNodeInColumn (int x, int y, float z)
+{
+	int		n, nx, ny;
+
+	for (n = nav_hash[SV_NavHashColumn (x, y)] ; n != -1 ; n = nav_hashnext[n])
+	{
+		SV_NavColumn (nav_nodes[n].origin, &nx, &ny);
+		if (nx == x && ny == y && fabs (nav_nodes[n].origin[2] - z) <= NAV_STEPSIZE)
+			return n;
+	}
+
+	return -1;
+}
+
+/*
+=============
+SV_NavNearestNode
+
+Closest node to origin in its own or a neighbouring column, -1 if there
+is none.  Doesn't trace, so a node behind a thin wall may be returned.
+=============
+*/
+static int SV_NavNearestNode (vec3_t origin)
+{
+	int		x, y, cx, cy, n, nx, ny, best;
+	float	dist, bestdist;
+	vec3_t	v;
+
+	SV_NavColumn (origin, &cx, &cy);
+
+	best = -1;
+	bestdist = 0;
+	for (x = cx - 1 ; x <= cx + 1 ; x++)
+		for (y = cy - 1 ; y <= cy + 1 ; y++)
+			for (n = nav_hash[SV_NavHashColumn (x, y)] ; n != -1 ; n = nav_hashnext[n])
+			{
+				SV_NavColumn (nav_nodes[n].origin, &nx, &ny);
+				if (nx != x || ny != y)
+					continue;
+
+				VectorSubtract (nav_nodes[n].origin, origin, v);
+				v[2] *= 4;		// prefer nodes on the same floor
+				dist = VectorLength (v);
+				if (best == -1 || dist < bestdist)
+				{
+					best = n;
+					bestdist = dist;
+				}
+			}
+
+	return best;
+}
+
+//============================================================================
+
+/*
+=============
+SV_NavDropToFloor
+
+Moves a monster sized box at origin down at most drop units onto the floor.
+=============
+*/
+static qboolean SV_NavDropToFloor (vec3_t origin, float drop, vec3_t floor)
+{
+	trace_t	tr;
+	vec3_t	end;
+
+	VectorCopy (origin, end);
+	end[2] -= drop;
+
+	tr = CM_BoxTrace (origin, end, nav_mins, nav_maxs, 0, MASK_MONSTERSOLID);
+	if (tr.allsolid || tr.startsolid || tr.fraction == 1.0)
+		return false;
+	if (tr.plane.normal[2] < 0.7)
+		return false;		// too steep to stand on
+	if (CM_PointContents (tr.endpos, 0) & (CONTENTS_LAVA|CONTENTS_SLIME))
+		return false;
+
+	VectorCopy (tr.endpos, floor);
+	return true;
+}
+
+/*
+=============
+SV_NavAddNode
+=============
+*/
+static int SV_NavAddNode (vec3_t origin)
+{
+	int		n, i;
+
+	if (nav_numnodes == MAX_NAV_NODES)
+		return -1;
+
+	n = nav_numnodes++;
+	VectorCopy (origin, nav_nodes[n].origin);
+	for (i = 0 ; i < NAV_DIRS ; i++)
+		nav_nodes[n].links[i] = -1;
+	SV_NavHashNode (n);
+
+	return n;
+}
+
+/*
+=============
+SV_NavAddSeed
+
+Adds the floor below a spawn point if it isn't part of the graph yet.
+=============
+*/
+static void SV_NavAddSeed (vec3_t origin)
+{
+	vec3_t	start, floor;
+	int		x, y;
+
+	SV_NavColumn (origin, &x, &y);
+	start[0] = x * NAV_GRID;
+	start[1] = y * NAV_GRID;
+	start[2] = origin[2] + NAV_STEPSIZE;
+
+	if (!SV_NavDropToFloor (start, NAV_DROP, floor))
+		return;
+	if (SV_NavNodeInColumn (x, y, floor[2]) != -1)
+		return;
+
+	SV_NavAddNode (floor);
+}
+
+/*
+=============
+SV_NavAddSeeds
+
+Seeds the graph from the entity string.
+=============
+*/
+static void SV_NavAddSeeds (char *entities)
+{
+	char		*com_token;
+	char		key[MAX_QPATH];
+	char		classname[MAX_QPATH];
+	vec3_t		origin;
+	qboolean	hasorigin;
+
+	while (1)
+	{
+		com_token = COM_Parse (&entities);
+		if (!entities || com_token[0] != '{')
+			break;
+
+		classname[0] = 0;
+		hasorigin = false;
+		while (1)
+		{
+			com_token = COM_Parse (&entities);
+			if (!entities || com_token[0] == '}')
+				break;
+			strncpy (key, com_token, sizeof(key)-1);
+			key[sizeof(key)-1] = 0;
+
+			com_token = COM_Parse (&entities);
+			if (!entities)
+				break;
+
+			if (!strcmp (key, "classname"))
+			{
+				strncpy (classname, com_token, sizeof(classname)-1);
+				classname[sizeof(classname)-1] = 0;
+			}
+			else if (!strcmp (key, "origin"))
+				hasorigin = sscanf (com_token, "%f %f %f", &origin[0], &origin[1], &origin[2]) == 3;
+		}
+
+		if (!hasorigin)
+			continue;
+		if (!strncmp (classname, "monster_", 8)
+			|| !strcmp (classname, "path_corner")
+			|| !strncmp (classname, "info_player_", 12))
+			SV_NavAddSeed (origin);
+	}
+}
+
+/*
+=============
+SV_NavExpand
+
+Links node n to the floor one grid step away in each direction, adding
+the nodes that don't exist yet.  A link needs the box to fit through at
+step height and to find floor within a step on the other side, which is
+what SV_movestep and M_CheckBottom ask of a walking monster.
+=============
+*/
+static void SV_NavExpand (int n)
+{
+	navnode_t	*node;
+	trace_t		tr;
+	vec3_t		start, end, floor;
+	int			i, x, y, next;
+
+	node = &nav_nodes[n];
+	SV_NavColumn (node->origin, &x, &y);
+
+	for (i = 0 ; i < NAV_DIRS ; i++)
+	{
+		VectorCopy (node->origin, start);
+		start[2] += NAV_STEPSIZE;
+		end[0] = (x + nav_dirs[i][0]) * NAV_GRID;
+		end[1] = (y + nav_dirs[i][1]) * NAV_GRID;
+		end[2] = start[2];
+
+		tr = CM_BoxTrace (start, end, nav_mins, nav_maxs, 0, MASK_MONSTERSOLID);
+		if (tr.allsolid || tr.startsolid || tr.fraction < 1.0)
+			continue;
+		if (!SV_NavDropToFloor (end, NAV_STEPSIZE * 2, floor))
+			continue;
+
+		next = SV_NavNodeInColumn (x + nav_dirs[i][0], y + nav_dirs[i][1], floor[2]);
+		if (next == -1)
+			next = SV_NavAddNode (floor);
+		if (next == -1)
+			return;		// out of nodes
+
+		node = &nav_nodes[n];
+		node->links[i] = next;
+	}
+}
+
+/*
+=============
+SV_NavBuild
+
+Flood fills the graph from every place a monster or player can start.
+=============
+*/
+static void SV_NavBuild (void)
+{
+	int		i;
+
+	nav_numnodes = 0;
+	SV_NavClearHash ();
+
+	SV_NavAddSeeds (CM_EntityString ());
+
+	// nodes added while expanding are picked up by the same loop
+	for (i = 0 ; i < nav_numnodes ; i++)
+		SV_NavExpand (i);
+
+	if (nav_numnodes == MAX_NAV_NODES)
+		Com_Printf ("SV_NavBuild: MAX_NAV_NODES hit, graph is incomplete\n");
+}
+
+//============================================================================
+
+/*
+=============
+SV_NavFileName
+=============
+*/
+static void SV_NavFileName (char *name, int size)
+{
+	Com_sprintf (name, size, "%s/maps/%s.nav", FS_Gamedir (), sv.name);
+}
+
+/*
+=============
+SV_NavLoad
+
+Rejects a file that was written for another version of the map or that
+links outside of its own nodes.
+=============
+*/
+static qboolean SV_NavLoad (void)
+{
+	FILE		*f;
+	char		name[MAX_OSPATH];
+	navheader_t	header;
+	int			i, j;
+
+	SV_NavFileName (name, sizeof(name));
+	f = fopen (name, "rb");
+	if (!f)
+		return false;
+
+	if (fread (&header, sizeof(header), 1, f) != 1
+		|| header.magic != NAV_MAGIC || header.version != NAV_VERSION
+		|| header.checksum != nav_checksum || header.entityhash != nav_entityhash
+		|| header.numnodes < 0 || header.numnodes > MAX_NAV_NODES
+		|| fread (nav_nodes, sizeof(navnode_t), header.numnodes, f) != header.numnodes)
+	{
+		fclose (f);
+		return false;
+	}
+	fclose (f);
+
+	for (i = 0 ; i < header.numnodes ; i++)
+		for (j = 0 ; j < NAV_DIRS ; j++)
+			if (nav_nodes[i].links[j] < -1 || nav_nodes[i].links[j] >= header.numnodes)
+			{
+				Com_Printf ("%s has a bad link, rebuilding\n", name);
+				return false;
+			}
+
+	nav_numnodes = header.numnodes;
+	SV_NavClearHash ();
+	for (i = 0 ; i < nav_numnodes ; i++)
+		SV_NavHashNode (i);
+
+	return true;
+}
+
+/*
+=============
+SV_NavSave
+=============
+*/
+static void SV_NavSave (void)
+{
+	FILE		*f;
+	char		name[MAX_OSPATH];
+	navheader_t	header;
+
+	SV_NavFileName (name, sizeof(name));
+	FS_CreatePath (name);
+	f = fopen (name, "wb");
+	if (!f)
+	{
+		Com_Printf ("SV_NavSave: couldn't write %s\n", name);
+		return;
+	}
+
+	header.magic = NAV_MAGIC;
+	header.version = NAV_VERSION;
+	header.checksum = nav_checksum;
+	header.entityhash = nav_entityhash;
+	header.numnodes = nav_numnodes;
+	fwrite (&header, sizeof(header), 1, f);
+	fwrite (nav_nodes, sizeof(navnode_t), nav_numnodes, f);
+	fclose (f);
+}
+
+/*
+=============
+SV_InitNav
+
+Called by SV_SpawnServer once the map is loaded.  Loads the graph of the
+map or builds and saves it if there is none for this map and entity
+string yet.
+=============
+*/
+void SV_InitNav (unsigned checksum)
+{
+	unsigned	hash;
+	char		*s;
+
+	// FNV-1a
+	hash = 2166136261u;
+	for (s = CM_EntityString () ; *s ; s++)
+		hash = (hash ^ (byte)*s) * 16777619u;
+	nav_entityhash = hash;
+	nav_checksum = checksum;
+
+	nav_numnodes = 0;
+	SV_NavClearHash ();
+
+	if (!sv_nav->value)
+		return;
+	if (SV_NavLoad ())
+		return;
+
+	SV_NavBuild ();
+	SV_NavSave ();
+	Com_DPrintf ("%i navigation nodes\n", nav_numnodes);
+}
+
+/*
+=============
+SV_NavBuild_f
+
+"navbuild" rebuilds and saves the graph of the current map.
+=============
+*/
+void SV_NavBuild_f (void)
+{
+	int		i, j, links;
+
+	if (sv.state != ss_game)
+	{
+		Com_Printf ("No map loaded.\n");
+		return;
+	}
+
+	SV_NavBuild ();
+	SV_NavSave ();
+
+	for (i = 0, links = 0 ; i < nav_numnodes ; i++)
+		for (j = 0 ; j < NAV_DIRS ; j++)
+			if (nav_nodes[i].links[j] != -1)
+				links++;
+
+	Com_Printf ("%i navigation nodes, %i links\n", nav_numnodes, links);
+}
+
+//============================================================================
+
+static void SV_NavHeapSwap (int a, int b)
+{
+	short	t;
+
+	t = nav_heap[a];
+	nav_heap[a] = nav_heap[b];
+	nav_heap[b] = t;
+	nav_heappos[nav_heap[a]] = a;
+	nav_heappos[nav_heap[b]] = b;
+}
+
+static void SV_NavHeapUp (int i)
+{
+	while (i > 0 && nav_estimate[nav_heap[(i - 1) / 2]] > nav_estimate[nav_heap[i]])
+	{
+		SV_NavHeapSwap (i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+static int SV_NavHeapPop (void)
+{
+	int		n, i, child;
+
+	n = nav_heap[0];
+	nav_heap[0] = nav_heap[--nav_heapsize];
+	nav_heappos[nav_heap[0]] = 0;
+
+	for (i = 0 ; (child = i * 2 + 1) < nav_heapsize ; i = child)
+	{
+		if (child + 1 < nav_heapsize && nav_estimate[nav_heap[child + 1]] < nav_estimate[nav_heap[child]])
+			child++;
+		if (nav_estimate[nav_heap[i]] <= nav_estimate[nav_heap[child]])
+			break;
+		SV_NavHeapSwap (i, child);
+	}
+
+	return n;
+}
+
+/*
+=============
+SV_NavFindPath
+
+A* search from node start to node goal.  Fills path with up to maxpath
+nodes of the way, starting with the one after start, and returns how many
+nodes the whole path has, 0 if start is goal and -1 if goal can't be
+reached.  Open nodes are in the heap once, a cheaper route moves them up
+in place.
+=============
+*/
+static int SV_NavFindPath (int start, int goal, int *path, int maxpath)
+{
+	navnode_t	*node;
+	vec3_t		v;
+	float		cost;
+	int			n, i, next, length;
+
+	if (start < 0 || start >= nav_numnodes || goal < 0 || goal >= nav_numnodes)
+		return -1;
+	if (start == goal)
+		return 0;
+
+	nav_search++;
+	nav_heapsize = 0;
+
+	nav_visit[start] = nav_search;
+	nav_closed[start] = false;
+	nav_cost[start] = 0;
+	VectorSubtract (nav_nodes[goal].origin, nav_nodes[start].origin, v);
+	nav_estimate[start] = VectorLength (v);
+	nav_parent[start] = -1;
+	nav_heappos[start] = 0;
+	nav_heap[nav_heapsize++] = start;
+
+	while (nav_heapsize)
+	{
+		n = SV_NavHeapPop ();
+		nav_closed[n] = true;
+
+		if (n == goal)
+			break;
+
+		node = &nav_nodes[n];
+		for (i = 0 ; i < NAV_DIRS ; i++)
+		{
+			next = node->links[i];
+			if (next == -1)
+				continue;
+
+			VectorSubtract (nav_nodes[next].origin, node->origin, v);
+			cost = nav_cost[n] + VectorLength (v);
+
+			if (nav_visit[next] == nav_search && (nav_closed[next] || cost >= nav_cost[next]))
+				continue;
+
+			VectorSubtract (nav_nodes[goal].origin, nav_nodes[next].origin, v);
+			nav_estimate[next] = cost + VectorLength (v);
+			nav_cost[next] = cost;
+			nav_parent[next] = n;
+
+			if (nav_visit[next] == nav_search)
+			{
+				// already open, decrease its key
+				SV_NavHeapUp (nav_heappos[next]);
+				continue;
+			}
+
+			nav_visit[next] = nav_search;
+			nav_closed[next] = false;
+			nav_heappos[next] = nav_heapsize;
+			nav_heap[nav_heapsize] = next;
+			SV_NavHeapUp (nav_heapsize++);
+		}
+	}
+
+	if (nav_visit[goal] != nav_search || !nav_closed[goal])
+		return -1;
+
+	for (length = 0, n = goal ; n != start ; n = nav_parent[n])
+		length++;
+
+	// walk back from the goal, keeping the first maxpath nodes
+	for (i = length, n = goal ; n != start ; n = nav_parent[n])
+		if (--i < maxpath)
+			path[i] = n;
+
+	return length;
+}
+
+/*
+=============
+SV_NavRoute
+
+gi.nav_route: sets next to the first node to walk to on the way from start
+to goal.  Returns false if there is no graph or sv_nav is off, either end is off the graph,
+no path connects them or start is already at the goal's node.
+=============
+*/
+qboolean SV_NavRoute (vec3_t start, vec3_t goal, vec3_t next)
+{
+	int		from, to, node;
+
+	if (!nav_numnodes || !sv_nav->value)
+		return false;
+
+	from = SV_NavNearestNode (start);
+	to = SV_NavNearestNode (goal);
+	if (SV_NavFindPath (from, to, &node, 1) < 1)
+		return false;
+
+	VectorCopy (nav_nodes[node].origin, next);
+	return true;
+}
@@ -57,6 +57,7 @@ float	*area_mins, *area_maxs;
 edict_t	**area_list;
 int		area_count, area_maxcount;
 int		area_type;
+qboolean	area_deactivated;		// also return SOLID_NOT edicts that are still linked
 
 int SV_HullForEntity (edict_t *ent);
 
@@ -138,6 +139,9 @@ void SV_ClearWorld (void)
 	memset (sv_areanodes, 0, sizeof(sv_areanodes));
 	sv_numareanodes = 0;
 	SV_CreateAreaNode (0, sv.models[1]->mins, sv.models[1]->maxs);
+
+	memset (sv.trigger_linked, 0, sizeof(sv.trigger_linked));
+	sv.trigger_generation++;
 }
 
 
@@ -149,10 +153,19 @@ SV_UnlinkEdict
 */
 void SV_UnlinkEdict (edict_t *ent)
 {
+	int		num;
+
 	if (!ent->area.prev)
 		return;		// not linked in anywhere
 	RemoveLink (&ent->area);
 	ent->area.prev = ent->area.next = NULL;
+
+	num = NUM_FOR_EDICT(ent);
+	if (sv.trigger_linked[num])
+	{
+		sv.trigger_linked[num] = false;
+		sv.trigger_generation++;
+	}
 }
 
 
@@ -339,7 +352,11 @@ void SV_LinkEdict (edict_t *ent)
 	
 	// link it in	
 	if (ent->solid == SOLID_TRIGGER)
+	{
 		InsertLinkBefore (&ent->area, &node->trigger_edicts);
+		sv.trigger_linked[NUM_FOR_EDICT(ent)] = true;
+		sv.trigger_generation++;
+	}
 	else
 		InsertLinkBefore (&ent->area, &node->solid_edicts);
 
@@ -371,7 +388,7 @@ void SV_AreaEdicts_r (areanode_t *node)
 		next = l->next;
 		check = EDICT_FROM_AREA(l);
 
-		if (check->solid == SOLID_NOT)
+		if (check->solid == SOLID_NOT && !area_deactivated)
 			continue;		// deactivated
 		if (check->absmin[0] > area_maxs[0]
 		|| check->absmin[1] > area_maxs[1]
@@ -422,6 +439,64 @@ int SV_AreaEdicts (vec3_t mins, vec3_t maxs, edict_t **list,
 }
 
 
+/*
+================
+SV_TriggerEdicts
+
+Entities standing still look up the same triggers every frame.  The
+triggers overlapping ent's box are kept per entity and reused until ent
+gets a different box or anything is linked into or out of a trigger
+list.  Deactivated triggers are kept too and filtered out here, so a
+trigger changing its solid without relinking gives the same result as
+walking the area nodes would.
+================
+*/
+int SV_TriggerEdicts (edict_t *ent, edict_t **list, int maxcount)
+{
+	triggercache_t	*cache;
+	edict_t			*all[MAX_EDICTS];
+	edict_t			*check;
+	int				i, num, count;
+
+	cache = &sv.trigger_cache[NUM_FOR_EDICT(ent)];
+
+	if (cache->generation != sv.trigger_generation
+		|| !VectorCompare (cache->absmin, ent->absmin)
+		|| !VectorCompare (cache->absmax, ent->absmax))
+	{
+		area_deactivated = true;
+		num = SV_AreaEdicts (ent->absmin, ent->absmax, all, MAX_EDICTS, AREA_TRIGGERS);
+		area_deactivated = false;
+
+		if (num > MAX_CACHED_TRIGGERS)
+		{	// too many to keep, hand them out this once
+			cache->generation = 0;
+			for (i=count=0 ; i<num && count<maxcount ; i++)
+				if (all[i]->solid != SOLID_NOT)
+					list[count++] = all[i];
+			return count;
+		}
+
+		cache->generation = sv.trigger_generation;
+		VectorCopy (ent->absmin, cache->absmin);
+		VectorCopy (ent->absmax, cache->absmax);
+		cache->numtriggers = num;
+		for (i=0 ; i<num ; i++)
+			cache->triggers[i] = NUM_FOR_EDICT(all[i]);
+	}
+
+	for (i=count=0 ; i<cache->numtriggers && count<maxcount ; i++)
+	{
+		check = EDICT_NUM(cache->triggers[i]);
+		if (check->solid == SOLID_NOT)
+			continue;		// deactivated
+		list[count++] = check;
+	}
+
+	return count;
+}
+
+
 //===========================================================================
 
 /*
@@ -511,21 +586,82 @@ int SV_HullForEntity (edict_t *ent)
 
 /*
 ====================
-SV_ClipMoveToEntities
+SV_ClipIgnores
 
+True if the move passes through touch no matter where it is
 ====================
 */
-void SV_ClipMoveToEntities ( moveclip_t *clip )
+qboolean SV_ClipIgnores ( moveclip_t *clip, edict_t *touch )
+{
+	if (touch == clip->passedict)
+		return true;
+	if (clip->passedict)
+	{
+	 	if (touch->owner == clip->passedict)
+			return true;	// don't clip against own missiles
+		if (clip->passedict->owner == touch)
+			return true;	// don't clip against owner
+	}
+
+	if ( !(clip->contentmask & CONTENTS_DEADMONSTER)
+	&& (touch->svflags & SVF_DEADMONSTER) )
+			return true;
+
+	return false;
+}
+
+/*
+====================
+SV_ClipMoveToHull
+
+Does the exact clip against touch with its hull placed at origin, and
+keeps the result if it is closer than what the move has hit so far.
+====================
+*/
+void SV_ClipMoveToHull ( moveclip_t *clip, edict_t *touch, int headnode, vec3_t origin, vec3_t angles )
 {
-	int			i, num;
-	edict_t		*touchlist[MAX_EDICTS], *touch;
 	trace_t		trace;
+
+	if (touch->svflags & SVF_MONSTER)
+		trace = CM_TransformedBoxTrace (clip->start, clip->end,
+			clip->mins2, clip->maxs2, headnode, clip->contentmask,
+			origin, angles);
+	else
+		trace = CM_TransformedBoxTrace (clip->start, clip->end,
+			clip->mins, clip->maxs, headnode,  clip->contentmask,
+			origin, angles);
+
+	if (trace.allsolid || trace.startsolid ||
+	trace.fraction < clip->trace.fraction)
+	{
+		trace.ent = touch;
+	 	if (clip->trace.startsolid)
+		{
+			clip->trace = trace;
+			clip->trace.startsolid = true;
+		}
+		else
+			clip->trace = trace;
+	}
+	else if (trace.startsolid)
+		clip->trace.startsolid = true;
+}
+
+/*
+====================
+SV_ClipMoveToTouchList
+
+touchlist may hold entities outside of the move's bounds when it is
+shared by several moves, those are skipped like SV_AreaEdicts would.
+====================
+*/
+void SV_ClipMoveToTouchList ( moveclip_t *clip, edict_t **touchlist, int num )
+{
+	int			i;
+	edict_t		*touch;
 	int			headnode;
 	float		*angles;
 
-	num = SV_AreaEdicts (clip->boxmins, clip->boxmaxs, touchlist
-		, MAX_EDICTS, AREA_SOLID);
-
 	// be careful, it is possible to have an entity in this
 	// list removed before we get to it (killtriggered)
 	for (i=0 ; i<num ; i++)
@@ -533,21 +669,19 @@ void SV_ClipMoveToEntities ( moveclip_t *clip )
 		touch = touchlist[i];
 		if (touch->solid == SOLID_NOT)
 			continue;
+		if (touch->absmin[0] > clip->boxmaxs[0]
+		|| touch->absmin[1] > clip->boxmaxs[1]
+		|| touch->absmin[2] > clip->boxmaxs[2]
+		|| touch->absmax[0] < clip->boxmins[0]
+		|| touch->absmax[1] < clip->boxmins[1]
+		|| touch->absmax[2] < clip->boxmins[2] )
+			continue;		// not touched by this move
 		if (touch == clip->passedict)
 			continue;
 		if (clip->trace.allsolid)
 			return;
-		if (clip->passedict)
-		{
-		 	if (touch->owner == clip->passedict)
-				continue;	// don't clip against own missiles
-			if (clip->passedict->owner == touch)
-				continue;	// don't clip against owner
-		}
-
-		if ( !(clip->contentmask & CONTENTS_DEADMONSTER)
-		&& (touch->svflags & SVF_DEADMONSTER) )
-				continue;
+		if (SV_ClipIgnores (clip, touch))
+			continue;
 
 		// might intersect, so do an exact clip
 		headnode = SV_HullForEntity (touch);
@@ -555,32 +689,27 @@ void SV_ClipMoveToEntities ( moveclip_t *clip )
 		if (touch->solid != SOLID_BSP)
 			angles = vec3_origin;	// boxes don't rotate
 
-		if (touch->svflags & SVF_MONSTER)
-			trace = CM_TransformedBoxTrace (clip->start, clip->end,
-				clip->mins2, clip->maxs2, headnode, clip->contentmask,
-				touch->s.origin, angles);
-		else
-			trace = CM_TransformedBoxTrace (clip->start, clip->end,
-				clip->mins, clip->maxs, headnode,  clip->contentmask,
-				touch->s.origin, angles);
-
-		if (trace.allsolid || trace.startsolid ||
-		trace.fraction < clip->trace.fraction)
-		{
-			trace.ent = touch;
-		 	if (clip->trace.startsolid)
-			{
-				clip->trace = trace;
-				clip->trace.startsolid = true;
-			}
-			else
-				clip->trace = trace;
-		}
-		else if (trace.startsolid)
-			clip->trace.startsolid = true;
+		SV_ClipMoveToHull (clip, touch, headnode, touch->s.origin, angles);
 	}
 }
 
+/*
+====================
+SV_ClipMoveToEntities
+
+====================
+*/
+void SV_ClipMoveToEntities ( moveclip_t *clip )
+{
+	int			num;
+	edict_t		*touchlist[MAX_EDICTS];
+
+	num = SV_AreaEdicts (clip->boxmins, clip->boxmaxs, touchlist
+		, MAX_EDICTS, AREA_SOLID);
+
+	SV_ClipMoveToTouchList (clip, touchlist, num);
+}
+
 
 /*
 ==================
@@ -658,3 +787,261 @@ trace_t SV_Trace (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *p
 	return clip.trace;
 }
 
+/*
+==================
+SV_TraceBatch
+
+Traces each ray like SV_Trace.  The area node tree is only walked once,
+for the bounds of every ray that got past the world, and each of those
+rays is then clipped against the part of the list its own bounds touch.
+That gives the same entities in the same order as a query per ray.
+==================
+*/
+void SV_TraceBatch (traceray_t *rays, int numrays, vec3_t mins, vec3_t maxs, edict_t *passedict, int contentmask)
+{
+	moveclip_t	clip;
+	edict_t		*touchlist[MAX_EDICTS];
+	vec3_t		batchmins, batchmaxs;
+	int			i, j, num, clipped;
+
+	if (!mins)
+		mins = vec3_origin;
+	if (!maxs)
+		maxs = vec3_origin;
+
+	memset ( &clip, 0, sizeof ( moveclip_t ) );
+
+	clip.contentmask = contentmask;
+	clip.mins = mins;
+	clip.maxs = maxs;
+	clip.passedict = passedict;
+
+	VectorCopy (mins, clip.mins2);
+	VectorCopy (maxs, clip.maxs2);
+
+	// clip to world
+	clipped = 0;
+	for (i=0 ; i<numrays ; i++)
+	{
+		rays[i].trace = CM_BoxTrace (rays[i].start, rays[i].end, mins, maxs, 0, contentmask);
+		rays[i].trace.ent = ge->edicts;
+		if (rays[i].trace.fraction == 0)
+			continue;		// blocked by the world
+
+		SV_TraceBounds ( rays[i].start, clip.mins2, clip.maxs2, rays[i].end, clip.boxmins, clip.boxmaxs );
+		if (!clipped++)
+		{
+			VectorCopy (clip.boxmins, batchmins);
+			VectorCopy (clip.boxmaxs, batchmaxs);
+			continue;
+		}
+
+		for (j=0 ; j<3 ; j++)
+		{
+			if (clip.boxmins[j] < batchmins[j])
+				batchmins[j] = clip.boxmins[j];
+			if (clip.boxmaxs[j] > batchmaxs[j])
+				batchmaxs[j] = clip.boxmaxs[j];
+		}
+	}
+
+	if (!clipped)
+		return;
+
+	num = SV_AreaEdicts (batchmins, batchmaxs, touchlist, MAX_EDICTS, AREA_SOLID);
+
+	// clip to other solid entities
+	for (i=0 ; i<numrays ; i++)
+	{
+		if (rays[i].trace.fraction == 0)
+			continue;
+
+		clip.start = rays[i].start;
+		clip.end = rays[i].end;
+		clip.trace = rays[i].trace;
+		SV_TraceBounds ( clip.start, clip.mins2, clip.maxs2, clip.end, clip.boxmins, clip.boxmaxs );
+
+		SV_ClipMoveToTouchList ( &clip, touchlist, num );
+
+		rays[i].trace = clip.trace;
+	}
+}
+
+/*
+==================
+SV_RecordHistory
+
+Called after every game frame.  The client edicts are the only ones that
+get rewound, so only their hulls are kept.
+==================
+*/
+void SV_RecordHistory (void)
+{
+	clienthistory_t	*h;
+	edict_t			*ent;
+	int				i, row;
+
+	if (!svs.client_history)
+		return;
+
+	row = sv.framenum & (SV_HISTORY-1);
+	sv.history_framenum[row] = sv.framenum;
+
+	h = &svs.client_history[row * (int)maxclients->value];
+	for (i=0 ; i<maxclients->value ; i++, h++)
+	{
+		ent = EDICT_NUM(i+1);
+		h->solid = ent->inuse && ent->area.prev
+			&& ent->solid != SOLID_NOT && ent->solid != SOLID_TRIGGER;
+		VectorCopy (ent->s.origin, h->origin);
+		VectorCopy (ent->mins, h->mins);
+		VectorCopy (ent->maxs, h->maxs);
+	}
+}
+
+/*
+==================
+SV_HistoryRow
+
+Returns the recorded client hulls of frame, or NULL if it isn't kept
+==================
+*/
+clienthistory_t *SV_HistoryRow (int frame)
+{
+	int		row;
+
+	if (frame <= 0)
+		return NULL;
+	row = frame & (SV_HISTORY-1);
+	if (sv.history_framenum[row] != frame)
+		return NULL;
+	return &svs.client_history[row * (int)maxclients->value];
+}
+
+/*
+==================
+SV_TraceRewind
+
+Traces like SV_Trace, except that the client edicts are clipped at the
+position they had msec before the newest recorded frame, which is what a
+client with that much latency was looking at.  The position is lerped
+between the two frames around that time and is never older than
+SV_HISTORY frames.  Nothing gets relinked: the rewound hulls are boxes
+clipped directly, so the cost doesn't grow with the number of shots.
+==================
+*/
+trace_t SV_TraceRewind (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passedict, int contentmask, int msec)
+{
+	moveclip_t	clip;
+	edict_t		*touchlist[MAX_EDICTS];
+	edict_t		*touch;
+	clienthistory_t	*oldrow, *newrow, *old, *new;
+	vec3_t		origin, absmin, absmax;
+	float		frac;
+	int			i, j, num, count, clients, latest, frame, time, headnode;
+
+	if (!svs.client_history || msec <= 0)
+		return SV_Trace (start, mins, maxs, end, passedict, contentmask);
+
+	// client commands run after the frame was recorded, the game frame before
+	latest = sv.framenum;
+	if (!SV_HistoryRow (latest))
+		latest--;
+
+	time = latest*100 - msec;
+	if (time < (latest - SV_HISTORY + 1)*100)
+		time = (latest - SV_HISTORY + 1)*100;
+	frame = time / 100;
+	frac = (time - frame*100) * 0.01;
+
+	oldrow = SV_HistoryRow (frame);
+	newrow = SV_HistoryRow (frame+1);
+	if (!newrow || frac == 0)
+	{
+		newrow = oldrow;
+		frac = 0;
+	}
+	if (!oldrow)
+		oldrow = newrow;
+	if (!newrow)	// nothing recorded yet this map
+		return SV_Trace (start, mins, maxs, end, passedict, contentmask);
+
+	if (!mins)
+		mins = vec3_origin;
+	if (!maxs)
+		maxs = vec3_origin;
+
+	memset ( &clip, 0, sizeof ( moveclip_t ) );
+
+	// clip to world
+	clip.trace = CM_BoxTrace (start, end, mins, maxs, 0, contentmask);
+	clip.trace.ent = ge->edicts;
+	if (clip.trace.fraction == 0)
+		return clip.trace;		// blocked by the world
+
+	clip.contentmask = contentmask;
+	clip.start = start;
+	clip.end = end;
+	clip.mins = mins;
+	clip.maxs = maxs;
+	clip.passedict = passedict;
+
+	VectorCopy (mins, clip.mins2);
+	VectorCopy (maxs, clip.maxs2);
+
+	SV_TraceBounds ( start, clip.mins2, clip.maxs2, end, clip.boxmins, clip.boxmaxs );
+
+	// clip to everything but the clients as they are now
+	clients = maxclients->value;
+	num = SV_AreaEdicts (clip.boxmins, clip.boxmaxs, touchlist, MAX_EDICTS, AREA_SOLID);
+	for (i=count=0 ; i<num ; i++)
+	{
+		j = NUM_FOR_EDICT(touchlist[i]);
+		if (j >= 1 && j <= clients)
+			continue;
+		touchlist[count++] = touchlist[i];
+	}
+	SV_ClipMoveToTouchList ( &clip, touchlist, count );
+
+	// and to the clients where they were
+	for (i=0 ; i<clients ; i++)
+	{
+		if (clip.trace.allsolid)
+			break;
+
+		old = &oldrow[i];
+		new = &newrow[i];
+		if (!new->solid)
+			continue;
+
+		touch = EDICT_NUM(i+1);
+		if (SV_ClipIgnores (&clip, touch))
+			continue;
+
+		// don't lerp across a respawn or teleport
+		if (!old->solid || fabs(new->origin[0] - old->origin[0]) > 64
+			|| fabs(new->origin[1] - old->origin[1]) > 64
+			|| fabs(new->origin[2] - old->origin[2]) > 64)
+			old = new;
+
+		for (j=0 ; j<3 ; j++)
+		{
+			origin[j] = old->origin[j] + (new->origin[j] - old->origin[j]) * frac;
+			absmin[j] = origin[j] + new->mins[j] - 1;
+			absmax[j] = origin[j] + new->maxs[j] + 1;
+		}
+
+		if (absmin[0] > clip.boxmaxs[0]
+		|| absmin[1] > clip.boxmaxs[1]
+		|| absmin[2] > clip.boxmaxs[2]
+		|| absmax[0] < clip.boxmins[0]
+		|| absmax[1] < clip.boxmins[1]
+		|| absmax[2] < clip.boxmins[2] )
+			continue;		// not touched by this move
+
+		headnode = CM_HeadnodeForBox (new->mins, new->maxs);
+		SV_ClipMoveToHull (&clip, touch, headnode, origin, vec3_origin);
+	}
+
+	return clip.trace;
+}
@@ -1,21 +1,34 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(location = 0) in vec3 inVertex;
-layout(location = 1) in vec4 inColor;
+// frame vertices are raw dtrivertx_t: compressed position and light normal index
+layout(location = 0) in uvec4 inVertex;
+layout(location = 1) in uvec4 inOldVertex;
 layout(location = 2) in vec2 inTexCoord;
 
 layout(push_constant) uniform PushConstant
 {
     mat4 vpMatrix;
+    vec4 move;          // w: backlerp
+    vec4 frontScale;
+    vec4 backScale;
 } pc;
 
 layout(set = 1, binding = 0) uniform UniformBufferObject
 {
     mat4 model;
+    vec4 shadelight;    // w: alpha
+    float shellScale;
+    int shadedots;
     int textured;
 } ubo;
 
+layout(set = 2, binding = 0) readonly buffer AliasTables
+{
+    vec4 normals[162];
+    float dots[16 * 256];
+} tables;
+
 layout(location = 0) out vec4 color;
 layout(location = 1) out vec2 texCoord;
 layout(location = 2) out int textured;
@@ -25,8 +38,12 @@ out gl_PerVertex {
 };
 
 void main() {
-    gl_Position = pc.vpMatrix * ubo.model * vec4(inVertex, 1.0);
-    color = inColor;
+    vec3 v = mix(pc.frontScale.xyz * vec3(inVertex.xyz), pc.backScale.xyz * vec3(inOldVertex.xyz), pc.move.w);
+    vec3 pos = pc.move.xyz + v + tables.normals[inVertex.w].xyz * ubo.shellScale;
+    gl_Position = pc.vpMatrix * ubo.model * vec4(pos, 1.0);
+
+    float l = tables.dots[ubo.shadedots * 256 + int(inVertex.w)];
+    color = vec4((ubo.textured != 0 ? l : 1.0) * ubo.shadelight.rgb, ubo.shadelight.a);
     texCoord = inTexCoord;
     textured = ubo.textured;
 }
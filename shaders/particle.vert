@@ -1,15 +1,24 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(location = 0) in vec3 inVertex;
-layout(location = 1) in vec4 inColor;
-layout(location = 2) in vec2 inTexCoord;
+// one instance per particle, the three corners of its triangle come from gl_VertexIndex
+layout(location = 0) in vec3 inOrigin;
+layout(location = 1) in uvec4 inColor; // x: palette index, y: alpha
 
 layout(push_constant) uniform PushConstant
 {
     mat4 mvpMatrix;
+    vec4 up;
+    vec4 right;
+    vec4 viewOrigin;
+    vec4 viewForward;
 } pc;
 
+layout(set = 1, binding = 0) uniform UniformBufferObject
+{
+    uvec4 palette[64];
+} ubo;
+
 layout(location = 0) out vec2 texCoord;
 layout(location = 1) out vec4 color;
 layout(location = 2) out float aTreshold;
@@ -19,8 +28,17 @@ out gl_PerVertex {
 };
 
 void main() {
-    gl_Position = pc.mvpMatrix * vec4(inVertex, 1.0);
-    texCoord = inTexCoord;
-    color = inColor;
+    vec2 corner = vec2(gl_VertexIndex == 1, gl_VertexIndex == 2);
+
+    // hack a scale up to keep particles from disapearing
+    float scale = dot(inOrigin - pc.viewOrigin.xyz, pc.viewForward.xyz);
+    scale = scale < 20.0 ? 1.0 : 1.0 + scale * 0.004;
+
+    vec3 pos = inOrigin + (pc.up.xyz * corner.x + pc.right.xyz * corner.y) * scale;
+    gl_Position = pc.mvpMatrix * vec4(pos, 1.0);
+    texCoord = corner + vec2(0.0625);
+
+    uint rgba = ubo.palette[inColor.x >> 2][inColor.x & 3];
+    color = vec4(uvec4(rgba, rgba >> 8, rgba >> 16, inColor.y) & 0xff) / 255.0;
     aTreshold = 0.0;
 }
@@ -6,12 +6,25 @@ layout(set = 2, binding = 0) uniform sampler2D sLightmap;
 layout(location = 0) in vec2 texCoord;
 layout(location = 1) in vec2 texCoordLmap;
 layout(location = 2) in float viewLightmaps;
+layout(location = 3) in flat float lmapLayerStep;
+layout(location = 4) in flat vec3 styleScale[4];
 
 layout(location = 0) out vec4 fragmentColor;
 
 void main()
 {
     vec4 color = texture(sTexture, texCoord);
-    vec4 light = texture(sLightmap, texCoordLmap);
+
+    // the lightstyle layers of a surface sit side by side, switched off and missing ones add nothing
+    vec3 rgb = texture(sLightmap, texCoordLmap).rgb * styleScale[0];
+    for (int i = 1; i < 4; i++)
+    {
+        if (styleScale[i] != vec3(0.0))
+            rgb += texture(sLightmap, texCoordLmap + vec2(lmapLayerStep * i, 0.0)).rgb * styleScale[i];
+    }
+
+    // rescale if the brightest channel exceeds 1.0, alpha is the brightest channel
+    float brightest = max(rgb.r, max(rgb.g, rgb.b));
+    vec4 light = vec4(rgb / max(brightest, 1.0), min(brightest, 1.0));
     fragmentColor = (1.0 - viewLightmaps) * color * light + viewLightmaps * light;
 }
@@ -4,6 +4,8 @@
 layout(location = 0) in vec3 inVertex;
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec2 inTexCoordLmap;
+layout(location = 3) in float inLmapLayerStep; // width of one lightstyle layer in the lightmap
+layout(location = 4) in uvec4 inStyles;        // 255: no layer
 
 layout(push_constant) uniform PushConstant
 {
@@ -14,11 +16,19 @@ layout(set = 1, binding = 0) uniform UniformBufferObject
 {
     mat4 model;
     float viewLightmaps;
+    int dynamicLightmap;
 } ubo;
 
+layout(set = 3, binding = 0) readonly buffer LightStyles
+{
+    vec4 scales[256];
+} lightstyles;
+
 layout(location = 0) out vec2 texCoord;
 layout(location = 1) out vec2 texCoordLmap;
 layout(location = 2) out float viewLightmaps;
+layout(location = 3) out flat float lmapLayerStep;
+layout(location = 4) out flat vec3 styleScale[4];
 
 out gl_PerVertex {
     vec4 gl_Position;
@@ -29,4 +39,10 @@ void main() {
     texCoord = inTexCoord;
     texCoordLmap = inTexCoordLmap;
     viewLightmaps = ubo.viewLightmaps;
+    lmapLayerStep = inLmapLayerStep;
+
+    // lightmaps combined on the CPU (dynamic lights) and surfaces without light data only have a first layer, used as is
+    uvec4 styles = ubo.dynamicLightmap != 0 ? uvec4(255) : inStyles;
+    for (int i = 0; i < 4; i++)
+        styleScale[i] = styles[i] != 255 ? lightstyles.scales[styles[i]].rgb : vec3(i == 0 ? 1.0 : 0.0);
 }
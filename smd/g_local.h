@@ -602,6 +602,8 @@ typedef struct
 	float		visibility;		// Ratio of visibility (it's a fog thang)
 
 //end Lazarus
+	vec3_t		nav_point;		// where gi.nav_route said to walk to
+	float		nav_time;		// nav_point is asked for again after this
 } monsterinfo_t;
 
 // ROGUE
@@ -874,6 +876,7 @@ void HuntTarget (edict_t *self);
 qboolean infront (edict_t *self, edict_t *other);
 int range (edict_t *self, edict_t *other);
 qboolean visible (edict_t *self, edict_t *other);
+void AI_PrintVisibleStats (void);
 qboolean ai_chicken (edict_t *ent, edict_t *badguy);
 
 //
@@ -1112,6 +1115,7 @@ void target_playback_delayed_start (edict_t *ent);
 //
 // g_spawn.c
 //
+void ED_InitFieldHash (void);
 void ED_CallSpawn (edict_t *ent);
 void G_FindTeams(void);
 void Cmd_ToggleHud (void);
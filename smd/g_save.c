@@ -452,6 +452,8 @@ void InitGame (void)
 	game.clock_count = 0;
 	game.clock_ticking = 0;
 //CW--
+
+	ED_InitFieldHash ();
 }
 
 //=========================================================
@@ -1,7 +1,11 @@
 
 // game.h -- game dll information visible to server
 
+#ifdef KMQUAKE2_ENGINE_MOD
 #define	GAME_API_VERSION	3
+#else
+#define	GAME_API_VERSION	7
+#endif
 
 // edict->svflags
 
@@ -92,6 +96,13 @@ struct edict_s
 
 #endif		// GAME_INCLUDE
 
+// one ray of a trace_batch call, trace is filled in by the server
+typedef struct
+{
+	vec3_t		start, end;
+	trace_t		trace;
+} traceray_t;
+
 //===============================================================
 
 //
@@ -185,6 +196,25 @@ typedef struct
 	void	(*CloseFile) (fileHandle_t f);
 	int		(*FRead) (void *buffer, int size, fileHandle_t f);
 	int		(*FWrite) (const void *buffer, int size, fileHandle_t f);
+#else
+	// version 4
+	// traces rays that share the same size, passent and contentmask with a
+	// single entity area query, results match a trace call for each ray
+	void	(*trace_batch) (traceray_t *rays, int numrays, vec3_t mins, vec3_t maxs, edict_t *passent, int contentmask);
+
+	// version 5
+	// trace with the clients where they were msec ago, for lag compensation
+	trace_t	(*trace_rewind) (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passent, int contentmask, int msec);
+
+	// version 6
+	// BoxEdicts over ent's absmin/absmax with AREA_TRIGGERS, the server reuses
+	// the result while ent's box and the linked triggers stay the same
+	int		(*trigger_edicts) (edict_t *ent, edict_t **list, int maxcount);
+
+	// version 7
+	// sets next to the first point of the walkable path from start to goal
+	// on the server's navigation graph, false if there is none
+	qboolean	(*nav_route) (vec3_t start, vec3_t goal, vec3_t next);
 #endif
 
 } game_import_t;
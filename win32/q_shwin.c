@@ -132,11 +132,46 @@ int Sys_Milliseconds (void)
 	return curtime;
 }
 
+/*
+================
+Sys_DoubleTime
+
+Seconds since the first call, from the performance counter.
+================
+*/
+double Sys_DoubleTime (void)
+{
+	static LARGE_INTEGER	freq, base;
+	LARGE_INTEGER			now;
+
+	if (!freq.QuadPart)
+	{
+		QueryPerformanceFrequency(&freq);
+		QueryPerformanceCounter(&base);
+	}
+	QueryPerformanceCounter(&now);
+
+	return (double)(now.QuadPart - base.QuadPart) / (double)freq.QuadPart;
+}
+
 void Sys_Mkdir (char *path)
 {
 	_mkdir (path);
 }
 
+// makes dst another name for the contents of src, false if the
+// filesystem can't do that
+qboolean Sys_LinkFile (char *src, char *dst)
+{
+	return CreateHardLinkA (dst, src, NULL) != 0;
+}
+
+// moves src over dst in one step
+qboolean Sys_ReplaceFile (char *src, char *dst)
+{
+	return MoveFileExA (src, dst, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
 //============================================
 
 char	findbase[MAX_OSPATH];
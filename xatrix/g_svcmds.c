@@ -267,6 +267,8 @@ void	ServerCommand (void)
 	cmd = gi.argv(1);
 	if (Q_stricmp (cmd, "test") == 0)
 		Svcmd_Test_f ();
+	else if (Q_stricmp (cmd, "losstats") == 0)
+		AI_PrintVisibleStats ();
 	else if (Q_stricmp (cmd, "addip") == 0)
 		SVCmd_AddIP_f ();
 	else if (Q_stricmp (cmd, "removeip") == 0)
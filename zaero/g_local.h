@@ -494,6 +494,8 @@ typedef struct
 	float dodgetimeout;
 
 	vec3_t shottarget;
+	vec3_t		nav_point;		// where gi.nav_route said to walk to
+	float		nav_time;		// nav_point is asked for again after this
 } monsterinfo_t;
 
 
@@ -677,6 +679,11 @@ qboolean Add_Ammo (edict_t *ent, gitem_t *item, int count);
 void Touch_Item (edict_t *ent, edict_t *other, cplane_t *plane, csurface_t *surf);
 void precacheAllItems(void);
 
+//
+// g_spawn.c
+//
+void ED_InitFieldHash (void);
+
 //
 // g_utils.c
 //
@@ -777,6 +784,7 @@ int range (edict_t *self, edict_t *other);
 void FoundTarget (edict_t *self);
 qboolean infront (edict_t *self, edict_t *other);
 qboolean visible (edict_t *self, edict_t *other);
+void AI_PrintVisibleStats (void);
 qboolean FacingIdeal(edict_t *self);
 qboolean inweaponLineOfSight (edict_t *self, edict_t *other);
 
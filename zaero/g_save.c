@@ -241,6 +241,8 @@ void InitGame (void)
 
 	// get at the gl_polyblend client variable
 	gi.cvar("gl_polyblend", "1", CVAR_USERINFO);
+
+	ED_InitFieldHash ();
 }
 
 //=========================================================
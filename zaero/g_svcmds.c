@@ -23,6 +23,8 @@ void	ServerCommand (void)
 	cmd = gi.argv(1);
 	if (Q_stricmp (cmd, "test") == 0)
 		Svcmd_Test_f ();
+	else if (Q_stricmp (cmd, "losstats") == 0)
+		AI_PrintVisibleStats ();
 	else
 		gi.cprintf (NULL, PRINT_HIGH, "Unknown server command \"%s\"\n", cmd);
 }